@@ -0,0 +1,245 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include "Benchmark.h"
+#include <xlw/TempMemory.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace xlw { namespace Benchmarks {
+
+    namespace
+    {
+        thread_local volatile double sinkValue;
+        thread_local const void* volatile sinkPointer;
+
+        class Barrier
+        {
+        public:
+            explicit Barrier(unsigned threads) : threads_(threads), waiting_(0), generation_(0) {}
+
+            void Wait()
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                unsigned long long generation = generation_;
+                if (++waiting_ == threads_)
+                {
+                    waiting_ = 0;
+                    ++generation_;
+                    condition_.notify_all();
+                }
+                else
+                {
+                    condition_.wait(lock, [&] { return generation != generation_; });
+                }
+            }
+
+        private:
+            std::mutex mutex_;
+            std::condition_variable condition_;
+            unsigned threads_;
+            unsigned waiting_;
+            unsigned long long generation_;
+        };
+
+        std::string escape(const std::string& text)
+        {
+            std::string result;
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                unsigned char c = static_cast<unsigned char>(text[i]);
+                if (c == '"' || c == '\\')
+                {
+                    result += '\\';
+                    result += static_cast<char>(c);
+                }
+                else if (c < 0x20)
+                {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    result += buffer;
+                }
+                else
+                {
+                    result += static_cast<char>(c);
+                }
+            }
+            return result;
+        }
+    }
+
+    void Sink(double value)
+    {
+        sinkValue = value;
+    }
+
+    void Sink(const void* pointer)
+    {
+        sinkPointer = pointer;
+    }
+
+    void Suite::Add(const std::string& name, size_t items, const Setup& setup)
+    {
+        Benchmark benchmark;
+        benchmark.name = name;
+        benchmark.items = items;
+        benchmark.setup = setup;
+        benchmarks_.push_back(benchmark);
+    }
+
+    Result Run(const Benchmark& benchmark, unsigned threads, double minSeconds)
+    {
+        threads = std::max(threads, 1u);
+        Barrier barrier(threads);
+
+        // decided by the first thread while the others wait at a barrier
+        unsigned long long iterations = 1;
+        bool finished = false;
+        double seconds = 0.0;
+
+        std::mutex errorMutex;
+        std::string error;
+        auto fail = [&](const std::string& what)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (error.empty())
+                error = what.empty() ? "unknown error" : what;
+        };
+        auto failed = [&]()
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            return !error.empty();
+        };
+
+        auto worker = [&](unsigned thread)
+        {
+            Body body;
+            try
+            {
+                body = benchmark.setup();
+            }
+            catch (std::exception& e)
+            {
+                fail(e.what());
+            }
+            catch (...)
+            {
+                fail("");
+            }
+
+            std::chrono::steady_clock::time_point start;
+            for (;;)
+            {
+                barrier.Wait();
+                if (finished)
+                    break;
+                if (thread == 0)
+                    start = std::chrono::steady_clock::now();
+                if (body)
+                {
+                    try
+                    {
+                        for (unsigned long long i = 0; i < iterations; ++i)
+                        {
+                            UsesTempMemory whileInScopeUseTempMemory;
+                            body();
+                        }
+                    }
+                    catch (std::exception& e)
+                    {
+                        fail(e.what());
+                    }
+                    catch (...)
+                    {
+                        fail("");
+                    }
+                }
+                barrier.Wait();
+                if (thread == 0)
+                {
+                    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    if (failed() || seconds >= minSeconds)
+                    {
+                        finished = true;
+                    }
+                    else
+                    {
+                        // aim a little past the minimum, growing at most tenfold
+                        double scale = seconds > 0.0 ? 1.4 * minSeconds / seconds : 10.0;
+                        scale = std::min(std::max(scale, 2.0), 10.0);
+                        iterations = static_cast<unsigned long long>(iterations * scale) + 1;
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned i = 1; i < threads; ++i)
+            pool.push_back(std::thread(worker, i));
+        worker(0);
+        for (size_t i = 0; i < pool.size(); ++i)
+            pool[i].join();
+
+        Result result;
+        result.name = benchmark.name;
+        result.threads = threads;
+        result.iterations = iterations;
+        result.seconds = seconds;
+        result.error = error;
+        double total = static_cast<double>(iterations) * threads;
+        result.nanosecondsPerIteration = iterations ? 1e9 * seconds / iterations : 0.0;
+        result.iterationsPerSecond = seconds > 0.0 ? total / seconds : 0.0;
+        result.itemsPerSecond = result.iterationsPerSecond * benchmark.items;
+        return result;
+    }
+
+    void WriteJson(std::ostream& output, const std::vector<Result>& results, double minSeconds)
+    {
+        output << "{\n"
+               << "  \"context\": {\n"
+               << "    \"library\": \"xlw\",\n"
+               << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+               << "    \"min_time\": " << minSeconds << ",\n"
+#if defined(NDEBUG)
+               << "    \"debug\": false\n"
+#else
+               << "    \"debug\": true\n"
+#endif
+               << "  },\n"
+               << "  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Result& result = results[i];
+            output << (i ? ",\n" : "\n")
+                   << "    {\"name\": \"" << escape(result.name) << "\""
+                   << ", \"threads\": " << result.threads
+                   << ", \"iterations\": " << result.iterations
+                   << ", \"seconds\": " << result.seconds
+                   << ", \"ns_per_iteration\": " << result.nanosecondsPerIteration
+                   << ", \"iterations_per_second\": " << result.iterationsPerSecond
+                   << ", \"items_per_second\": " << result.itemsPerSecond;
+            if (!result.error.empty())
+                output << ", \"error\": \"" << escape(result.error) << "\"";
+            output << "}";
+        }
+        output << "\n  ]\n}\n";
+    }
+
+}}
@@ -0,0 +1,94 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef BENCHMARK_HEADER_GUARD
+#define BENCHMARK_HEADER_GUARD
+
+/*!
+\file Benchmark.h
+\brief Timing harness for the xlw micro-benchmarks
+*/
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace xlw { namespace Benchmarks {
+
+    //! The code being timed, called once per iteration.
+    typedef std::function<void()> Body;
+
+    //! Builds the inputs for one thread and returns the body that uses them.
+    /*! Called on the thread that will run the body, outside the timed region.
+    */
+    typedef std::function<Body()> Setup;
+
+    struct Benchmark
+    {
+        //! Group/Case/Size, for example AsMatrix/Numbers/64x64.
+        std::string name;
+        //! Elements processed by one iteration, 0 if that means nothing.
+        size_t items;
+        Setup setup;
+    };
+
+    class Suite
+    {
+    public:
+        void Add(const std::string& name, size_t items, const Setup& setup);
+        const std::vector<Benchmark>& GetBenchmarks() const { return benchmarks_; }
+
+    private:
+        std::vector<Benchmark> benchmarks_;
+    };
+
+    struct Result
+    {
+        std::string name;
+        unsigned threads;
+        //! Iterations run by each thread.
+        unsigned long long iterations;
+        double seconds;
+        //! Wall time of one iteration as seen by each thread.
+        double nanosecondsPerIteration;
+        //! Iterations completed by all threads together.
+        double iterationsPerSecond;
+        double itemsPerSecond;
+        //! Empty unless the body threw.
+        std::string error;
+    };
+
+    //! Runs the body on \c threads threads until a run lasts at least \c minSeconds.
+    /*! Every iteration is made inside a UsesTempMemory scope, as a call from
+        Excel would be, so temporary memory is reclaimed between iterations.
+    */
+    Result Run(const Benchmark& benchmark, unsigned threads, double minSeconds);
+
+    //! Writes the results as a JSON document.
+    void WriteJson(std::ostream& output, const std::vector<Result>& results, double minSeconds);
+
+    //! Uses a value so that the compiler can't drop the code computing it.
+    void Sink(double value);
+    void Sink(const void* pointer);
+
+    //! Adds the benchmarks in each area of the library.
+    void AddConversionBenchmarks(Suite& suite);
+    void AddConstructionBenchmarks(Suite& suite);
+    void AddUtilityBenchmarks(Suite& suite);
+
+}}
+
+#endif
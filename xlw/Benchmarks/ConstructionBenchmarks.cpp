@@ -0,0 +1,239 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+// Building the values returned to Excel, copying CellMatrix and the FP12
+// array type.
+
+#include "Benchmark.h"
+#include "Inputs.h"
+#include <xlw/XlfOper.h>
+#include <xlw/xlarray.h>
+#include <xlw/XlfOperBuilder.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace xlw { namespace Benchmarks {
+
+    namespace
+    {
+        const size_t sides[] = { 4, 16, 64, 256 };
+        const size_t sideCount = sizeof(sides) / sizeof(sides[0]);
+
+        // an FP12 as Excel passes a K% argument
+        std::shared_ptr<std::vector<double> > makeFp(size_t rows, size_t columns)
+        {
+            size_t header = offsetof(FP12, array) / sizeof(double);
+            std::shared_ptr<std::vector<double> > buffer(new std::vector<double>(header + rows * columns));
+            FP12* array = reinterpret_cast<FP12*>(buffer->data());
+            array->rows = static_cast<INT32>(rows);
+            array->columns = static_cast<INT32>(columns);
+            for (size_t i = 0; i < rows * columns; ++i)
+                array->array[i] = 0.5 * static_cast<double>(i) + 1.0;
+            return buffer;
+        }
+
+        void addOpers(Suite& suite)
+        {
+            const Mix mixes[] = { Numbers, Strings, Labels, Mixed };
+            for (size_t s = 0; s < sideCount; ++s)
+            {
+                size_t side = sides[s];
+                for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); ++m)
+                {
+                    Mix mix = mixes[m];
+                    suite.Add("XlfOper(CellMatrix)/" + std::string(MixName(mix)) + "/" + SizeName(side, side), side * side,
+                        [=]() -> Body
+                    {
+                        std::shared_ptr<CellMatrix> input(new CellMatrix(MakeCellMatrix(side, side, mix)));
+                        return [=]()
+                        {
+                            XlfOper result(*input);
+                            Sink(&result);
+                        };
+                    });
+                }
+                suite.Add("XlfOper::Set(CellMatrix)/Mixed/" + SizeName(side, side), side * side, [=]() -> Body
+                {
+                    std::shared_ptr<CellMatrix> input(new CellMatrix(MakeCellMatrix(side, side, Mixed)));
+                    return [=]()
+                    {
+                        XlfOper result;
+                        result.Set(*input);
+                        Sink(&result);
+                    };
+                });
+                suite.Add("XlfOper(MyMatrix)/Numbers/" + SizeName(side, side), side * side, [=]() -> Body
+                {
+                    std::shared_ptr<MyMatrix> input(new MyMatrix(MakeMatrix(side, side)));
+                    return [=]()
+                    {
+                        XlfOper result(*input);
+                        Sink(&result);
+                    };
+                });
+            }
+        }
+
+        // a query style result of rows rows: a name, a price, a flag and a count
+        void addTables(Suite& suite)
+        {
+            const size_t sizes[] = { 256, 4096, 65536 };
+            const COL columns = 4;
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+            {
+                size_t rows = sizes[s];
+                std::string suffix = "/" + SizeName(rows, columns);
+                if (rows <= 256)
+                {
+                    suite.Add("Table/CellMatrix::PushBottom" + suffix, rows * columns, [=]() -> Body
+                    {
+                        return [=]()
+                        {
+                            CellMatrix table(0, 0);
+                            for (size_t i = 0; i < rows; ++i)
+                            {
+                                CellMatrix row(1, columns);
+                                row(0, 0) = std::wstring(L"name");
+                                row(0, 1) = 0.5 * static_cast<double>(i);
+                                row(0, 2) = i % 2 == 0;
+                                row(0, 3) = static_cast<int>(i);
+                                table.PushBottom(row);
+                            }
+                            XlfOper result(table);
+                            Sink(&result);
+                        };
+                    });
+                }
+                suite.Add("Table/CellMatrix" + suffix, rows * columns, [=]() -> Body
+                {
+                    return [=]()
+                    {
+                        CellMatrix table(rows, columns);
+                        for (size_t i = 0; i < rows; ++i)
+                        {
+                            table(i, 0) = std::wstring(L"name");
+                            table(i, 1) = 0.5 * static_cast<double>(i);
+                            table(i, 2) = i % 2 == 0;
+                            table(i, 3) = static_cast<int>(i);
+                        }
+                        XlfOper result(table);
+                        Sink(&result);
+                    };
+                });
+                suite.Add("Table/XlfOperBuilder" + suffix, rows * columns, [=]() -> Body
+                {
+                    return [=]()
+                    {
+                        XlfOperBuilder table;
+                        for (size_t i = 0; i < rows; ++i)
+                        {
+                            table.Add(L"name", 4);
+                            table.Add(0.5 * static_cast<double>(i));
+                            table.Add(i % 2 == 0);
+                            table.Add(static_cast<int>(i));
+                            table.EndRow();
+                        }
+                        XlfOper result(table.Finish());
+                        Sink(&result);
+                    };
+                });
+            }
+        }
+
+        void addCellMatrices(Suite& suite)
+        {
+            for (size_t s = 0; s < sideCount; ++s)
+            {
+                size_t side = sides[s];
+                std::string suffix = "/Mixed/" + SizeName(side, side);
+                suite.Add("CellMatrix/Copy" + suffix, side * side, [=]() -> Body
+                {
+                    std::shared_ptr<CellMatrix> input(new CellMatrix(MakeCellMatrix(side, side, Mixed)));
+                    return [=]()
+                    {
+                        CellMatrix result(*input);
+                        Sink(&result);
+                    };
+                });
+                suite.Add("CellMatrix/PushBottom" + suffix, 2 * side * side, [=]() -> Body
+                {
+                    std::shared_ptr<CellMatrix> input(new CellMatrix(MakeCellMatrix(side, side, Mixed)));
+                    return [=]()
+                    {
+                        CellMatrix result(MergeCellMatrices(*input, *input));
+                        Sink(&result);
+                    };
+                });
+            }
+        }
+
+        void addFp(Suite& suite)
+        {
+            for (size_t s = 0; s < sideCount; ++s)
+            {
+                size_t side = sides[s];
+                suite.Add("GetMatrix/Numbers/" + SizeName(side, side), side * side, [=]() -> Body
+                {
+                    std::shared_ptr<std::vector<double> > input(makeFp(side, side));
+                    return [=]()
+                    {
+                        NEMatrix result(GetMatrix(reinterpret_cast<LPXLARRAY>(input->data())));
+                        Sink(&result);
+                    };
+                });
+                suite.Add("GetMatrixView/Numbers/" + SizeName(side, side), side * side, [=]() -> Body
+                {
+                    std::shared_ptr<std::vector<double> > input(makeFp(side, side));
+                    return [=]()
+                    {
+                        FpMatrixView result(GetMatrixView(reinterpret_cast<LPXLARRAY>(input->data())));
+                        Sink(&result);
+                    };
+                });
+                suite.Add("createTempFpArray(MyMatrix)/Numbers/" + SizeName(side, side), side * side, [=]() -> Body
+                {
+                    std::shared_ptr<MyMatrix> input(new MyMatrix(MakeMatrix(side, side)));
+                    return [=]()
+                    {
+                        LPXLARRAY result = createTempFpArray(*input);
+                        Sink(result);
+                    };
+                });
+                suite.Add("createTempFpArray/Numbers/" + SizeName(side, side), side * side, [=]() -> Body
+                {
+                    return [=]()
+                    {
+                        double* data;
+                        int size = static_cast<int>(side);
+                        LPXLARRAY result = createTempFpArray(size, size, data);
+                        for (int i = 0; i < size * size; ++i)
+                            data[i] = i;
+                        Sink(result);
+                    };
+                });
+            }
+        }
+    }
+
+    void AddConstructionBenchmarks(Suite& suite)
+    {
+        addOpers(suite);
+        addCellMatrices(suite);
+        addTables(suite);
+        addFp(suite);
+    }
+
+}}
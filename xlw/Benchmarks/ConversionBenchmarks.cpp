@@ -0,0 +1,223 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+// Converting the arguments Excel passes into C++ values.
+
+#include "Benchmark.h"
+#include "Inputs.h"
+#include <Host.h>
+#include <xlw/XlfOper.h>
+#include <memory>
+
+using xlw::HostSimulator::HostOper;
+
+namespace xlw { namespace Benchmarks {
+
+    namespace
+    {
+        typedef std::shared_ptr<HostOper> SharedOper;
+
+        // the body keeps the input alive
+        template<class Convert>
+        Setup convert(const std::function<HostOper()>& makeInput, Convert conversion)
+        {
+            return [=]() -> Body
+            {
+                SharedOper input(new HostOper(makeInput()));
+                return [=]()
+                {
+                    XlfOper oper(&input->Get());
+                    conversion(oper);
+                };
+            };
+        }
+
+        IDSHEET benchmarkSheet()
+        {
+            HostSimulator::Grid& grid(HostSimulator::Host::Instance().GetGrid());
+            IDSHEET sheet = grid.AddSheet("Benchmarks");
+            grid.SetValue(sheet, 0, 0, HostOper::Number(42.0).Get());
+            return sheet;
+        }
+
+        HostOper referenceToNumber()
+        {
+            // a cell in the host's grid, AsDouble coerces it with xlCoerce
+            static const IDSHEET sheet = benchmarkSheet();
+            XLREF12 area = { 0, 0, 0, 0 };
+            return HostOper::Reference(sheet, area);
+        }
+
+        // rows x columns cells of the host's grid holding mix, referred to as one area
+        HostOper referenceTo(RW rows, COL columns, Mix mix)
+        {
+            HostSimulator::Grid& grid(HostSimulator::Host::Instance().GetGrid());
+            IDSHEET sheet = grid.AddSheet("Benchmarks " + std::string(MixName(mix)) + " " + SizeName(rows, columns));
+            HostOper values(MakeMulti(rows, columns, mix));
+            for (RW i = 0; i < rows; ++i)
+                for (COL j = 0; j < columns; ++j)
+                    grid.SetValue(sheet, i, j, values.Get().val.array.lparray[i * columns + j]);
+            XLREF12 area = { 0, rows - 1, 0, columns - 1 };
+            return HostOper::Reference(sheet, area);
+        }
+
+        void addScalars(Suite& suite)
+        {
+            struct Case { const char* name; std::function<HostOper()> make; };
+            const Case cases[] =
+            {
+                { "Number", [] { return HostOper::Number(1.5); } },
+                { "Integer", [] { return HostOper::Integer(3); } },
+                { "Boolean", [] { return HostOper::Boolean(true); } },
+                { "NumericString", [] { return HostOper::String(L"1.5"); } },
+                { "Reference", referenceToNumber }
+            };
+            for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+            {
+                suite.Add(std::string("AsDouble/") + cases[i].name, 1,
+                    convert(cases[i].make, [](const XlfOper& oper) { Sink(oper.AsDouble()); }));
+            }
+        }
+
+        void addArrays(Suite& suite)
+        {
+            const size_t sizes[] = { 16, 256, 4096, 65536 };
+            const Mix mixes[] = { Numbers, Scalars, NumericStrings };
+            for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); ++m)
+            {
+                for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+                {
+                    RW rows = static_cast<RW>(sizes[s]);
+                    Mix mix = mixes[m];
+                    std::function<HostOper()> make([=] { return MakeMulti(rows, 1, mix); });
+                    std::string suffix = std::string(MixName(mix)) + "/" + SizeName(sizes[s], 1);
+
+                    suite.Add("AsArray/" + suffix, sizes[s], convert(make, [](const XlfOper& oper)
+                    {
+                        MyArray result(oper.AsArray());
+                        Sink(&result);
+                    }));
+                    suite.Add("AsDoubleVector/" + suffix, sizes[s], convert(make, [](const XlfOper& oper)
+                    {
+                        std::vector<double> result(oper.AsDoubleVector());
+                        Sink(result.data());
+                    }));
+                }
+            }
+        }
+
+        struct Sum
+        {
+            double total;
+            void operator()(RW, COL, double value) { total += value; }
+            void operator()(RW, COL, XlfStringView) {}
+            void operator()(RW, COL, bool) {}
+            void operator()(RW, COL, XlfErrorValue) {}
+            void operator()(RW, COL, XlfEmptyValue) {}
+        };
+
+        // summing the numbers of an array one element at a time
+        void addElements(Suite& suite)
+        {
+            const size_t sides[] = { 16, 256 };
+            for (size_t s = 0; s < sizeof(sides) / sizeof(sides[0]); ++s)
+            {
+                RW rows = static_cast<RW>(sides[s]);
+                COL columns = static_cast<COL>(sides[s]);
+                std::function<HostOper()> make([=] { return MakeMulti(rows, columns, Numbers); });
+                std::string suffix = "/Numbers/" + SizeName(sides[s], sides[s]);
+
+                suite.Add("Sum/operator()" + suffix, sides[s] * sides[s], convert(make, [](XlfOper& oper)
+                {
+                    double total = 0.0;
+                    for (RW i = 0; i < oper.rows(); ++i)
+                        for (COL j = 0; j < oper.columns(); ++j)
+                            total += oper(i, j).AsDouble();
+                    Sink(total);
+                }));
+                suite.Add("Sum/Cells" + suffix, sides[s] * sides[s], convert(make, [](XlfOper& oper)
+                {
+                    double total = 0.0;
+                    XlfOperSpan cells(oper.Cells().All());
+                    for (XlfOperSpan::const_iterator cell = cells.begin(); cell != cells.end(); ++cell)
+                        total += cell->val.num;
+                    Sink(total);
+                }));
+                suite.Add("Sum/Visit" + suffix, sides[s] * sides[s], convert(make, [](XlfOper& oper)
+                {
+                    Sum sum = { 0.0 };
+                    oper.Visit(sum);
+                    Sink(sum.total);
+                }));
+            }
+        }
+
+        void addMatrices(Suite& suite)
+        {
+            const size_t sides[] = { 4, 16, 64, 256 };
+            const Mix numericMixes[] = { Numbers, Scalars, NumericStrings };
+            const Mix cellMixes[] = { Numbers, Strings, Mixed };
+            for (size_t s = 0; s < sizeof(sides) / sizeof(sides[0]); ++s)
+            {
+                size_t side = sides[s];
+                for (size_t m = 0; m < sizeof(numericMixes) / sizeof(numericMixes[0]); ++m)
+                {
+                    Mix mix = numericMixes[m];
+                    suite.Add("AsMatrix/" + std::string(MixName(mix)) + "/" + SizeName(side, side), side * side,
+                        convert([=] { return MakeMulti(static_cast<RW>(side), static_cast<COL>(side), mix); },
+                                [](const XlfOper& oper)
+                    {
+                        MyMatrix result(oper.AsMatrix());
+                        Sink(&result);
+                    }));
+                }
+                RW rows = static_cast<RW>(side);
+                COL columns = static_cast<COL>(side);
+                suite.Add("AsMatrix/Reference/Numbers/" + SizeName(side, side), side * side,
+                    convert([=] { return referenceTo(rows, columns, Numbers); }, [](const XlfOper& oper)
+                {
+                    MyMatrix result(oper.AsMatrix());
+                    Sink(&result);
+                }));
+                suite.Add("AsCellMatrix/Reference/Mixed/" + SizeName(side, side), side * side,
+                    convert([=] { return referenceTo(rows, columns, Mixed); }, [](const XlfOper& oper)
+                {
+                    CellMatrix result(oper.AsCellMatrix());
+                    Sink(&result);
+                }));
+                for (size_t m = 0; m < sizeof(cellMixes) / sizeof(cellMixes[0]); ++m)
+                {
+                    Mix mix = cellMixes[m];
+                    suite.Add("AsCellMatrix/" + std::string(MixName(mix)) + "/" + SizeName(side, side), side * side,
+                        convert([=] { return MakeMulti(static_cast<RW>(side), static_cast<COL>(side), mix); },
+                                [](const XlfOper& oper)
+                    {
+                        CellMatrix result(oper.AsCellMatrix());
+                        Sink(&result);
+                    }));
+                }
+            }
+        }
+    }
+
+    void AddConversionBenchmarks(Suite& suite)
+    {
+        addScalars(suite);
+        addArrays(suite);
+        addElements(suite);
+        addMatrices(suite);
+    }
+
+}}
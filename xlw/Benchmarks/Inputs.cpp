@@ -0,0 +1,139 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include "Inputs.h"
+#include <sstream>
+
+using xlw::HostSimulator::HostOper;
+
+namespace xlw { namespace Benchmarks {
+
+    namespace
+    {
+        enum Kind { Number, Integer, Boolean, NumericText, Text, Label, Empty, Error };
+
+        Kind kind(size_t index, Mix mix)
+        {
+            static const Kind scalars[] = { Number, Integer, Boolean };
+            static const Kind mixed[] = { Number, Text, Boolean, Integer, Empty, Error };
+            switch (mix)
+            {
+            case Numbers: return Number;
+            case Scalars: return scalars[index % 3];
+            case NumericStrings: return NumericText;
+            case Strings: return Text;
+            case Labels: return Label;
+            default: return mixed[index % 6];
+            }
+        }
+
+        double number(size_t index)
+        {
+            return 0.5 * static_cast<double>(index) + 1.0;
+        }
+
+        std::wstring text(size_t index, Kind kind)
+        {
+            std::wostringstream result;
+            if (kind == NumericText)
+                result << number(index);
+            else if (kind == Label)
+                result << L"label " << index % 16;
+            else
+                result << L"text " << index;
+            return result.str();
+        }
+
+        HostOper element(size_t index, Mix mix)
+        {
+            Kind type(kind(index, mix));
+            switch (type)
+            {
+            case Number: return HostOper::Number(number(index));
+            case Integer: return HostOper::Integer(static_cast<int>(index));
+            case Boolean: return HostOper::Boolean(index % 2 == 0);
+            case NumericText:
+            case Text:
+            case Label: return HostOper::String(text(index, type));
+            case Empty: return HostOper();
+            default: return HostOper::Error(xlerrNA);
+            }
+        }
+    }
+
+    const char* MixName(Mix mix)
+    {
+        switch (mix)
+        {
+        case Numbers: return "Numbers";
+        case Scalars: return "Scalars";
+        case NumericStrings: return "NumericStrings";
+        case Strings: return "Strings";
+        case Labels: return "Labels";
+        default: return "Mixed";
+        }
+    }
+
+    std::string SizeName(size_t rows, size_t columns)
+    {
+        std::ostringstream name;
+        name << rows << "x" << columns;
+        return name.str();
+    }
+
+    HostOper MakeMulti(RW rows, COL columns, Mix mix)
+    {
+        HostOper result(HostOper::Array(rows, columns));
+        size_t size = static_cast<size_t>(rows) * static_cast<size_t>(columns);
+        for (size_t i = 0; i < size; ++i)
+            result.Get().val.array.lparray[i] = element(i, mix).Release();
+        return result;
+    }
+
+    CellMatrix MakeCellMatrix(size_t rows, size_t columns, Mix mix)
+    {
+        CellMatrix result(rows, columns);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t j = 0; j < columns; ++j)
+            {
+                size_t index = i * columns + j;
+                Kind type(kind(index, mix));
+                switch (type)
+                {
+                case Number: result(i, j) = number(index); break;
+                case Integer: result(i, j) = static_cast<int>(index); break;
+                case Boolean: result(i, j) = index % 2 == 0; break;
+                case NumericText:
+                case Text:
+                case Label: result(i, j) = text(index, type); break;
+                case Empty: break;
+                default: result(i, j) = CellValue::error_type(xlerrNA); break;
+                }
+            }
+        }
+        return result;
+    }
+
+    MyMatrix MakeMatrix(size_t rows, size_t columns)
+    {
+        MyMatrix result(MatrixTraits<MyMatrix>::create(rows, columns));
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < columns; ++j)
+                MatrixTraits<MyMatrix>::setAt(result, i, j, number(i * columns + j));
+        return result;
+    }
+
+}}
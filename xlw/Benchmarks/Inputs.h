@@ -0,0 +1,62 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef BENCHMARK_INPUTS_HEADER_GUARD
+#define BENCHMARK_INPUTS_HEADER_GUARD
+
+/*!
+\file Inputs.h
+\brief Arguments of known shape and type mix for the benchmarks
+*/
+
+#include <HostOper.h>
+#include <xlw/CellMatrix.h>
+#include <xlw/MyContainers.h>
+#include <string>
+
+namespace xlw { namespace Benchmarks {
+
+    //! What the cells of an input hold.
+    enum Mix
+    {
+        //! Doubles only.
+        Numbers,
+        //! Doubles, integers and booleans, all convertible without Excel.
+        Scalars,
+        //! Numbers held as text, converting them calls back into the host.
+        NumericStrings,
+        //! Text only.
+        Strings,
+        //! Text repeating a few labels, as in a report.
+        Labels,
+        //! Every type a cell can hold, including empty cells and errors.
+        Mixed
+    };
+
+    const char* MixName(Mix mix);
+
+    //! For example 64x64.
+    std::string SizeName(size_t rows, size_t columns);
+
+    //! An xltypeMulti argument as Excel would pass it.
+    HostSimulator::HostOper MakeMulti(RW rows, COL columns, Mix mix);
+
+    CellMatrix MakeCellMatrix(size_t rows, size_t columns, Mix mix);
+
+    MyMatrix MakeMatrix(size_t rows, size_t columns);
+
+}}
+
+#endif
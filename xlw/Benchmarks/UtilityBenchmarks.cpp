@@ -0,0 +1,276 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+// String conversions, argument lists, temporary memory, the result cache
+// and the call profiler.
+
+#include "Benchmark.h"
+#include <xlw/ArgList.h>
+#include <xlw/PascalStringConversions.h>
+#include <xlw/TempMemory.h>
+#include <xlw/XlfOper.h>
+#include <xlw/XlfProfiler.h>
+#include <xlw/XlfResultCache.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace xlw { namespace Benchmarks {
+
+    namespace
+    {
+        std::string number(size_t value)
+        {
+            std::ostringstream text;
+            text << value;
+            return text.str();
+        }
+
+        template<class Char>
+        std::shared_ptr<std::vector<Char> > makePascal(size_t length)
+        {
+            std::shared_ptr<std::vector<Char> > result(new std::vector<Char>(length + 1, Char('a')));
+            (*result)[0] = static_cast<Char>(length);
+            return result;
+        }
+
+        void addStrings(Suite& suite)
+        {
+            // 255 is the most a narrow Pascal string can hold
+            const size_t lengths[] = { 8, 64, 255 };
+            for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i)
+            {
+                size_t length = lengths[i];
+                std::string suffix = "/" + number(length);
+
+                suite.Add("PascalString/StringToPascalString" + suffix, length, [=]() -> Body
+                {
+                    std::string input(length, 'a');
+                    return [=]() { Sink(PascalStringConversions::StringToPascalString(input)); };
+                });
+                suite.Add("PascalString/StringToWPascalString" + suffix, length, [=]() -> Body
+                {
+                    std::string input(length, 'a');
+                    return [=]() { Sink(PascalStringConversions::StringToWPascalString(input)); };
+                });
+                suite.Add("PascalString/WStringToWPascalString" + suffix, length, [=]() -> Body
+                {
+                    std::wstring input(length, L'a');
+                    return [=]() { Sink(PascalStringConversions::WStringToWPascalString(input)); };
+                });
+                suite.Add("PascalString/PascalStringToString" + suffix, length, [=]() -> Body
+                {
+                    std::shared_ptr<std::vector<char> > input(makePascal<char>(length));
+                    return [=]() { Sink(PascalStringConversions::PascalStringToString(input->data())); };
+                });
+                suite.Add("PascalString/WPascalStringToString" + suffix, length, [=]() -> Body
+                {
+                    std::shared_ptr<std::vector<wchar_t> > input(makePascal<wchar_t>(length));
+                    return [=]() { Sink(PascalStringConversions::WPascalStringToString(input->data())); };
+                });
+                suite.Add("PascalString/WPascalStringToWString" + suffix, length, [=]() -> Body
+                {
+                    std::shared_ptr<std::vector<wchar_t> > input(makePascal<wchar_t>(length));
+                    return [=]()
+                    {
+                        std::wstring result(PascalStringConversions::WPascalStringToWString(input->data()));
+                        Sink(result.data());
+                    };
+                });
+                suite.Add("PascalString/StringToWString" + suffix, length, [=]() -> Body
+                {
+                    std::string input(length, 'a');
+                    return [=]()
+                    {
+                        std::wstring result(PascalStringConversions::StringToWString(input));
+                        Sink(result.data());
+                    };
+                });
+                suite.Add("PascalString/WStringToString" + suffix, length, [=]() -> Body
+                {
+                    std::wstring input(length, L'a');
+                    return [=]()
+                    {
+                        std::string result(PascalStringConversions::WStringToString(input));
+                        Sink(result.data());
+                    };
+                });
+                // a character that isn't ASCII first, so all of it goes to the platform
+                suite.Add("PascalString/StringToWPascalString/Accented" + suffix, length, [=]() -> Body
+                {
+                    std::string input(length, 'a');
+                    input[0] = '\xE9';
+                    return [=]() { Sink(PascalStringConversions::StringToWPascalString(input)); };
+                });
+                suite.Add("PascalString/WPascalStringToString/Accented" + suffix, length, [=]() -> Body
+                {
+                    std::shared_ptr<std::vector<wchar_t> > input(makePascal<wchar_t>(length));
+                    (*input)[1] = 0xE9;
+                    return [=]() { Sink(PascalStringConversions::WPascalStringToString(input->data())); };
+                });
+            }
+        }
+
+        // a structure name, then a row of names above a row of values
+        CellMatrix makeArguments(size_t count)
+        {
+            CellMatrix result(3, count);
+            result(0, 0) = std::string("benchmark");
+            for (size_t i = 0; i < count; ++i)
+            {
+                result(1, i) = "name" + number(i);
+                switch (i % 3)
+                {
+                case 0: result(2, i) = 0.5 * static_cast<double>(i); break;
+                case 1: result(2, i) = i % 2 == 0; break;
+                default: result(2, i) = "value" + number(i); break;
+                }
+            }
+            return result;
+        }
+
+        void addArgumentLists(Suite& suite)
+        {
+            const size_t counts[] = { 4, 16, 64 };
+            for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+            {
+                size_t count = counts[i];
+                suite.Add("ArgumentList/Parse/" + number(count), count, [=]() -> Body
+                {
+                    std::shared_ptr<CellMatrix> input(new CellMatrix(makeArguments(count)));
+                    return [=]()
+                    {
+                        ArgumentList result(*input, "benchmark");
+                        Sink(&result);
+                    };
+                });
+                suite.Add("ArgumentList/ParseAndRead/" + number(count), count, [=]() -> Body
+                {
+                    std::shared_ptr<CellMatrix> input(new CellMatrix(makeArguments(count)));
+                    return [=]()
+                    {
+                        ArgumentList result(*input, "benchmark");
+                        double sum = 0.0;
+                        for (size_t j = 0; j < count; j += 3)
+                            sum += result.GetDoubleArgumentValue("name" + number(j));
+                        Sink(sum);
+                    };
+                });
+            }
+        }
+
+        void addTempMemory(Suite& suite)
+        {
+            // many small blocks, as when building a large XlfOper
+            const size_t counts[] = { 16, 256, 4096 };
+            for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+            {
+                size_t count = counts[i];
+                suite.Add("TempMemory/SmallBlocks/" + number(count), count, [=]() -> Body
+                {
+                    return [=]()
+                    {
+                        for (size_t j = 0; j < count; ++j)
+                            Sink(TempMemory::GetMemory<char>(32));
+                    };
+                });
+            }
+
+            const size_t sizes[] = { 64, 4096, 1 << 20, 16 << 20 };
+            for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+            {
+                size_t size = sizes[i];
+                suite.Add("TempMemory/GetMemory/" + number(size), size, [=]() -> Body
+                {
+                    return [=]() { Sink(TempMemory::GetMemory<char>(size)); };
+                });
+                suite.Add("TempMemory/GetMemoryUninitialised/" + number(size), size, [=]() -> Body
+                {
+                    return [=]() { Sink(TempMemory::GetMemoryUninitialised<char>(size)); };
+                });
+            }
+        }
+
+        void addResultCache(Suite& suite)
+        {
+            // a hit is the key, the lookup and the copy out, set against
+            // what the conversions alone would cost a cached function
+            const size_t cells[] = { 1, 64, 4096 };
+            for (size_t i = 0; i < sizeof(cells) / sizeof(cells[0]); ++i)
+            {
+                size_t count = cells[i];
+                suite.Add("ResultCache/Hit/" + number(count), count, [=]() -> Body
+                {
+                    std::shared_ptr<XlfResultCache> cache(new XlfResultCache("benchmark", 64 << 20));
+                    CellMatrix result(count, 1);
+                    for (size_t j = 0; j < count; ++j)
+                        result(j, 0) = static_cast<double>(j);
+                    XlfResultCache::Key key;
+                    key.Add(1.0);
+                    key.Add(static_cast<int>(count));
+                    cache->Insert(key, XlfOper(result));
+                    return [=]()
+                    {
+                        XlfResultCache::Key lookup;
+                        lookup.Add(1.0);
+                        lookup.Add(static_cast<int>(count));
+                        LPXLOPER12 found;
+                        Sink(cache->Find(lookup, found));
+                        Sink(found);
+                    };
+                });
+            }
+            suite.Add("ResultCache/Miss", 1, []() -> Body
+            {
+                std::shared_ptr<XlfResultCache> cache(new XlfResultCache("benchmark", 64 << 20));
+                return [=]()
+                {
+                    XlfResultCache::Key lookup;
+                    lookup.Add(1.0);
+                    lookup.Add(2);
+                    LPXLOPER12 found;
+                    Sink(cache->Find(lookup, found));
+                };
+            });
+        }
+
+        void addProfiler(Suite& suite)
+        {
+            // what every generated wrapper pays to be profiled
+            suite.Add("Profiler/Call", 1, []() -> Body
+            {
+                std::shared_ptr<XlfProfiler> profiler(new XlfProfiler("benchmark"));
+                return [=]()
+                {
+                    XlfProfiler::Call profiledCall(*profiler);
+                    profiledCall.Converted();
+                    profiledCall.Called();
+                    profiledCall.Finished();
+                };
+            });
+        }
+    }
+
+    void AddUtilityBenchmarks(Suite& suite)
+    {
+        addStrings(suite);
+        addArgumentLists(suite);
+        addTempMemory(suite);
+        addResultCache(suite);
+        addProfiler(suite);
+    }
+
+}}
@@ -0,0 +1,131 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+// xlwbench: times the marshalling paths of xlw at increasing thread counts
+// and writes the results as JSON so that runs can be compared.
+//
+// Callbacks into Excel, such as xlCoerce, are answered by the host simulator
+// linked into this program.
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace xlw::Benchmarks;
+
+namespace
+{
+    void usage()
+    {
+        std::cerr << "usage: xlwbench [--threads N] [--min-time SECONDS] [--filter TEXT] [--list] [--output FILE]\n"
+                     "  every benchmark whose name contains TEXT is run on 1, 2, 4, ... and N threads\n";
+    }
+
+    std::vector<unsigned> threadCounts(unsigned maximum)
+    {
+        std::vector<unsigned> result;
+        for (unsigned threads = 1; threads < maximum; threads *= 2)
+            result.push_back(threads);
+        result.push_back(maximum);
+        return result;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    double minSeconds = 0.1;
+    std::string filter;
+    std::string outputFile;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue)
+            maxThreads = std::max(static_cast<unsigned>(std::strtoul(argv[++i], 0, 10)), 1u);
+        else if (arg == "--min-time" && hasValue)
+            minSeconds = std::strtod(argv[++i], 0);
+        else if (arg == "--filter" && hasValue)
+            filter = argv[++i];
+        else if (arg == "--output" && hasValue)
+            outputFile = argv[++i];
+        else if (arg == "--list")
+            list = true;
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    Suite suite;
+    AddConversionBenchmarks(suite);
+    AddConstructionBenchmarks(suite);
+    AddUtilityBenchmarks(suite);
+
+    std::vector<Benchmark> selected;
+    for (size_t i = 0; i < suite.GetBenchmarks().size(); ++i)
+    {
+        if (suite.GetBenchmarks()[i].name.find(filter) != std::string::npos)
+            selected.push_back(suite.GetBenchmarks()[i]);
+    }
+    if (list)
+    {
+        for (size_t i = 0; i < selected.size(); ++i)
+            std::cout << selected[i].name << "\n";
+        return 0;
+    }
+
+    std::vector<unsigned> counts(threadCounts(maxThreads));
+    std::vector<Result> results;
+    bool failed = false;
+    for (size_t i = 0; i < selected.size(); ++i)
+    {
+        for (size_t j = 0; j < counts.size(); ++j)
+        {
+            Result result(Run(selected[i], counts[j], minSeconds));
+            std::cerr << result.name << " threads " << result.threads;
+            if (result.error.empty())
+                std::cerr << " " << result.nanosecondsPerIteration << " ns\n";
+            else
+                std::cerr << " failed: " << result.error << "\n";
+            failed = failed || !result.error.empty();
+            results.push_back(result);
+        }
+    }
+
+    if (outputFile.empty())
+    {
+        WriteJson(std::cout, results, minSeconds);
+    }
+    else
+    {
+        std::ofstream output(outputFile.c_str());
+        WriteJson(output, results, minSeconds);
+        if (!output)
+        {
+            std::cerr << "xlwbench: could not write " << outputFile << std::endl;
+            return 1;
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -10,6 +10,8 @@
 #include <xlw/CellMatrix.h>
 #include <xlw/DoubleOrNothing.h>
 #include <xlw/ArgList.h>
+#include <xlw/xlarray.h>
+#include <xlw/XlfOper.h>
 
 using namespace xlw;
 
@@ -20,5 +22,55 @@ short // echoes a short
 EchoShort(short x // number to be echoed
        );
 
+double // squares a number on another thread
+//<xlw:asynchronous
+AsyncSquare(double x // number to be squared, negative numbers fail
+          , int milliseconds // how long to take over it
+           );
+
+double // waits on another thread until the calculation is cancelled
+//<xlw:asynchronous
+AsyncWaitForCancel(double seconds // longest to wait
+                  );
+
+MyMatrix // outer product, remembered for the same arguments
+//<xlw:cache
+CachedOuterProduct(const MyArray& a // column
+                 , const MyArray& b // row
+                  );
+
+double // number of times CachedOuterProduct has worked out a product
+CachedOuterProductRuns(double first // a product to count after
+                     , double second // another product to count after
+                      );
+
+MyMatrix // outer product, returned as an array of numbers
+//<xlw:fparray
+OuterProduct(const MyArray& a // column
+           , const MyArray& b // row
+            );
+
+void // scales the numbers in the array Excel passes
+//<xlw:inplace=values
+ScaleInPlace(double factor // multiplier
+           , LPXLARRAY values // numbers to be scaled
+            );
+
+XlfOper // table whose rows hold as many numbers as lengths asks for, built with XlfOperBuilder
+RaggedTable(const MyArray& lengths // number of cells in each row
+          , int columns // columns to make room for at the start
+           );
+
+MyMatrix // rows, columns and empty cells of the table RaggedTable makes
+RaggedTableShape(const MyArray& lengths // number of cells in each row
+               , int columns // columns to make room for at the start
+                );
+
+double // length of the hypotenuse, cheap enough for the function wizard
+//<xlw:nowizardcheck
+Hypotenuse(double a // one side
+         , double b // the other side
+          );
+
 
 #endif
@@ -1,5 +1,12 @@
 
 #include<cppinterface.h>
+#include <xlw/XlfAsync.h>
+#include <xlw/XlfOperBuilder.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
 #pragma warning (disable : 4996)
 
 
@@ -10,3 +17,121 @@ EchoShort(short x // number to be echoed
     return x;
 }
 
+double // squares a number on another thread
+AsyncSquare(double x // number to be squared, negative numbers fail
+          , int milliseconds // how long to take over it
+           )
+{
+    if (x < 0.0)
+        THROW_XLW("Can't square a negative number here");
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+    return x * x;
+}
+
+double // waits on another thread until the calculation is cancelled
+AsyncWaitForCancel(double seconds // longest to wait
+                  )
+{
+    std::chrono::steady_clock::time_point end(std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds)));
+    while (!XlfAsync::Cancelled() && std::chrono::steady_clock::now() < end)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return seconds;
+}
+
+namespace
+{
+    std::atomic<int> outerProductRuns(0);
+
+    MyMatrix outerProduct(const MyArray& a, const MyArray& b)
+    {
+        MyMatrix result(a.size(), b.size());
+        for (size_t i = 0; i < a.size(); ++i)
+            for (size_t j = 0; j < b.size(); ++j)
+                result[i][j] = a[i] * b[j];
+        return result;
+    }
+}
+
+MyMatrix // outer product, remembered for the same arguments
+CachedOuterProduct(const MyArray& a // column
+                 , const MyArray& b // row
+                  )
+{
+    ++outerProductRuns;
+    return outerProduct(a, b);
+}
+
+double // number of times CachedOuterProduct has worked out a product
+CachedOuterProductRuns(double // a product to count after
+                     , double // another product to count after
+                      )
+{
+    return outerProductRuns;
+}
+
+MyMatrix // outer product, returned as an array of numbers
+OuterProduct(const MyArray& a // column
+           , const MyArray& b // row
+            )
+{
+    return outerProduct(a, b);
+}
+
+void // scales the numbers in the array Excel passes
+ScaleInPlace(double factor // multiplier
+           , LPXLARRAY values // numbers to be scaled
+            )
+{
+    for (int i = 0; i < values->rows * values->columns; ++i)
+        values->array[i] *= factor;
+}
+
+namespace
+{
+    // row i holds 10(i+1)+1, 10(i+1)+2, ... padded out to the longest row
+    XlfOper raggedTable(const MyArray& lengths, int columns)
+    {
+        XlfOperBuilder table(static_cast<COL>(std::max(columns, 1)), 1);
+        for (size_t i = 0; i < lengths.size(); ++i)
+        {
+            for (unsigned long j = 0; j < static_cast<unsigned long>(lengths[i]); ++j)
+                table.Add(10.0 * (i + 1) + (j + 1));
+            table.EndRow();
+        }
+        return table.Finish();
+    }
+}
+
+XlfOper // table whose rows hold as many numbers as lengths asks for, built with XlfOperBuilder
+RaggedTable(const MyArray& lengths // number of cells in each row
+          , int columns // columns to make room for at the start
+           )
+{
+    return raggedTable(lengths, columns);
+}
+
+MyMatrix // rows, columns and empty cells of the table RaggedTable makes
+RaggedTableShape(const MyArray& lengths // number of cells in each row
+               , int columns // columns to make room for at the start
+                )
+{
+    XlfOper table(raggedTable(lengths, columns));
+    MyMatrix result(1, 3);
+    result[0][0] = table.rows();
+    result[0][1] = table.columns();
+    result[0][2] = 0.0;
+    for (RW i = 0; i < table.rows(); ++i)
+        for (COL j = 0; j < table.columns(); ++j)
+            if (table(i, j).IsNil())
+                result[0][2] += 1.0;
+    return result;
+}
+
+double // length of the hypotenuse, cheap enough for the function wizard
+Hypotenuse(double a // one side
+         , double b // the other side
+          )
+{
+    return std::sqrt(a * a + b * b);
+}
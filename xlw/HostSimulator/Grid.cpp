@@ -0,0 +1,209 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include "Grid.h"
+#include <mutex>
+#include <stdexcept>
+
+namespace xlw { namespace HostSimulator {
+
+    namespace
+    {
+        bool isValid(const XLREF12& area)
+        {
+            return area.rwFirst >= 0 && area.rwFirst <= area.rwLast && area.rwLast < Grid::Rows &&
+                   area.colFirst >= 0 && area.colFirst <= area.colLast && area.colLast < Grid::Columns;
+        }
+
+        size_t cellCount(const XLREF12& area)
+        {
+            return static_cast<size_t>(area.rwLast - area.rwFirst + 1) * static_cast<size_t>(area.colLast - area.colFirst + 1);
+        }
+    }
+
+    IDSHEET Grid::AddSheet(const std::string& name)
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+        for (size_t i = 0; i < sheets_.size(); ++i)
+        {
+            if (sheets_[i].name == name)
+                return i + 1;
+        }
+        sheets_.push_back(Sheet());
+        sheets_.back().name = name;
+        if (!activeSheet_)
+            activeSheet_ = sheets_.size();
+        return sheets_.size();
+    }
+
+    IDSHEET Grid::GetSheetId(const std::string& name) const
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        for (size_t i = 0; i < sheets_.size(); ++i)
+        {
+            if (sheets_[i].name == name)
+                return i + 1;
+        }
+        return 0;
+    }
+
+    std::string Grid::GetSheetName(IDSHEET sheet) const
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        return getSheet(sheet).name;
+    }
+
+    IDSHEET Grid::GetActiveSheet() const
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        return activeSheet_;
+    }
+
+    void Grid::SetActiveSheet(IDSHEET sheet)
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+        getSheet(sheet);
+        activeSheet_ = sheet;
+    }
+
+    void Grid::SetValue(IDSHEET sheet, RW row, COL col, const XLOPER12& value)
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+        Sheet& theSheet = getSheet(sheet);
+        if (BaseType(value) == xltypeMulti)
+        {
+            for (RW i = 0; i < value.val.array.rows && row + i < Rows; ++i)
+            {
+                for (COL j = 0; j < value.val.array.columns && col + j < Columns; ++j)
+                {
+                    theSheet.cells[key(row + i, col + j)] = HostOper(value.val.array.lparray[i * value.val.array.columns + j]);
+                }
+            }
+        }
+        else
+        {
+            if (row < 0 || row >= Rows || col < 0 || col >= Columns)
+                throw std::out_of_range("cell is outside the grid");
+            theSheet.cells[key(row, col)] = HostOper(value);
+        }
+    }
+
+    HostOper Grid::GetValue(IDSHEET sheet, RW row, COL col) const
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        const Sheet& theSheet = getSheet(sheet);
+        std::unordered_map<unsigned long long, HostOper>::const_iterator it = theSheet.cells.find(key(row, col));
+        return it == theSheet.cells.end() ? HostOper() : it->second;
+    }
+
+    HostOper Grid::GetValues(IDSHEET sheet, const XLREF12& area) const
+    {
+        if (!isValid(area))
+            throw std::out_of_range("reference is outside the grid");
+        HostOper result(HostOper::Array(area.rwLast - area.rwFirst + 1, area.colLast - area.colFirst + 1));
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        getValuesUnlocked(getSheet(sheet), area, result.Get().val.array.lparray, result.Get().val.array.columns);
+        return result;
+    }
+
+    HostOper Grid::GetValues(const XLOPER12& reference, IDSHEET currentSheet) const
+    {
+        switch (BaseType(reference))
+        {
+        case xltypeSRef:
+            return GetValues(currentSheet, reference.val.sref.ref);
+        case xltypeRef:
+            {
+                const XLMREF12* table = reference.val.mref.lpmref;
+                IDSHEET sheet = reference.val.mref.idSheet ? reference.val.mref.idSheet : currentSheet;
+                if (!table || table->count == 0)
+                    throw std::invalid_argument("reference has no areas");
+                if (table->count == 1)
+                    return GetValues(sheet, table->reftbl[0]);
+
+                size_t total = 0;
+                for (WORD i = 0; i < table->count; ++i)
+                {
+                    if (!isValid(table->reftbl[i]))
+                        throw std::out_of_range("reference is outside the grid");
+                    total += cellCount(table->reftbl[i]);
+                }
+                HostOper result(HostOper::Array(static_cast<RW>(total), 1));
+                std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+                const Sheet& theSheet = getSheet(sheet);
+                XLOPER12* destination = result.Get().val.array.lparray;
+                for (WORD i = 0; i < table->count; ++i)
+                {
+                    const XLREF12& area = table->reftbl[i];
+                    size_t width = area.colLast - area.colFirst + 1;
+                    getValuesUnlocked(theSheet, area, destination, width);
+                    destination += cellCount(area);
+                }
+                return result;
+            }
+        default:
+            throw std::invalid_argument("not a reference");
+        }
+    }
+
+    void Grid::Clear(IDSHEET sheet, const XLREF12& area)
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+        Sheet& theSheet = getSheet(sheet);
+        for (RW i = area.rwFirst; i <= area.rwLast; ++i)
+        {
+            for (COL j = area.colFirst; j <= area.colLast; ++j)
+            {
+                theSheet.cells.erase(key(i, j));
+            }
+        }
+    }
+
+    const Grid::Sheet& Grid::getSheet(IDSHEET sheet) const
+    {
+        if (sheet == 0 || sheet > sheets_.size())
+            throw std::out_of_range("no such sheet");
+        return sheets_[sheet - 1];
+    }
+
+    Grid::Sheet& Grid::getSheet(IDSHEET sheet)
+    {
+        if (sheet == 0 || sheet > sheets_.size())
+            throw std::out_of_range("no such sheet");
+        return sheets_[sheet - 1];
+    }
+
+    unsigned long long Grid::key(RW row, COL col)
+    {
+        return (static_cast<unsigned long long>(static_cast<unsigned int>(row)) << 32) | static_cast<unsigned int>(col);
+    }
+
+    void Grid::getValuesUnlocked(const Sheet& sheet, const XLREF12& area, XLOPER12* destination, size_t stride) const
+    {
+        for (RW i = area.rwFirst; i <= area.rwLast; ++i)
+        {
+            XLOPER12* row = destination + (i - area.rwFirst) * stride;
+            for (COL j = area.colFirst; j <= area.colLast; ++j)
+            {
+                std::unordered_map<unsigned long long, HostOper>::const_iterator it = sheet.cells.find(key(i, j));
+                if (it != sheet.cells.end())
+                {
+                    CopyOper(it->second.Get(), row[j - area.colFirst]);
+                }
+            }
+        }
+    }
+
+}}
@@ -0,0 +1,81 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef HOST_GRID_HEADER_GUARD
+#define HOST_GRID_HEADER_GUARD
+
+/*!
+\file Grid.h
+\brief In-memory sheets for the host simulator
+*/
+
+#include "HostOper.h"
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xlw { namespace HostSimulator {
+
+    //! Cell values of a workbook.
+    /*! Sheets are sparse, cells that were never set read as xltypeNil.
+        Reads may run concurrently with each other, writes are exclusive.
+    */
+    class Grid
+    {
+    public:
+        static const RW Rows = 1048576;
+        static const COL Columns = 16384;
+
+        //! Returns the id of the sheet, adding it if needed. Ids start at 1.
+        IDSHEET AddSheet(const std::string& name);
+        //! Returns 0 if there is no such sheet.
+        IDSHEET GetSheetId(const std::string& name) const;
+        //! Throws if there is no such sheet.
+        std::string GetSheetName(IDSHEET sheet) const;
+        //! Sheet used for references without an explicit sheet.
+        IDSHEET GetActiveSheet() const;
+        void SetActiveSheet(IDSHEET sheet);
+
+        //! Stores a copy of value, arrays fill the cells below and to the right.
+        void SetValue(IDSHEET sheet, RW row, COL col, const XLOPER12& value);
+        HostOper GetValue(IDSHEET sheet, RW row, COL col) const;
+        //! Values of a rectangle as an xltypeMulti.
+        HostOper GetValues(IDSHEET sheet, const XLREF12& area) const;
+        //! Values of all the areas of a reference, stacked in one column
+        //! for multi area references.
+        HostOper GetValues(const XLOPER12& reference, IDSHEET currentSheet) const;
+        void Clear(IDSHEET sheet, const XLREF12& area);
+
+    private:
+        struct Sheet
+        {
+            std::string name;
+            std::unordered_map<unsigned long long, HostOper> cells;
+        };
+
+        const Sheet& getSheet(IDSHEET sheet) const;
+        Sheet& getSheet(IDSHEET sheet);
+        static unsigned long long key(RW row, COL col);
+        void getValuesUnlocked(const Sheet& sheet, const XLREF12& area, XLOPER12* destination, size_t stride) const;
+
+        mutable std::shared_timed_mutex mutex_;
+        std::vector<Sheet> sheets_;
+        IDSHEET activeSheet_ = 0;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,1063 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include "Host.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace xlw { namespace HostSimulator {
+
+    namespace
+    {
+        struct CallerCell
+        {
+            IDSHEET sheet;
+            RW row;
+            COL col;
+        };
+
+        // cell being calculated and add-in being called on this thread
+        thread_local CallerCell theCaller = { 0, 0, 0 };
+        thread_local const std::string* theAddin = 0;
+
+        class AddinScope
+        {
+        public:
+            explicit AddinScope(const std::string& addin) : previous_(theAddin) { theAddin = &addin; }
+            ~AddinScope() { theAddin = previous_; }
+        private:
+            const std::string* previous_;
+        };
+
+        std::string toUpper(std::string text)
+        {
+            std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            return text;
+        }
+
+        std::string getString(const XLOPER12* oper)
+        {
+            if (!oper || BaseType(*oper) != xltypeStr)
+                return std::string();
+            return Narrow(ToWString(oper->val.str));
+        }
+
+        bool getNumber(const XLOPER12* oper, double& result)
+        {
+            if (!oper)
+                return false;
+            switch (BaseType(*oper))
+            {
+            case xltypeNum:
+                result = oper->val.num;
+                return true;
+            case xltypeInt:
+                result = oper->val.w;
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        void setError(LPXLOPER12 result, int errorCode)
+        {
+            result->xltype = xltypeErr;
+            result->val.err = errorCode;
+        }
+
+        void setBool(LPXLOPER12 result, bool value)
+        {
+            result->xltype = xltypeBool;
+            result->val.xbool = value;
+        }
+
+        // An argument is passed to the add-in as a word, which covers
+        // pointers and the by-value integer codes, or as a double for B.
+        // Where each goes depends on the calling convention, so the call is
+        // made through a function type that puts them in the same registers
+        // and stack slots as the add-in's own prototype would.
+        typedef void* Word;
+        const size_t maxArguments = 64;
+
+        struct ArgumentList
+        {
+            explicit ArgumentList(size_t count) : words(count), numbers(count), isNumber(count, false) {}
+
+            void SetNumber(size_t i, double value)
+            {
+                numbers[i] = value;
+                isNumber[i] = true;
+            }
+
+            std::vector<Word> words;
+            std::vector<double> numbers;
+            std::vector<bool> isNumber;
+        };
+
+        // the instantiation taking count words, from a table of them
+        template<class Invoker, size_t... N>
+        const Invoker& pickInvoker(const Invoker* invokers, size_t count, std::index_sequence<N...>)
+        {
+            if (count > sizeof...(N) - 1)
+                throw std::invalid_argument("too many arguments for the host to pass");
+            return invokers[count];
+        }
+
+#if defined(_WIN64) || defined(__x86_64__) || defined(__aarch64__)
+
+        // a double in a stack slot
+        Word numberWord(double value)
+        {
+            static_assert(sizeof(Word) == sizeof(double), "a stack slot holds a double");
+            Word result;
+            std::memcpy(&result, &value, sizeof(result));
+            return result;
+        }
+
+#endif
+
+#if defined(_WIN64)
+
+        // The first four arguments go in rcx, rdx, r8 and r9, or xmm0 to
+        // xmm3 for doubles, by position. The rest are stack slots.
+        const size_t registerArguments = 4;
+
+        template<bool IsNumber> struct Slot { typedef Word type; static Word get(Word word, double) { return word; } };
+        template<> struct Slot<true> { typedef double type; static double get(Word, double number) { return number; } };
+
+        template<class R, unsigned Mask, size_t... S>
+        R invokePositional(void* address, const Word* words, const double* numbers, const Word* stack, std::index_sequence<S...>)
+        {
+            typedef Slot<(Mask & 1) != 0> S0;
+            typedef Slot<(Mask & 2) != 0> S1;
+            typedef Slot<(Mask & 4) != 0> S2;
+            typedef Slot<(Mask & 8) != 0> S3;
+            typedef R (*Function)(typename S0::type, typename S1::type, typename S2::type, typename S3::type,
+                decltype((void)S, Word())...);
+            return reinterpret_cast<Function>(address)(S0::get(words[0], numbers[0]), S1::get(words[1], numbers[1]),
+                S2::get(words[2], numbers[2]), S3::get(words[3], numbers[3]), stack[S]...);
+        }
+
+        template<class R, unsigned Mask, size_t S>
+        R invokeMaskCount(void* address, const Word* words, const double* numbers, const Word* stack)
+        {
+            return invokePositional<R, Mask>(address, words, numbers, stack, std::make_index_sequence<S>());
+        }
+
+        template<class R, unsigned Mask, size_t... S>
+        R invokeMask(void* address, const Word* words, const double* numbers, const std::vector<Word>& stack, std::index_sequence<S...>)
+        {
+            typedef R (*Invoker)(void*, const Word*, const double*, const Word*);
+            static const Invoker invokers[] = { &invokeMaskCount<R, Mask, S>... };
+            return pickInvoker(invokers, stack.size(), std::index_sequence<S...>())(address, words, numbers, stack.data());
+        }
+
+        template<class R, unsigned... M>
+        R invokeAnyMask(void* address, unsigned mask, const Word* words, const double* numbers,
+            const std::vector<Word>& stack, std::integer_sequence<unsigned, M...>)
+        {
+            typedef R (*Invoker)(void*, const Word*, const double*, const std::vector<Word>&,
+                std::make_index_sequence<maxArguments - registerArguments + 1>);
+            static const Invoker invokers[] = { &invokeMask<R, M>... };
+            return invokers[mask](address, words, numbers, stack, std::make_index_sequence<maxArguments - registerArguments + 1>());
+        }
+
+        template<class R>
+        R invoke(void* address, const ArgumentList& arguments)
+        {
+            Word words[registerArguments] = { 0, 0, 0, 0 };
+            double numbers[registerArguments] = { 0.0, 0.0, 0.0, 0.0 };
+            unsigned mask = 0;
+            std::vector<Word> stack;
+            for (size_t i = 0; i < arguments.words.size(); ++i)
+            {
+                if (i < registerArguments)
+                {
+                    words[i] = arguments.words[i];
+                    numbers[i] = arguments.numbers[i];
+                    if (arguments.isNumber[i])
+                        mask |= 1u << i;
+                }
+                else
+                    stack.push_back(arguments.isNumber[i] ? numberWord(arguments.numbers[i]) : arguments.words[i]);
+            }
+            return invokeAnyMask<R>(address, mask, words, numbers, stack, std::make_integer_sequence<unsigned, 16>());
+        }
+
+#elif defined(__x86_64__) || defined(__aarch64__)
+
+        // Words and doubles each fill their own registers in order, words
+        // in rdi to r9 (x0 to x7 on ARM) and doubles in xmm0 to xmm7 (d0 to
+        // d7). Whatever doesn't fit goes in stack slots in argument order.
+        // Registers the add-in doesn't read are harmless, so every call
+        // fills them all. Apple's ARM ABI packs stack arguments more
+        // tightly, which this doesn't follow beyond the registers.
+#if defined(__aarch64__)
+        const size_t wordRegisters = 8;
+#else
+        const size_t wordRegisters = 6;
+#endif
+        const size_t numberRegisters = 8;
+
+        template<class R, size_t... W, size_t... D, size_t... S>
+        R invokeClasses(void* address, const Word* words, const double* numbers, const Word* stack,
+            std::index_sequence<W...>, std::index_sequence<D...>, std::index_sequence<S...>)
+        {
+            typedef R (*Function)(decltype((void)W, Word())..., decltype((void)D, double())..., decltype((void)S, Word())...);
+            return reinterpret_cast<Function>(address)(words[W]..., numbers[D]..., stack[S]...);
+        }
+
+        template<class R, size_t S>
+        R invokeCount(void* address, const Word* words, const double* numbers, const Word* stack)
+        {
+            return invokeClasses<R>(address, words, numbers, stack, std::make_index_sequence<wordRegisters>(),
+                std::make_index_sequence<numberRegisters>(), std::make_index_sequence<S>());
+        }
+
+        template<class R, size_t... S>
+        R invokeAny(void* address, const Word* words, const double* numbers, const std::vector<Word>& stack, std::index_sequence<S...>)
+        {
+            typedef R (*Invoker)(void*, const Word*, const double*, const Word*);
+            static const Invoker invokers[] = { &invokeCount<R, S>... };
+            return pickInvoker(invokers, stack.size(), std::index_sequence<S...>())(address, words, numbers, stack.data());
+        }
+
+        template<class R>
+        R invoke(void* address, const ArgumentList& arguments)
+        {
+            Word words[wordRegisters] = {};
+            double numbers[numberRegisters] = {};
+            size_t wordCount = 0;
+            size_t numberCount = 0;
+            std::vector<Word> stack;
+            for (size_t i = 0; i < arguments.words.size(); ++i)
+            {
+                if (arguments.isNumber[i] && numberCount < numberRegisters)
+                    numbers[numberCount++] = arguments.numbers[i];
+                else if (!arguments.isNumber[i] && wordCount < wordRegisters)
+                    words[wordCount++] = arguments.words[i];
+                else
+                    stack.push_back(arguments.isNumber[i] ? numberWord(arguments.numbers[i]) : arguments.words[i]);
+            }
+            return invokeAny<R>(address, words, numbers, stack, std::make_index_sequence<maxArguments + 1>());
+        }
+
+#else
+
+        // Everything is on the stack, a double taking two words.
+        template<class R, size_t... I>
+        R invokeWords(void* address, const Word* words, std::index_sequence<I...>)
+        {
+            typedef R (*Function)(decltype((void)I, Word())...);
+            return reinterpret_cast<Function>(address)(words[I]...);
+        }
+
+        template<class R, size_t N>
+        R invokeCount(void* address, const Word* words)
+        {
+            return invokeWords<R>(address, words, std::make_index_sequence<N>());
+        }
+
+        template<class R, size_t... N>
+        R invokeAny(void* address, const std::vector<Word>& words, std::index_sequence<N...>)
+        {
+            typedef R (*Invoker)(void*, const Word*);
+            static const Invoker invokers[] = { &invokeCount<R, N>... };
+            return pickInvoker(invokers, words.size(), std::index_sequence<N...>())(address, words.data());
+        }
+
+        template<class R>
+        R invoke(void* address, const ArgumentList& arguments)
+        {
+            std::vector<Word> words;
+            for (size_t i = 0; i < arguments.words.size(); ++i)
+            {
+                if (arguments.isNumber[i])
+                {
+                    Word halves[sizeof(double) / sizeof(Word)];
+                    std::memcpy(halves, &arguments.numbers[i], sizeof(double));
+                    words.insert(words.end(), halves, halves + sizeof(double) / sizeof(Word));
+                }
+                else
+                    words.push_back(arguments.words[i]);
+            }
+            return invokeAny<R>(address, words, std::make_index_sequence<2 * maxArguments + 1>());
+        }
+
+#endif
+
+        Word integerWord(std::intptr_t value)
+        {
+            return reinterpret_cast<Word>(value);
+        }
+
+        HostOper fpToOper(const FP12* array)
+        {
+            if (!array)
+                return HostOper::Error(xlerrNum);
+            HostOper result(HostOper::Array(array->rows, array->columns));
+            size_t size = static_cast<size_t>(array->rows) * static_cast<size_t>(array->columns);
+            for (size_t i = 0; i < size; ++i)
+            {
+                result.Get().val.array.lparray[i].xltype = xltypeNum;
+                result.Get().val.array.lparray[i].val.num = array->array[i];
+            }
+            return result;
+        }
+    }
+
+    bool Registration::IsThreadSafe() const
+    {
+        return typeText.find('$') != std::string::npos;
+    }
+
+    std::string Registration::ReturnType() const
+    {
+        if (typeText.empty())
+            return std::string();
+        size_t length = typeText.size() > 1 && typeText[1] == '%' ? 2 : 1;
+        return typeText.substr(0, length);
+    }
+
+    std::vector<std::string> Registration::ArgumentTypes() const
+    {
+        std::vector<std::string> result;
+        size_t position = ReturnType().size();
+        while (position < typeText.size())
+        {
+            char code = typeText[position];
+            if (code == '!' || code == '$' || code == '#' || code == '&')
+                break;
+            size_t length = position + 1 < typeText.size() && typeText[position + 1] == '%' ? 2 : 1;
+            result.push_back(typeText.substr(position, length));
+            position += length;
+        }
+        return result;
+    }
+
+    struct Host::Addin
+    {
+        explicit Addin(const std::string& path_) : path(path_), handle(0)
+        {
+#if defined(_WIN32)
+            handle = LoadLibraryA(path.c_str());
+            if (!handle)
+                throw std::runtime_error("could not load " + path);
+#else
+            std::string file(path.find('/') == std::string::npos ? "./" + path : path);
+            handle = dlopen(file.c_str(), RTLD_NOW | RTLD_LOCAL);
+            if (!handle)
+                throw std::runtime_error(dlerror());
+#endif
+        }
+
+        ~Addin()
+        {
+#if defined(_WIN32)
+            FreeLibrary(static_cast<HMODULE>(handle));
+#else
+            dlclose(handle);
+#endif
+        }
+
+        void* Symbol(const std::string& name) const
+        {
+#if defined(_WIN32)
+            return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(handle), name.c_str()));
+#else
+            return dlsym(handle, name.c_str());
+#endif
+        }
+
+        std::string path;
+        void* handle;
+    };
+
+    Host& Host::Instance()
+    {
+        static Host* theHost = new Host;
+        return *theHost;
+    }
+
+    Host::Host() : nextId_(1.0), abort_(false), nextHandle_(1), asyncTimeout_(60.0)
+    {
+        grid_.AddSheet("Sheet1");
+    }
+
+    void Host::LoadAddin(const std::string& path)
+    {
+        Addin* addin = new Addin(path);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            addins_.push_back(std::unique_ptr<Addin>(addin));
+        }
+
+        typedef long (*AutoOpen)();
+        AutoOpen autoOpen = reinterpret_cast<AutoOpen>(addin->Symbol("xlAutoOpen"));
+        if (!autoOpen)
+            throw std::runtime_error(path + " has no xlAutoOpen");
+
+        AddinScope scope(addin->path);
+        if (!autoOpen())
+            throw std::runtime_error("xlAutoOpen failed for " + path);
+    }
+
+    void Host::UnloadAddins()
+    {
+        std::vector<std::unique_ptr<Addin> > addins;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            addins.swap(addins_);
+        }
+        for (size_t i = 0; i < addins.size(); ++i)
+        {
+            typedef long (*AutoClose)();
+            AutoClose autoClose = reinterpret_cast<AutoClose>(addins[i]->Symbol("xlAutoClose"));
+            if (autoClose)
+            {
+                AddinScope scope(addins[i]->path);
+                autoClose();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        registrations_.clear();
+    }
+
+    std::vector<Registration> Host::GetRegistrations() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return registrations_;
+    }
+
+    bool Host::FindRegistration(const std::string& functionText, Registration& result) const
+    {
+        std::string name(toUpper(functionText));
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < registrations_.size(); ++i)
+        {
+            if (toUpper(registrations_[i].functionText) == name)
+            {
+                result = registrations_[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    HostOper Host::Call(const Registration& function, const std::vector<HostOper>& arguments)
+    {
+        std::vector<std::string> types(function.ArgumentTypes());
+        if (arguments.size() > types.size())
+            throw std::invalid_argument(function.functionText + " takes " + std::to_string(types.size()) + " arguments");
+
+        // keeps everything the words point at alive for the call
+        std::vector<HostOper> opers(types.size());
+        std::vector<std::wstring> strings(types.size());
+        std::vector<std::vector<char> > arrays(types.size());
+        ArgumentList passed(types.size());
+
+        IDSHEET sheet(currentSheet());
+        for (size_t i = 0; i < types.size(); ++i)
+        {
+            const std::string& type = types[i];
+            HostOper argument(i < arguments.size() ? arguments[i] : HostOper::Missing());
+            DWORD argumentType = argument.Type();
+            bool isReference = argumentType == xltypeRef || argumentType == xltypeSRef;
+
+            if (type == "U" || type == "R" || type == "X")
+            {
+                opers[i] = argument;
+                passed.words[i] = &opers[i].Get();
+                continue;
+            }
+            if (isReference)
+            {
+                HostOper values(grid_.GetValues(argument.Get(), sheet));
+                if (values.Get().val.array.rows == 1 && values.Get().val.array.columns == 1)
+                    argument = HostOper(values.Get().val.array.lparray[0]);
+                else
+                    argument = values;
+            }
+
+            if (type == "Q" || type == "P")
+            {
+                opers[i] = argument;
+                passed.words[i] = &opers[i].Get();
+            }
+            else if (type == "C%" || type == "D%")
+            {
+                if (CoerceValue(argument.Get(), xltypeStr, opers[i].Get()) != xlretSuccess)
+                    return HostOper::Error(xlerrValue);
+                if (type == "D%")
+                {
+                    passed.words[i] = opers[i].Get().val.str;
+                }
+                else
+                {
+                    strings[i] = ToWString(opers[i].Get().val.str);
+                    passed.words[i] = &strings[i][0];
+                }
+            }
+            else if (type == "K%")
+            {
+                HostOper values;
+                if (CoerceValue(argument.Get(), xltypeMulti, values.Get()) != xlretSuccess)
+                    return HostOper::Error(xlerrValue);
+                RW rows = values.Get().val.array.rows;
+                COL columns = values.Get().val.array.columns;
+                size_t size = static_cast<size_t>(rows) * static_cast<size_t>(columns);
+                arrays[i].resize(sizeof(FP12) + (size ? size - 1 : 0) * sizeof(double));
+                FP12* array = reinterpret_cast<FP12*>(&arrays[i][0]);
+                array->rows = rows;
+                array->columns = columns;
+                for (size_t j = 0; j < size; ++j)
+                {
+                    XLOPER12 number;
+                    if (CoerceValue(values.Get().val.array.lparray[j], xltypeNum, number) != xlretSuccess)
+                        return HostOper::Error(xlerrValue);
+                    array->array[j] = number.val.num;
+                }
+                passed.words[i] = array;
+            }
+            else if (type == "B")
+            {
+                XLOPER12 number;
+                if (CoerceValue(argument.Get(), xltypeNum, number) != xlretSuccess)
+                    return HostOper::Error(xlerrValue);
+                passed.SetNumber(i, number.val.num);
+            }
+            else if (type == "A" || type == "J" || type == "I" || type == "H" || type == "L" || type == "M")
+            {
+                XLOPER12 number;
+                if (CoerceValue(argument.Get(), xltypeNum, number) != xlretSuccess)
+                    return HostOper::Error(xlerrValue);
+                if (type == "A")
+                    passed.words[i] = integerWord(number.val.num != 0.0);
+                else
+                    passed.words[i] = integerWord(static_cast<std::intptr_t>(number.val.num));
+            }
+            else
+            {
+                throw std::invalid_argument("argument type " + type + " of " + function.functionText + " is not supported by the host");
+            }
+        }
+
+        AddinScope scope(function.addin);
+        std::string returnType(function.ReturnType());
+        if (returnType == "Q" || returnType == "U" || returnType == "P" || returnType == "R")
+        {
+            LPXLOPER12 result = invoke<LPXLOPER12>(function.address, passed);
+            if (!result)
+                return HostOper::Error(xlerrNum);
+            HostOper value(*result);
+            freeResult(function, result);
+            return value;
+        }
+        if (returnType == "K%")
+        {
+            return fpToOper(invoke<FP12*>(function.address, passed));
+        }
+        if (returnType == "C%")
+        {
+            const XCHAR* result = invoke<XCHAR*>(function.address, passed);
+            return result ? HostOper::String(std::wstring(result)) : HostOper::Error(xlerrNum);
+        }
+        if (returnType == "D%")
+        {
+            const XCHAR* result = invoke<XCHAR*>(function.address, passed);
+            return result ? HostOper::String(ToWString(result)) : HostOper::Error(xlerrNum);
+        }
+        if (returnType == "B")
+        {
+            return HostOper::Number(invoke<double>(function.address, passed));
+        }
+        if (returnType == "A")
+        {
+            return HostOper::Boolean(static_cast<short>(invoke<std::intptr_t>(function.address, passed)) != 0);
+        }
+        if (returnType == "J" || returnType == "I" || returnType == "H")
+        {
+            return HostOper::Number(static_cast<std::int32_t>(invoke<std::intptr_t>(function.address, passed)));
+        }
+        if (returnType == ">")
+        {
+            if (!types.empty() && types.back() == "X")
+            {
+                // the handle goes in the X argument, which is last
+                return callAsync([&function, &passed](LPXLOPER12 handle)
+                {
+                    passed.words.back() = handle;
+                    invoke<void>(function.address, passed);
+                });
+            }
+            invoke<void>(function.address, passed);
+            return HostOper();
+        }
+        if (returnType.size() == 1 && returnType[0] >= '1' && returnType[0] <= '9')
+        {
+            // modified in place, Excel uses the argument as the result
+            size_t position = returnType[0] - '1';
+            if (position >= types.size() || types[position] != "K%")
+                throw std::invalid_argument("only K% arguments can be modified in place by " + function.functionText);
+            invoke<void>(function.address, passed);
+            return fpToOper(static_cast<FP12*>(passed.words[position]));
+        }
+        throw std::invalid_argument("return type " + returnType + " of " + function.functionText + " is not supported by the host");
+    }
+
+    void Host::SetCaller(IDSHEET sheet, RW row, COL col)
+    {
+        theCaller.sheet = sheet;
+        theCaller.row = row;
+        theCaller.col = col;
+    }
+
+    void Host::ClearCaller()
+    {
+        theCaller.sheet = 0;
+    }
+
+    void Host::RequestAbort(bool abort)
+    {
+        abort_ = abort;
+    }
+
+    HostOper Host::callAsync(const std::function<void(LPXLOPER12)>& start)
+    {
+        XLOPER12 handle;
+        handle.xltype = xltypeBigData;
+        handle.val.bigdata.cbData = 0;
+        std::uintptr_t id;
+        {
+            std::lock_guard<std::mutex> lock(asyncMutex_);
+            id = nextHandle_++;
+            pending_[id].returned = false;
+        }
+        handle.val.bigdata.h.lpbData = reinterpret_cast<BYTE*>(id);
+        start(&handle);
+
+        std::unique_lock<std::mutex> lock(asyncMutex_);
+        std::chrono::duration<double> timeout(asyncTimeout_);
+        asyncReturned_.wait_for(lock, timeout, [this, id]()
+        {
+            std::map<std::uintptr_t, Pending>::const_iterator found = pending_.find(id);
+            return found == pending_.end() || found->second.returned;
+        });
+        std::map<std::uintptr_t, Pending>::iterator found = pending_.find(id);
+        // cancelled, or never returned
+        if (found == pending_.end() || !found->second.returned)
+        {
+            if (found != pending_.end())
+                pending_.erase(found);
+            return HostOper::Error(xlerrNA);
+        }
+        HostOper result(found->second.value);
+        pending_.erase(found);
+        return result;
+    }
+
+    void Host::CancelCalculation()
+    {
+        std::vector<std::string> commands;
+        {
+            std::lock_guard<std::mutex> lock(asyncMutex_);
+            typedef std::multimap<int, std::string>::const_iterator Iterator;
+            std::pair<Iterator, Iterator> range(events_.equal_range(xleventCalculationCanceled));
+            for (Iterator it = range.first; it != range.second; ++it)
+                commands.push_back(it->second);
+        }
+
+        // the add-ins hear of it before the calls waiting on them give up,
+        // so what those calls go on to submit belongs to the next calculation
+        for (size_t i = 0; i < commands.size(); ++i)
+        {
+            Registration command;
+            if (FindRegistration(commands[i], command))
+            {
+                AddinScope scope(command.addin);
+                invoke<int>(command.address, ArgumentList(0));
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(asyncMutex_);
+            pending_.clear();
+        }
+        asyncReturned_.notify_all();
+    }
+
+    void Host::SetAsyncTimeout(double seconds)
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex_);
+        asyncTimeout_ = seconds;
+    }
+
+    int Host::Dispatch(int xlfn, int count, LPXLOPER12 const* opers, LPXLOPER12 result)
+    {
+        // callers that don't want the result pass 0
+        HostOper ignored;
+        if (!result)
+            result = &ignored.Get();
+
+        try
+        {
+            switch (xlfn)
+            {
+            case xlCoerce:
+                return coerce(count, opers, result);
+            case xlFree:
+                for (int i = 0; i < count; ++i)
+                {
+                    if (opers[i])
+                        FreeOper(*opers[i]);
+                }
+                return xlretSuccess;
+            case xlfRegister:
+                return registerFunction(count, opers, result);
+            case xlfUnregister:
+                return unregisterFunction(count, opers, result);
+            case xlAbort:
+                setBool(result, abort_);
+                if (count > 0 && opers[0] && BaseType(*opers[0]) == xltypeBool && !opers[0]->val.xbool)
+                    abort_ = false;
+                return xlretSuccess;
+            case xlfCaller:
+                return caller(result);
+            case xlSheetId:
+                return sheetId(count, opers, result);
+            case xlSheetNm:
+                return sheetName(count, opers, result);
+            case xlGetName:
+                return getName(result);
+            case xlfGetWorkspace:
+                return getWorkspace(count, opers, result);
+            case xlEventRegister:
+                return eventRegister(count, opers, result);
+            case xlAsyncReturn:
+                return asyncReturn(count, opers, result);
+            case xlfSetName:
+            case xlcMessage:
+                setBool(result, true);
+                return xlretSuccess;
+            default:
+                return xlretInvXlfn;
+            }
+        }
+        catch (std::exception&)
+        {
+            return xlretFailed;
+        }
+    }
+
+    int Host::eventRegister(int count, LPXLOPER12 const* opers, LPXLOPER12 result)
+    {
+        double event;
+        if (count < 2 || !getNumber(opers[1], event))
+            return xlretInvXloper;
+        std::lock_guard<std::mutex> lock(asyncMutex_);
+        events_.insert(std::make_pair(static_cast<int>(event), getString(opers[0])));
+        setBool(result, true);
+        return xlretSuccess;
+    }
+
+    int Host::asyncReturn(int count, LPXLOPER12 const* opers, LPXLOPER12 result)
+    {
+        if (count < 2 || !opers[0] || !opers[1])
+            return xlretInvCount;
+
+        // one handle and its result, or a row of each
+        const XLOPER12* handles = opers[0];
+        const XLOPER12* values = opers[1];
+        size_t size = 1;
+        if (BaseType(*handles) == xltypeMulti)
+        {
+            if (BaseType(*values) != xltypeMulti)
+                return xlretInvXloper;
+            size = static_cast<size_t>(handles->val.array.rows) * static_cast<size_t>(handles->val.array.columns);
+            if (size != static_cast<size_t>(values->val.array.rows) * static_cast<size_t>(values->val.array.columns))
+                return xlretInvXloper;
+            handles = handles->val.array.lparray;
+            values = values->val.array.lparray;
+        }
+
+        bool valid = true;
+        {
+            std::lock_guard<std::mutex> lock(asyncMutex_);
+            for (size_t i = 0; i < size; ++i)
+            {
+                std::map<std::uintptr_t, Pending>::iterator found = pending_.end();
+                if (BaseType(handles[i]) == xltypeBigData)
+                    found = pending_.find(reinterpret_cast<std::uintptr_t>(handles[i].val.bigdata.h.lpbData));
+                if (found == pending_.end() || found->second.returned)
+                {
+                    valid = false;
+                    continue;
+                }
+                found->second.value = HostOper(values[i]);
+                found->second.returned = true;
+            }
+        }
+        asyncReturned_.notify_all();
+        setBool(result, valid);
+        return valid ? xlretSuccess : xlRetInvAsynchronousContext;
+    }
+
+    int Host::coerce(int count, LPXLOPER12 const* opers, LPXLOPER12 result)
+    {
+        if (count < 1 || !opers[0])
+            return xlretInvCount;
+
+        DWORD toTypes = 0;
+        double requested;
+        if (count > 1 && getNumber(opers[1], requested))
+            toTypes = static_cast<DWORD>(requested);
+
+        const XLOPER12& from = *opers[0];
+        DWORD type = BaseType(from);
+        if (type != xltypeRef && type != xltypeSRef)
+        {
+            if (!toTypes)
+            {
+                CopyOper(from, *result);
+                return xlretSuccess;
+            }
+            return CoerceValue(from, toTypes, *result);
+        }
+
+        if (toTypes & type)
+        {
+            CopyOper(from, *result);
+            return xlretSuccess;
+        }
+        if (toTypes & xltypeRef)
+        {
+            XLOPER12 reference(HostOper::Reference(currentSheet(), from.val.sref.ref).Release());
+            *result = reference;
+            return xlretSuccess;
+        }
+
+        HostOper values(grid_.GetValues(from, currentSheet()));
+        bool isSingleCell = values.Get().val.array.rows == 1 && values.Get().val.array.columns == 1;
+        if (!toTypes)
+        {
+            *result = isSingleCell ? HostOper(values.Get().val.array.lparray[0]).Release() : values.Release();
+            return xlretSuccess;
+        }
+        return CoerceValue(values.Get(), toTypes, *result);
+    }
+
+    int Host::registerFunction(int count, LPXLOPER12 const* opers, LPXLOPER12 result)
+    {
+        if (count < 3)
+            return xlretInvCount;
+
+        Registration registration;
+        registration.addin = getString(opers[0]);
+        registration.procedure = getString(opers[1]);
+        registration.typeText = getString(opers[2]);
+        registration.functionText = count > 3 ? getString(opers[3]) : std::string();
+        registration.argumentText = count > 4 ? getString(opers[4]) : std::string();
+        double macroType = 1.0;
+        if (count > 5)
+            getNumber(opers[5], macroType);
+        registration.macroType = static_cast<int>(macroType);
+        registration.address = 0;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < addins_.size() && !registration.address; ++i)
+        {
+            if (addins_[i]->path == registration.addin || (theAddin && addins_[i]->path == *theAddin))
+                registration.address = addins_[i]->Symbol(registration.procedure);
+        }
+        if (!registration.address)
+        {
+            // Excel reports a bad registration through the result
+            setError(result, xlerrValue);
+            return xlretSuccess;
+        }
+
+        registration.id = nextId_;
+        nextId_ += 1.0;
+        registrations_.push_back(registration);
+        result->xltype = xltypeNum;
+        result->val.num = registration.id;
+        return xlretSuccess;
+    }
+
+    int Host::unregisterFunction(int count, LPXLOPER12 const* opers, LPXLOPER12 result)
+    {
+        double id;
+        if (count < 1 || !getNumber(opers[0], id))
+            return xlretInvXloper;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<Registration>::iterator it = registrations_.begin();
+        while (it != registrations_.end() && it->id != id)
+            ++it;
+        setBool(result, it != registrations_.end());
+        if (it != registrations_.end())
+            registrations_.erase(it);
+        return xlretSuccess;
+    }
+
+    int Host::caller(LPXLOPER12 result)
+    {
+        if (!theCaller.sheet)
+        {
+            setError(result, xlerrRef);
+            return xlretSuccess;
+        }
+        XLREF12 cell = { theCaller.row, theCaller.row, theCaller.col, theCaller.col };
+        *result = HostOper::Reference(theCaller.sheet, cell).Release();
+        return xlretSuccess;
+    }
+
+    int Host::sheetId(int count, LPXLOPER12 const* opers, LPXLOPER12 result)
+    {
+        IDSHEET sheet = 0;
+        if (count == 0 || !opers[0])
+        {
+            sheet = currentSheet();
+        }
+        else if (BaseType(*opers[0]) == xltypeRef)
+        {
+            sheet = opers[0]->val.mref.idSheet;
+        }
+        else
+        {
+            std::string name(getString(opers[0]));
+            // drop any [Book] prefix
+            size_t bracket = name.find(']');
+            if (bracket != std::string::npos)
+                name = name.substr(bracket + 1);
+            sheet = grid_.GetSheetId(name);
+        }
+        if (!sheet)
+            return xlretFailed;
+
+        // no reference table, this is what Excel returns and xlw relies on it
+        result->xltype = xltypeRef;
+        result->val.mref.lpmref = 0;
+        result->val.mref.idSheet = sheet;
+        return xlretSuccess;
+    }
+
+    int Host::sheetName(int count, LPXLOPER12 const* opers, LPXLOPER12 result)
+    {
+        IDSHEET sheet = currentSheet();
+        if (count > 0 && opers[0] && BaseType(*opers[0]) == xltypeRef && opers[0]->val.mref.idSheet)
+            sheet = opers[0]->val.mref.idSheet;
+        result->xltype = xltypeStr;
+        result->val.str = NewString(Widen("[Book1]" + grid_.GetSheetName(sheet)));
+        return xlretSuccess;
+    }
+
+    int Host::getWorkspace(int count, LPXLOPER12 const* opers, LPXLOPER12 result)
+    {
+        double type;
+        if (count < 1 || !getNumber(opers[0], type))
+            return xlretInvXloper;
+
+        switch (static_cast<int>(type))
+        {
+        case 1:
+            result->xltype = xltypeStr;
+            result->val.str = NewString(L"xlw host simulator");
+            return xlretSuccess;
+        case 2:
+            result->xltype = xltypeStr;
+            result->val.str = NewString(L"16.0");
+            return xlretSuccess;
+        case 37:
+            {
+                // international settings, English with . and , separators
+                HostOper settings(HostOper::Array(1, 45));
+                XLOPER12* items = settings.Get().val.array.lparray;
+                items[0].xltype = items[1].xltype = xltypeNum;
+                items[0].val.num = items[1].val.num = 1.0;
+                items[2].xltype = items[3].xltype = items[4].xltype = xltypeStr;
+                items[2].val.str = NewString(L".");
+                items[3].val.str = NewString(L",");
+                items[4].val.str = NewString(L",");
+                *result = settings.Release();
+                return xlretSuccess;
+            }
+        default:
+            return xlretFailed;
+        }
+    }
+
+    int Host::getName(LPXLOPER12 result)
+    {
+        if (!theAddin)
+            return xlretFailed;
+        result->xltype = xltypeStr;
+        result->val.str = NewString(Widen(*theAddin));
+        return xlretSuccess;
+    }
+
+    IDSHEET Host::currentSheet() const
+    {
+        return theCaller.sheet ? theCaller.sheet : grid_.GetActiveSheet();
+    }
+
+    void Host::freeResult(const Registration& function, LPXLOPER12 result)
+    {
+        if (!(result->xltype & xlbitDLLFree))
+            return;
+
+        typedef void (*AutoFree)(LPXLOPER12);
+        AutoFree autoFree = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < addins_.size() && !autoFree; ++i)
+            {
+                if (addins_[i]->path == function.addin)
+                    autoFree = reinterpret_cast<AutoFree>(addins_[i]->Symbol("xlAutoFree12"));
+            }
+        }
+        if (autoFree)
+            autoFree(result);
+    }
+
+}}
+
+using xlw::HostSimulator::Host;
+
+extern "C"
+{
+    //! Looked up by xlcall.cpp in place of Excel's own entry point.
+#if defined(_WIN32)
+    __declspec(dllexport) int __stdcall
+#else
+    __attribute__((visibility("default"))) int
+#endif
+    MdCallBack12(int xlfn, int count, LPXLOPER12* opers, LPXLOPER12 result)
+    {
+        return Host::Instance().Dispatch(xlfn, count, opers, result);
+    }
+}
@@ -0,0 +1,160 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef HOST_HEADER_GUARD
+#define HOST_HEADER_GUARD
+
+/*!
+\file Host.h
+\brief An in-process stand-in for Excel
+
+The host implements the MdCallBack12 entry point that xlcall.cpp looks up, so
+an XLL loaded into a program linked with this library calls back into the
+host instead of Excel. The executable must export its symbols (ENABLE_EXPORTS
+in CMake) for the XLL to find the entry point.
+
+Callbacks handled: xlCoerce, xlFree, xlfRegister, xlfUnregister, xlAbort,
+xlfCaller, xlSheetId, xlSheetNm, xlGetName, xlfGetWorkspace, xlfSetName,
+xlcMessage, xlEventRegister and xlAsyncReturn. Anything else returns
+xlretInvXlfn.
+
+Asynchronous functions, registered as returning > with a last X argument,
+are passed a handle and the call waits until xlAsyncReturn gives a result
+for it, so they can be calculated like any other.
+*/
+
+#include "Grid.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace xlw { namespace HostSimulator {
+
+    //! A function or command registered by an add-in.
+    struct Registration
+    {
+        double id;
+        std::string addin;
+        std::string procedure;
+        std::string typeText;
+        std::string functionText;
+        std::string argumentText;
+        int macroType;
+        void* address;
+
+        //! Registered with $, may be called from any calculation thread.
+        bool IsThreadSafe() const;
+        //! Return type code, the leading characters of the type text.
+        std::string ReturnType() const;
+        //! Argument type codes, one entry per argument.
+        std::vector<std::string> ArgumentTypes() const;
+    };
+
+    class Host
+    {
+    public:
+        static Host& Instance();
+
+        Grid& GetGrid() { return grid_; }
+
+        //! Loads an XLL and runs xlAutoOpen, throws if either fails.
+        void LoadAddin(const std::string& path);
+        //! Runs xlAutoClose for every add-in and unloads them.
+        void UnloadAddins();
+
+        std::vector<Registration> GetRegistrations() const;
+        //! Looks a function up by its worksheet name, ignoring case.
+        //! Returns false if there is no such function.
+        bool FindRegistration(const std::string& functionText, Registration& result) const;
+
+        //! Calls a registered function.
+        /*! Arguments are converted according to the registered type text, a
+            reference passed to a value argument is read from the grid. The
+            result is copied into host memory before returning.
+        */
+        HostOper Call(const Registration& function, const std::vector<HostOper>& arguments);
+
+        //! Cell reported by xlfCaller for calls made from this thread.
+        static void SetCaller(IDSHEET sheet, RW row, COL col);
+        static void ClearCaller();
+
+        //! Makes xlAbort report that the user pressed escape.
+        void RequestAbort(bool abort);
+
+        //! Cancels the calculation as Excel does when the user presses escape.
+        /*! Asynchronous calls still waiting give up with \#N/A, their handles
+            are no longer valid, and the commands registered for
+            xleventCalculationCanceled are run.
+        */
+        void CancelCalculation();
+        //! How long an asynchronous call waits for its result before giving up with \#N/A.
+        void SetAsyncTimeout(double seconds);
+
+        //! Entry point for every call an add-in makes through Excel12v.
+        int Dispatch(int xlfn, int count, LPXLOPER12 const* opers, LPXLOPER12 result);
+
+    private:
+        // never destroyed, add-ins may call back while the process exits
+        Host();
+        Host(const Host&);
+        Host& operator=(const Host&);
+
+        struct Addin;
+
+        int coerce(int count, LPXLOPER12 const* opers, LPXLOPER12 result);
+        int registerFunction(int count, LPXLOPER12 const* opers, LPXLOPER12 result);
+        int unregisterFunction(int count, LPXLOPER12 const* opers, LPXLOPER12 result);
+        int caller(LPXLOPER12 result);
+        int sheetId(int count, LPXLOPER12 const* opers, LPXLOPER12 result);
+        int sheetName(int count, LPXLOPER12 const* opers, LPXLOPER12 result);
+        int getWorkspace(int count, LPXLOPER12 const* opers, LPXLOPER12 result);
+        int getName(LPXLOPER12 result);
+        int eventRegister(int count, LPXLOPER12 const* opers, LPXLOPER12 result);
+        int asyncReturn(int count, LPXLOPER12 const* opers, LPXLOPER12 result);
+        HostOper callAsync(const std::function<void(LPXLOPER12)>& start);
+        IDSHEET currentSheet() const;
+        void freeResult(const Registration& function, LPXLOPER12 result);
+
+        Grid grid_;
+        mutable std::mutex mutex_;
+        std::vector<std::unique_ptr<Addin> > addins_;
+        std::vector<Registration> registrations_;
+        double nextId_;
+        std::atomic<bool> abort_;
+
+        // asynchronous calls waiting for xlAsyncReturn, by handle
+        struct Pending
+        {
+            bool returned;
+            HostOper value;
+        };
+        std::mutex asyncMutex_;
+        std::condition_variable asyncReturned_;
+        std::map<std::uintptr_t, Pending> pending_;
+        std::uintptr_t nextHandle_;
+        double asyncTimeout_;
+        // commands registered with xlEventRegister, by event
+        std::multimap<int, std::string> events_;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,505 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include "HostOper.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cwctype>
+#include <utility>
+
+namespace xlw { namespace HostSimulator {
+
+    namespace
+    {
+        const DWORD memoryBits = xlbitXLFree | xlbitDLLFree;
+
+        XLMREF12* newReferenceTable(WORD count)
+        {
+            // XLMREF12 already holds one area
+            size_t extra = count > 1 ? count - 1 : 0;
+            char* memory = new char[sizeof(XLMREF12) + extra * sizeof(XLREF12)];
+            XLMREF12* table = reinterpret_cast<XLMREF12*>(memory);
+            table->count = count;
+            return table;
+        }
+
+        void deleteReferenceTable(XLMREF12* table)
+        {
+            delete [] reinterpret_cast<char*>(table);
+        }
+
+        void setNil(XLOPER12& oper)
+        {
+            oper.xltype = xltypeNil;
+            oper.val.num = 0.0;
+        }
+
+        std::wstring trim(const std::wstring& text)
+        {
+            size_t first = 0;
+            while (first < text.size() && std::iswspace(text[first]))
+                ++first;
+            size_t last = text.size();
+            while (last > first && std::iswspace(text[last - 1]))
+                --last;
+            return text.substr(first, last - first);
+        }
+
+        bool parseNumber(const std::wstring& text, double& result)
+        {
+            std::wstring trimmed(trim(text));
+            if (trimmed.empty())
+                return false;
+            wchar_t* end = 0;
+            result = std::wcstod(trimmed.c_str(), &end);
+            return end == trimmed.c_str() + trimmed.size() && std::isfinite(result);
+        }
+
+        std::wstring formatNumber(double value)
+        {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+            return std::wstring(buffer, buffer + std::char_traits<char>::length(buffer));
+        }
+
+        bool equalsIgnoringCase(const std::wstring& text, const wchar_t* word)
+        {
+            size_t i = 0;
+            for (; i < text.size() && word[i]; ++i)
+            {
+                if (std::towupper(text[i]) != static_cast<wint_t>(word[i]))
+                    return false;
+            }
+            return i == text.size() && !word[i];
+        }
+
+        // scalar conversions, the order of preference follows Excel
+        int coerceScalar(const XLOPER12& from, DWORD toTypes, XLOPER12& to)
+        {
+            DWORD type = BaseType(from);
+            if (type & toTypes)
+            {
+                CopyOper(from, to);
+                return xlretSuccess;
+            }
+
+            double number = 0.0;
+            bool haveNumber = false;
+            switch (type)
+            {
+            case xltypeNum:
+                number = from.val.num;
+                haveNumber = true;
+                break;
+            case xltypeInt:
+                number = from.val.w;
+                haveNumber = true;
+                break;
+            case xltypeBool:
+                number = from.val.xbool ? 1.0 : 0.0;
+                haveNumber = true;
+                break;
+            case xltypeNil:
+            case xltypeMissing:
+                number = 0.0;
+                haveNumber = true;
+                break;
+            case xltypeStr:
+                haveNumber = parseNumber(ToWString(from.val.str), number);
+                break;
+            default:
+                break;
+            }
+
+            if (toTypes & xltypeNum && haveNumber)
+            {
+                to.xltype = xltypeNum;
+                to.val.num = number;
+                return xlretSuccess;
+            }
+            if (toTypes & xltypeInt && haveNumber)
+            {
+                to.xltype = xltypeInt;
+                to.val.w = static_cast<int>(number);
+                return xlretSuccess;
+            }
+            if (toTypes & xltypeBool)
+            {
+                if (type == xltypeStr)
+                {
+                    std::wstring text(trim(ToWString(from.val.str)));
+                    if (equalsIgnoringCase(text, L"TRUE") || equalsIgnoringCase(text, L"FALSE"))
+                    {
+                        to.xltype = xltypeBool;
+                        to.val.xbool = equalsIgnoringCase(text, L"TRUE");
+                        return xlretSuccess;
+                    }
+                }
+                else if (haveNumber)
+                {
+                    to.xltype = xltypeBool;
+                    to.val.xbool = number != 0.0;
+                    return xlretSuccess;
+                }
+            }
+            if (toTypes & xltypeStr)
+            {
+                std::wstring text;
+                switch (type)
+                {
+                case xltypeBool:
+                    text = from.val.xbool ? L"TRUE" : L"FALSE";
+                    break;
+                case xltypeNil:
+                case xltypeMissing:
+                    break;
+                case xltypeNum:
+                case xltypeInt:
+                    text = formatNumber(number);
+                    break;
+                default:
+                    return xlretFailed;
+                }
+                to.xltype = xltypeStr;
+                to.val.str = NewString(text);
+                return xlretSuccess;
+            }
+            if (toTypes & xltypeNil && (type == xltypeMissing))
+            {
+                setNil(to);
+                return xlretSuccess;
+            }
+            return xlretFailed;
+        }
+    }
+
+    DWORD BaseType(const XLOPER12& oper)
+    {
+        return oper.xltype & ~memoryBits;
+    }
+
+    std::wstring Widen(const std::string& text)
+    {
+        std::wstring result;
+        result.reserve(text.size());
+        size_t i = 0;
+        while (i < text.size())
+        {
+            unsigned char lead = static_cast<unsigned char>(text[i]);
+            size_t length = lead < 0x80 ? 1 : lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 0;
+            unsigned long codePoint = length == 1 ? lead : length == 2 ? lead & 0x1F : length == 3 ? lead & 0x0F : lead & 0x07;
+            bool valid = length != 0 && i + length <= text.size();
+            for (size_t j = 1; valid && j < length; ++j)
+            {
+                unsigned char next = static_cast<unsigned char>(text[i + j]);
+                valid = (next & 0xC0) == 0x80;
+                codePoint = (codePoint << 6) | (next & 0x3F);
+            }
+            if (!valid || codePoint > 0x10FFFF)
+            {
+                codePoint = 0xFFFD;
+                length = 1;
+            }
+            if (sizeof(wchar_t) == 2 && codePoint > 0xFFFF)
+            {
+                codePoint -= 0x10000;
+                result += static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+                result += static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+            }
+            else
+            {
+                result += static_cast<wchar_t>(codePoint);
+            }
+            i += length;
+        }
+        return result;
+    }
+
+    std::string Narrow(const std::wstring& text)
+    {
+        std::string result;
+        result.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            unsigned long codePoint = static_cast<unsigned long>(text[i]);
+            if (sizeof(wchar_t) == 2 && codePoint >= 0xD800 && codePoint < 0xDC00 && i + 1 < text.size())
+            {
+                unsigned long low = static_cast<unsigned long>(text[i + 1]);
+                if (low >= 0xDC00 && low < 0xE000)
+                {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    ++i;
+                }
+            }
+            if (codePoint < 0x80)
+            {
+                result += static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                result += static_cast<char>(0xC0 | (codePoint >> 6));
+                result += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                result += static_cast<char>(0xE0 | (codePoint >> 12));
+                result += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                result += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                result += static_cast<char>(0xF0 | (codePoint >> 18));
+                result += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                result += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                result += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+        return result;
+    }
+
+    XCHAR* NewString(const std::wstring& value)
+    {
+        size_t length = std::min<size_t>(value.size(), 32767);
+        XCHAR* result = new XCHAR[length + 2];
+        result[0] = static_cast<XCHAR>(length);
+        std::copy(value.begin(), value.begin() + length, result + 1);
+        // null terminate as well, some add-ins rely on it
+        result[length + 1] = 0;
+        return result;
+    }
+
+    std::wstring ToWString(const XCHAR* countedString)
+    {
+        if (!countedString)
+            return std::wstring();
+        return std::wstring(countedString + 1, countedString + 1 + static_cast<size_t>(countedString[0]));
+    }
+
+    void CopyOper(const XLOPER12& from, XLOPER12& to)
+    {
+        DWORD type = BaseType(from);
+        to = from;
+        to.xltype = type;
+        switch (type)
+        {
+        case xltypeStr:
+            to.val.str = NewString(ToWString(from.val.str));
+            break;
+        case xltypeRef:
+            if (from.val.mref.lpmref)
+            {
+                WORD count = from.val.mref.lpmref->count;
+                to.val.mref.lpmref = newReferenceTable(count);
+                std::copy(from.val.mref.lpmref->reftbl, from.val.mref.lpmref->reftbl + count,
+                          to.val.mref.lpmref->reftbl);
+            }
+            break;
+        case xltypeMulti:
+            {
+                size_t size = static_cast<size_t>(from.val.array.rows) * static_cast<size_t>(from.val.array.columns);
+                to.val.array.lparray = new XLOPER12[size];
+                for (size_t i = 0; i < size; ++i)
+                {
+                    CopyOper(from.val.array.lparray[i], to.val.array.lparray[i]);
+                }
+            }
+            break;
+        case xltypeBigData:
+            // a handle or a buffer we don't own, leave it alone
+            break;
+        default:
+            break;
+        }
+    }
+
+    void FreeOper(XLOPER12& oper)
+    {
+        switch (BaseType(oper))
+        {
+        case xltypeStr:
+            delete [] oper.val.str;
+            break;
+        case xltypeRef:
+            deleteReferenceTable(oper.val.mref.lpmref);
+            break;
+        case xltypeMulti:
+            {
+                size_t size = static_cast<size_t>(oper.val.array.rows) * static_cast<size_t>(oper.val.array.columns);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    FreeOper(oper.val.array.lparray[i]);
+                }
+                delete [] oper.val.array.lparray;
+            }
+            break;
+        default:
+            break;
+        }
+        setNil(oper);
+    }
+
+    int CoerceValue(const XLOPER12& from, DWORD toTypes, XLOPER12& to)
+    {
+        DWORD type = BaseType(from);
+        if (type == xltypeMulti)
+        {
+            if (toTypes & xltypeMulti)
+            {
+                CopyOper(from, to);
+                return xlretSuccess;
+            }
+            // Excel converts an array to a scalar using its first element
+            if (from.val.array.rows < 1 || from.val.array.columns < 1)
+                return xlretFailed;
+            return coerceScalar(from.val.array.lparray[0], toTypes, to);
+        }
+        if (toTypes & xltypeMulti && !(type & toTypes))
+        {
+            XLOPER12 element;
+            int err = coerceScalar(from, toTypes & ~xltypeMulti, element);
+            if (err != xlretSuccess)
+            {
+                // keep the value as it is, any scalar can live in an array
+                CopyOper(from, element);
+            }
+            to.xltype = xltypeMulti;
+            to.val.array.rows = 1;
+            to.val.array.columns = 1;
+            to.val.array.lparray = new XLOPER12[1];
+            to.val.array.lparray[0] = element;
+            return xlretSuccess;
+        }
+        return coerceScalar(from, toTypes, to);
+    }
+
+    HostOper::HostOper()
+    {
+        setNil(oper_);
+    }
+
+    HostOper::HostOper(const XLOPER12& value)
+    {
+        CopyOper(value, oper_);
+    }
+
+    HostOper::HostOper(const HostOper& other)
+    {
+        CopyOper(other.oper_, oper_);
+    }
+
+    HostOper::HostOper(HostOper&& other)
+    {
+        oper_ = other.oper_;
+        setNil(other.oper_);
+    }
+
+    HostOper& HostOper::operator=(HostOper other)
+    {
+        swap(other);
+        return *this;
+    }
+
+    HostOper::~HostOper()
+    {
+        FreeOper(oper_);
+    }
+
+    void HostOper::swap(HostOper& other)
+    {
+        std::swap(oper_, other.oper_);
+    }
+
+    XLOPER12 HostOper::Release()
+    {
+        XLOPER12 result(oper_);
+        setNil(oper_);
+        return result;
+    }
+
+    HostOper HostOper::Number(double value)
+    {
+        HostOper result;
+        result.oper_.xltype = xltypeNum;
+        result.oper_.val.num = value;
+        return result;
+    }
+
+    HostOper HostOper::String(const std::wstring& value)
+    {
+        HostOper result;
+        result.oper_.val.str = NewString(value);
+        result.oper_.xltype = xltypeStr;
+        return result;
+    }
+
+    HostOper HostOper::Boolean(bool value)
+    {
+        HostOper result;
+        result.oper_.xltype = xltypeBool;
+        result.oper_.val.xbool = value;
+        return result;
+    }
+
+    HostOper HostOper::Integer(int value)
+    {
+        HostOper result;
+        result.oper_.xltype = xltypeInt;
+        result.oper_.val.w = value;
+        return result;
+    }
+
+    HostOper HostOper::Error(int errorCode)
+    {
+        HostOper result;
+        result.oper_.xltype = xltypeErr;
+        result.oper_.val.err = errorCode;
+        return result;
+    }
+
+    HostOper HostOper::Missing()
+    {
+        HostOper result;
+        result.oper_.xltype = xltypeMissing;
+        return result;
+    }
+
+    HostOper HostOper::Array(RW rows, COL columns)
+    {
+        HostOper result;
+        size_t size = static_cast<size_t>(rows) * static_cast<size_t>(columns);
+        result.oper_.val.array.lparray = new XLOPER12[size];
+        for (size_t i = 0; i < size; ++i)
+        {
+            setNil(result.oper_.val.array.lparray[i]);
+        }
+        result.oper_.val.array.rows = rows;
+        result.oper_.val.array.columns = columns;
+        result.oper_.xltype = xltypeMulti;
+        return result;
+    }
+
+    HostOper HostOper::Reference(IDSHEET sheet, const XLREF12& area)
+    {
+        HostOper result;
+        result.oper_.val.mref.lpmref = newReferenceTable(1);
+        result.oper_.val.mref.lpmref->reftbl[0] = area;
+        result.oper_.val.mref.idSheet = sheet;
+        result.oper_.xltype = xltypeRef;
+        return result;
+    }
+
+}}
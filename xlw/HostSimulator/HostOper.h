@@ -0,0 +1,94 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef HOST_OPER_HEADER_GUARD
+#define HOST_OPER_HEADER_GUARD
+
+/*!
+\file HostOper.h
+\brief XLOPER12 values owned by the host simulator
+*/
+
+#include <xlw/xlcall32.h>
+#include <string>
+
+namespace xlw { namespace HostSimulator {
+
+    //! Type of an XLOPER12 with the memory management bits removed.
+    DWORD BaseType(const XLOPER12& oper);
+
+    //! UTF-8 to the wide characters used by XLOPER12 strings.
+    std::wstring Widen(const std::string& text);
+    std::string Narrow(const std::wstring& text);
+
+    //! Allocates a counted string the way the host hands strings to add-ins.
+    XCHAR* NewString(const std::wstring& value);
+
+    //! Reads a counted string.
+    std::wstring ToWString(const XCHAR* countedString);
+
+    //! Deep copies \c from into \c to using host memory.
+    /*! Anything \c to owned is not released first. Flags set by the add-in are
+        dropped so that the copy can always be released with FreeOper.
+    */
+    void CopyOper(const XLOPER12& from, XLOPER12& to);
+
+    //! Releases host memory held by the oper and leaves it as xltypeNil.
+    void FreeOper(XLOPER12& oper);
+
+    //! Converts a value (never a reference) to one of the types in \c toTypes.
+    /*! Follows Excel's rules closely enough for the conversions xlw asks for.
+        Returns xlretSuccess or xlretFailed, \c to is only written on success.
+    */
+    int CoerceValue(const XLOPER12& from, DWORD toTypes, XLOPER12& to);
+
+    //! An XLOPER12 whose memory belongs to the host.
+    class HostOper
+    {
+    public:
+        HostOper();
+        explicit HostOper(const XLOPER12& value);
+        HostOper(const HostOper& other);
+        HostOper(HostOper&& other);
+        HostOper& operator=(HostOper other);
+        ~HostOper();
+
+        static HostOper Number(double value);
+        static HostOper String(const std::wstring& value);
+        static HostOper Boolean(bool value);
+        static HostOper Integer(int value);
+        static HostOper Error(int errorCode);
+        static HostOper Missing();
+        //! An array of xltypeNil elements.
+        static HostOper Array(RW rows, COL columns);
+        //! A reference to a single area.
+        static HostOper Reference(IDSHEET sheet, const XLREF12& area);
+
+        const XLOPER12& Get() const { return oper_; }
+        XLOPER12& Get() { return oper_; }
+        DWORD Type() const { return BaseType(oper_); }
+
+        //! Hands the value, and the memory behind it, to the caller.
+        XLOPER12 Release();
+
+        void swap(HostOper& other);
+
+    private:
+        XLOPER12 oper_;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,415 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include "RecalcDriver.h"
+#include "Workbook.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace xlw { namespace HostSimulator {
+
+    namespace
+    {
+        class Barrier
+        {
+        public:
+            explicit Barrier(unsigned threads) : threads_(threads), waiting_(0), generation_(0) {}
+
+            void Wait()
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                unsigned long long generation = generation_;
+                if (++waiting_ == threads_)
+                {
+                    waiting_ = 0;
+                    ++generation_;
+                    condition_.notify_all();
+                }
+                else
+                {
+                    condition_.wait(lock, [&] { return generation != generation_; });
+                }
+            }
+
+        private:
+            std::mutex mutex_;
+            std::condition_variable condition_;
+            unsigned threads_;
+            unsigned waiting_;
+            unsigned long long generation_;
+        };
+
+        typedef std::map<std::pair<IDSHEET, std::pair<RW, COL> >, size_t> CellIndex;
+
+        void addDependencies(const XLREF12& area, IDSHEET sheet, const CellIndex& cells, std::vector<size_t>& result)
+        {
+            size_t areaSize = static_cast<size_t>(area.rwLast - area.rwFirst + 1) * static_cast<size_t>(area.colLast - area.colFirst + 1);
+            if (areaSize <= cells.size())
+            {
+                for (RW row = area.rwFirst; row <= area.rwLast; ++row)
+                {
+                    for (COL col = area.colFirst; col <= area.colLast; ++col)
+                    {
+                        CellIndex::const_iterator it = cells.find(std::make_pair(sheet, std::make_pair(row, col)));
+                        if (it != cells.end())
+                            result.push_back(it->second);
+                    }
+                }
+            }
+            else
+            {
+                for (CellIndex::const_iterator it = cells.begin(); it != cells.end(); ++it)
+                {
+                    RW row = it->first.second.first;
+                    COL col = it->first.second.second;
+                    if (it->first.first == sheet && row >= area.rwFirst && row <= area.rwLast &&
+                        col >= area.colFirst && col <= area.colLast)
+                        result.push_back(it->second);
+                }
+            }
+        }
+
+        // Presses escape a set time into each pass of a recalculation,
+        // unless the pass finishes first.
+        class Canceller
+        {
+        public:
+            Canceller(Host& host, double seconds)
+                : host_(host), seconds_(seconds), armed_(false), stopping_(false), pass_(0)
+            {
+                if (seconds_ > 0.0)
+                    thread_ = std::thread([this]() { run(); });
+            }
+
+            ~Canceller()
+            {
+                if (!thread_.joinable())
+                    return;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stopping_ = true;
+                }
+                changed_.notify_one();
+                thread_.join();
+            }
+
+            bool IsActive() const { return thread_.joinable(); }
+
+            void Arm()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    armed_ = true;
+                    ++pass_;
+                }
+                changed_.notify_one();
+            }
+
+            void Disarm()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    armed_ = false;
+                }
+                changed_.notify_one();
+            }
+
+        private:
+            void run()
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                while (true)
+                {
+                    changed_.wait(lock, [this]() { return stopping_ || armed_; });
+                    if (stopping_)
+                        return;
+                    unsigned long long pass = pass_;
+                    // cancelled under the lock, so a pass that has just
+                    // finished can't have the next one cancelled instead
+                    if (!changed_.wait_for(lock, std::chrono::duration<double>(seconds_),
+                        [this, pass]() { return stopping_ || !armed_ || pass_ != pass; }))
+                    {
+                        host_.CancelCalculation();
+                        armed_ = false;
+                    }
+                }
+            }
+
+            Host& host_;
+            double seconds_;
+            std::mutex mutex_;
+            std::condition_variable changed_;
+            bool armed_;
+            bool stopping_;
+            unsigned long long pass_;
+            std::thread thread_;
+        };
+
+        // numbers are equal to within rounding, integers and doubles alike
+        bool sameValue(const XLOPER12& value, const XLOPER12& expected)
+        {
+            DWORD type = BaseType(value);
+            DWORD expectedType = BaseType(expected);
+            if ((type == xltypeNum || type == xltypeInt) && (expectedType == xltypeNum || expectedType == xltypeInt))
+            {
+                double number = type == xltypeNum ? value.val.num : value.val.w;
+                double expectedNumber = expectedType == xltypeNum ? expected.val.num : expected.val.w;
+                return std::fabs(number - expectedNumber) <= 1e-12 * std::max(1.0, std::fabs(expectedNumber));
+            }
+            if (type != expectedType)
+                return false;
+            switch (type)
+            {
+            case xltypeStr:
+                return ToWString(value.val.str) == ToWString(expected.val.str);
+            case xltypeBool:
+                return (value.val.xbool != 0) == (expected.val.xbool != 0);
+            case xltypeErr:
+                return value.val.err == expected.val.err;
+            default:
+                return true;
+            }
+        }
+    }
+
+    RecalcDriver::RecalcDriver(Host& host) : host_(host), cancelAfter_(0.0)
+    {
+    }
+
+    void RecalcDriver::AddFormula(const Formula& formula)
+    {
+        formulas_.push_back(formula);
+    }
+
+    void RecalcDriver::AddCheck(const Check& check)
+    {
+        checks_.push_back(check);
+    }
+
+    void RecalcDriver::CancelAfter(double seconds)
+    {
+        cancelAfter_ = seconds;
+    }
+
+    std::vector<RecalcDriver::Level> RecalcDriver::order(const std::vector<Registration>& functions) const
+    {
+        CellIndex cells;
+        for (size_t i = 0; i < formulas_.size(); ++i)
+        {
+            cells[std::make_pair(formulas_[i].sheet, std::make_pair(formulas_[i].row, formulas_[i].col))] = i;
+        }
+
+        std::vector<std::vector<size_t> > precedents(formulas_.size());
+        for (size_t i = 0; i < formulas_.size(); ++i)
+        {
+            const Formula& formula = formulas_[i];
+            for (size_t j = 0; j < formula.arguments.size(); ++j)
+            {
+                const XLOPER12& argument = formula.arguments[j].Get();
+                if (BaseType(argument) == xltypeSRef)
+                {
+                    addDependencies(argument.val.sref.ref, formula.sheet, cells, precedents[i]);
+                }
+                else if (BaseType(argument) == xltypeRef && argument.val.mref.lpmref)
+                {
+                    IDSHEET sheet = argument.val.mref.idSheet ? argument.val.mref.idSheet : formula.sheet;
+                    for (WORD k = 0; k < argument.val.mref.lpmref->count; ++k)
+                        addDependencies(argument.val.mref.lpmref->reftbl[k], sheet, cells, precedents[i]);
+                }
+            }
+        }
+
+        // longest path from a formula with no precedents, iteratively so
+        // that long chains don't exhaust the stack
+        const size_t unvisited = static_cast<size_t>(-1);
+        const size_t inProgress = static_cast<size_t>(-2);
+        std::vector<size_t> depth(formulas_.size(), unvisited);
+        for (size_t start = 0; start < formulas_.size(); ++start)
+        {
+            if (depth[start] != unvisited)
+                continue;
+            std::vector<std::pair<size_t, size_t> > stack(1, std::make_pair(start, size_t(0)));
+            depth[start] = inProgress;
+            while (!stack.empty())
+            {
+                size_t current = stack.back().first;
+                size_t& next = stack.back().second;
+                if (next < precedents[current].size())
+                {
+                    size_t precedent = precedents[current][next++];
+                    if (depth[precedent] == inProgress)
+                        throw std::runtime_error("circular reference through " + formulas_[precedent].function);
+                    if (depth[precedent] == unvisited)
+                    {
+                        depth[precedent] = inProgress;
+                        stack.push_back(std::make_pair(precedent, size_t(0)));
+                    }
+                }
+                else
+                {
+                    size_t level = 0;
+                    for (size_t k = 0; k < precedents[current].size(); ++k)
+                        level = std::max(level, depth[precedents[current][k]] + 1);
+                    depth[current] = level;
+                    stack.pop_back();
+                }
+            }
+        }
+
+        std::vector<Level> levels;
+        for (size_t i = 0; i < formulas_.size(); ++i)
+        {
+            if (depth[i] >= levels.size())
+                levels.resize(depth[i] + 1);
+            if (functions[i].IsThreadSafe())
+                levels[depth[i]].threadSafe.push_back(i);
+            else
+                levels[depth[i]].mainThread.push_back(i);
+        }
+        return levels;
+    }
+
+    RecalcStatistics RecalcDriver::Run(unsigned threads, unsigned passes)
+    {
+        threads = std::max(threads, 1u);
+
+        std::vector<Registration> functions(formulas_.size());
+        for (size_t i = 0; i < formulas_.size(); ++i)
+        {
+            if (!host_.FindRegistration(formulas_[i].function, functions[i]))
+                throw std::runtime_error(formulas_[i].function + " is not registered");
+        }
+        const std::vector<Level> levels(order(functions));
+
+        std::atomic<unsigned long long> calls(0);
+        std::atomic<unsigned long long> errors(0);
+        // work counters alternate between steps, see below
+        std::atomic<size_t> counters[2];
+        counters[0] = 0;
+        counters[1] = 0;
+        Barrier barrier(threads);
+        Grid& grid(host_.GetGrid());
+
+        auto evaluate = [&](size_t index, unsigned long long& failures)
+        {
+            const Formula& formula = formulas_[index];
+            Host::SetCaller(formula.sheet, formula.row, formula.col);
+            try
+            {
+                HostOper result(host_.Call(functions[index], formula.arguments));
+                if (result.Type() == xltypeErr)
+                    ++failures;
+                grid.SetValue(formula.sheet, formula.row, formula.col, result.Get());
+            }
+            catch (std::exception&)
+            {
+                ++failures;
+                grid.SetValue(formula.sheet, formula.row, formula.col, HostOper::Error(xlerrValue).Get());
+            }
+            Host::ClearCaller();
+        };
+
+        Canceller canceller(host_, cancelAfter_);
+
+        auto worker = [&](unsigned thread)
+        {
+            unsigned long long done = 0;
+            unsigned long long failures = 0;
+            size_t step = 0;
+            for (unsigned pass = 0; pass < passes; ++pass)
+            {
+                // every thread has finished the last pass before the timer starts again
+                if (canceller.IsActive())
+                {
+                    if (thread == 0)
+                        canceller.Arm();
+                    barrier.Wait();
+                }
+                for (size_t level = 0; level < levels.size(); ++level, ++step)
+                {
+                    std::atomic<size_t>& counter = counters[step % 2];
+                    if (thread == 0)
+                    {
+                        // nobody can reach the next step until we pass the
+                        // barrier at the end of this one
+                        counters[(step + 1) % 2] = 0;
+                        for (size_t i = 0; i < levels[level].mainThread.size(); ++i, ++done)
+                            evaluate(levels[level].mainThread[i], failures);
+                    }
+                    const std::vector<size_t>& shared = levels[level].threadSafe;
+                    for (size_t i = counter.fetch_add(1); i < shared.size(); i = counter.fetch_add(1), ++done)
+                        evaluate(shared[i], failures);
+                    barrier.Wait();
+                }
+                if (thread == 0 && canceller.IsActive())
+                    canceller.Disarm();
+            }
+            calls += done;
+            errors += failures;
+        };
+
+        std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+        std::vector<std::thread> pool;
+        for (unsigned i = 1; i < threads; ++i)
+            pool.push_back(std::thread(worker, i));
+        worker(0);
+        for (size_t i = 0; i < pool.size(); ++i)
+            pool[i].join();
+        std::chrono::duration<double> elapsed(std::chrono::steady_clock::now() - start);
+
+        RecalcStatistics statistics;
+        statistics.calls = calls;
+        statistics.errors = errors;
+        statistics.seconds = elapsed.count();
+        statistics.threads = threads;
+        statistics.passes = passes;
+        statistics.levels = levels.size();
+        return statistics;
+    }
+
+    std::vector<std::string> RecalcDriver::FailedChecks() const
+    {
+        std::vector<std::string> failures;
+        const Grid& grid(host_.GetGrid());
+        for (size_t i = 0; i < checks_.size(); ++i)
+        {
+            const Check& check = checks_[i];
+            const XLOPER12& expected = check.expected.Get();
+            bool isArray = BaseType(expected) == xltypeMulti;
+            RW rows = isArray ? expected.val.array.rows : 1;
+            COL columns = isArray ? expected.val.array.columns : 1;
+            for (RW row = 0; row < rows; ++row)
+            {
+                for (COL col = 0; col < columns; ++col)
+                {
+                    const XLOPER12& expectedCell = isArray ? expected.val.array.lparray[row * columns + col] : expected;
+                    HostOper value(grid.GetValue(check.sheet, check.row + row, check.col + col));
+                    if (!sameValue(value.Get(), expectedCell))
+                        failures.push_back(grid.GetSheetName(check.sheet) + "!" + CellName(check.row + row, check.col + col) +
+                            " is " + DisplayText(value.Get()) + ", expected " + DisplayText(expectedCell));
+                }
+            }
+        }
+        return failures;
+    }
+
+}}
@@ -0,0 +1,111 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef RECALC_DRIVER_HEADER_GUARD
+#define RECALC_DRIVER_HEADER_GUARD
+
+/*!
+\file RecalcDriver.h
+\brief Multithreaded recalculation of add-in formulas
+*/
+
+#include "Host.h"
+#include <string>
+#include <vector>
+
+namespace xlw { namespace HostSimulator {
+
+    //! A call to a registered function whose result lands in a cell.
+    struct Formula
+    {
+        IDSHEET sheet;
+        RW row;
+        COL col;
+        std::string function;
+        //! Values or references (xltypeRef / xltypeSRef) to other cells.
+        std::vector<HostOper> arguments;
+    };
+
+    //! A value a cell should hold once the formulas have been recalculated.
+    struct Check
+    {
+        IDSHEET sheet;
+        RW row;
+        COL col;
+        //! An array is compared with the cells it would spill over.
+        HostOper expected;
+    };
+
+    struct RecalcStatistics
+    {
+        unsigned long long calls;
+        //! Calls that returned an Excel error or threw inside the host.
+        unsigned long long errors;
+        double seconds;
+        unsigned threads;
+        unsigned passes;
+        //! Number of dependency levels, each level is a barrier.
+        size_t levels;
+    };
+
+    //! Recalculates formulas the way Excel's multithreaded calculation does.
+    /*! Formulas are ordered into levels so that a formula only runs once the
+        formulas whose cells it refers to have finished. Within a level thread
+        safe functions are shared between all threads, the others run on the
+        first thread only, as Excel keeps them on its main thread.
+    */
+    class RecalcDriver
+    {
+    public:
+        explicit RecalcDriver(Host& host);
+
+        void AddFormula(const Formula& formula);
+        const std::vector<Formula>& GetFormulas() const { return formulas_; }
+        void AddCheck(const Check& check);
+        const std::vector<Check>& GetChecks() const { return checks_; }
+        //! Cancels the calculation this long into each pass of Run, as
+        //! pressing escape would. Calls still waiting for asynchronous
+        //! results get \#N/A.
+        void CancelAfter(double seconds);
+
+        //! Recalculates every formula \c passes times with \c threads threads.
+        /*! Throws if a formula names a function that isn't registered or if
+            the formulas refer to each other in a cycle.
+        */
+        RecalcStatistics Run(unsigned threads, unsigned passes);
+
+        //! The checks the grid doesn't pass, each naming the cell, what it
+        //! holds and what was expected.
+        std::vector<std::string> FailedChecks() const;
+
+    private:
+        struct Level
+        {
+            std::vector<size_t> threadSafe;
+            std::vector<size_t> mainThread;
+        };
+
+        std::vector<Level> order(const std::vector<Registration>& functions) const;
+
+        Host& host_;
+        std::vector<Formula> formulas_;
+        std::vector<Check> checks_;
+        //! 0 when the calculation isn't cancelled.
+        double cancelAfter_;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,555 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include "Workbook.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+namespace xlw { namespace HostSimulator {
+
+    namespace
+    {
+        struct ErrorName
+        {
+            const char* name;
+            int code;
+        };
+
+        const ErrorName errorNames[] =
+        {
+            { "#NULL!", xlerrNull },
+            { "#DIV/0!", xlerrDiv0 },
+            { "#VALUE!", xlerrValue },
+            { "#REF!", xlerrRef },
+            { "#NAME?", xlerrName },
+            { "#NUM!", xlerrNum },
+            { "#N/A", xlerrNA }
+        };
+
+        std::string upper(std::string text)
+        {
+            for (size_t i = 0; i < text.size(); ++i)
+                text[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(text[i])));
+            return text;
+        }
+
+        class Parser
+        {
+        public:
+            Parser(const std::string& text, Grid& grid, IDSHEET sheet)
+                : text_(text), position_(0), grid_(grid), sheet_(sheet) {}
+
+            //! A cell address at the start of the line followed by =.
+            void ParseTarget(RW& row, COL& col)
+            {
+                skipSpace();
+                if (!parseCell(row, col))
+                    fail("expected a cell address");
+                expect('=');
+            }
+
+            //! Either a constant or a call, returns false for a constant.
+            bool ParseContent(HostOper& value, std::string& function, std::vector<HostOper>& arguments)
+            {
+                skipSpace();
+                size_t start = position_;
+                std::string name(parseName());
+                skipSpace();
+                if (!name.empty() && peek() == '(')
+                {
+                    ++position_;
+                    function = name;
+                    parseArguments(arguments);
+                    expect(')');
+                    expectEnd();
+                    return true;
+                }
+                position_ = start;
+                value = parseArgument();
+                if (value.Type() == xltypeRef)
+                    fail("a cell can only refer to other cells through a function");
+                expectEnd();
+                return false;
+            }
+
+        private:
+            void fail(const std::string& message) const
+            {
+                std::ostringstream error;
+                error << message << " at column " << position_ + 1;
+                throw std::runtime_error(error.str());
+            }
+
+            char peek() const
+            {
+                return position_ < text_.size() ? text_[position_] : '\0';
+            }
+
+            void skipSpace()
+            {
+                while (position_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[position_])))
+                    ++position_;
+            }
+
+            void expect(char c)
+            {
+                skipSpace();
+                if (peek() != c)
+                    fail(std::string("expected '") + c + "'");
+                ++position_;
+            }
+
+            void expectEnd()
+            {
+                skipSpace();
+                if (position_ != text_.size())
+                    fail("unexpected text");
+            }
+
+            std::string parseName()
+            {
+                size_t start = position_;
+                if (std::isalpha(static_cast<unsigned char>(peek())) || peek() == '_')
+                {
+                    while (std::isalnum(static_cast<unsigned char>(peek())) || peek() == '_' || peek() == '.')
+                        ++position_;
+                }
+                return text_.substr(start, position_ - start);
+            }
+
+            bool parseCell(RW& row, COL& col)
+            {
+                size_t start = position_;
+                if (peek() == '$')
+                    ++position_;
+                long column = 0;
+                size_t letters = 0;
+                while (std::isalpha(static_cast<unsigned char>(peek())) && letters < 3)
+                {
+                    column = column * 26 + (std::toupper(static_cast<unsigned char>(peek())) - 'A' + 1);
+                    ++position_;
+                    ++letters;
+                }
+                if (peek() == '$')
+                    ++position_;
+                long number = 0;
+                size_t digits = 0;
+                while (std::isdigit(static_cast<unsigned char>(peek())) && digits < 8)
+                {
+                    number = number * 10 + (peek() - '0');
+                    ++position_;
+                    ++digits;
+                }
+                if (!letters || !digits || number < 1 || number > Grid::Rows || column > Grid::Columns ||
+                    std::isalnum(static_cast<unsigned char>(peek())))
+                {
+                    position_ = start;
+                    return false;
+                }
+                row = static_cast<RW>(number - 1);
+                col = static_cast<COL>(column - 1);
+                return true;
+            }
+
+            //! Single area, optionally with a sheet name in front.
+            bool parseArea(IDSHEET& sheet, XLREF12& area)
+            {
+                size_t start = position_;
+                sheet = 0;
+                std::string sheetName;
+                if (peek() == '\'')
+                {
+                    size_t close = text_.find('\'', position_ + 1);
+                    if (close == std::string::npos)
+                        fail("unterminated sheet name");
+                    sheetName = text_.substr(position_ + 1, close - position_ - 1);
+                    position_ = close + 1;
+                }
+                else
+                {
+                    sheetName = parseName();
+                }
+                if (peek() == '!' && !sheetName.empty())
+                {
+                    ++position_;
+                    sheet = grid_.AddSheet(sheetName);
+                }
+                else
+                {
+                    position_ = start;
+                }
+
+                if (!parseCell(area.rwFirst, area.colFirst))
+                {
+                    position_ = start;
+                    return false;
+                }
+                area.rwLast = area.rwFirst;
+                area.colLast = area.colFirst;
+                if (peek() == ':')
+                {
+                    ++position_;
+                    RW row;
+                    COL col;
+                    if (!parseCell(row, col))
+                        fail("expected the end of the range");
+                    area.rwFirst = std::min(area.rwFirst, row);
+                    area.rwLast = std::max(area.rwLast, row);
+                    area.colFirst = std::min(area.colFirst, col);
+                    area.colLast = std::max(area.colLast, col);
+                }
+                return true;
+            }
+
+            HostOper parseReference()
+            {
+                IDSHEET sheet;
+                XLREF12 area;
+                if (!parseArea(sheet, area))
+                    fail("expected a value or a reference");
+                return HostOper::Reference(sheet ? sheet : sheet_, area);
+            }
+
+            //! (A1:A3,C1:C3), all areas must be on one sheet.
+            HostOper parseUnion()
+            {
+                ++position_;
+                std::vector<XLREF12> areas;
+                IDSHEET unionSheet = 0;
+                do
+                {
+                    skipSpace();
+                    IDSHEET sheet;
+                    XLREF12 area;
+                    if (!parseArea(sheet, area))
+                        fail("expected a reference");
+                    sheet = sheet ? sheet : sheet_;
+                    if (unionSheet && sheet != unionSheet)
+                        fail("areas of a reference must be on one sheet");
+                    unionSheet = sheet;
+                    areas.push_back(area);
+                    skipSpace();
+                    if (peek() != ',')
+                        break;
+                    ++position_;
+                } while (true);
+                expect(')');
+
+                HostOper result(HostOper::Reference(unionSheet, areas[0]));
+                if (areas.size() > 1)
+                {
+                    // build the multi area table through an oper we own
+                    XLOPER12 reference;
+                    reference.xltype = xltypeRef;
+                    reference.val.mref.idSheet = unionSheet;
+                    std::vector<char> table(sizeof(XLMREF12) + (areas.size() - 1) * sizeof(XLREF12));
+                    reference.val.mref.lpmref = reinterpret_cast<XLMREF12*>(&table[0]);
+                    reference.val.mref.lpmref->count = static_cast<WORD>(areas.size());
+                    for (size_t i = 0; i < areas.size(); ++i)
+                        reference.val.mref.lpmref->reftbl[i] = areas[i];
+                    result = HostOper(reference);
+                }
+                return result;
+            }
+
+            HostOper parseString()
+            {
+                ++position_;
+                std::string value;
+                while (true)
+                {
+                    if (position_ >= text_.size())
+                        fail("unterminated string");
+                    char c = text_[position_++];
+                    if (c == '"')
+                    {
+                        // "" is a quote, as in Excel
+                        if (peek() != '"')
+                            break;
+                        ++position_;
+                    }
+                    value += c;
+                }
+                return HostOper::String(Widen(value));
+            }
+
+            HostOper parseError()
+            {
+                for (size_t i = 0; i < sizeof(errorNames) / sizeof(errorNames[0]); ++i)
+                {
+                    std::string name(errorNames[i].name);
+                    if (upper(text_.substr(position_, name.size())) == name)
+                    {
+                        position_ += name.size();
+                        return HostOper::Error(errorNames[i].code);
+                    }
+                }
+                fail("unknown error value");
+                return HostOper();
+            }
+
+            //! A scalar constant, or returns false.
+            bool parseScalar(HostOper& value)
+            {
+                skipSpace();
+                char c = peek();
+                if (c == '"')
+                {
+                    value = parseString();
+                    return true;
+                }
+                if (c == '#')
+                {
+                    value = parseError();
+                    return true;
+                }
+                if (std::isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '+' || c == '.')
+                {
+                    const char* begin = text_.c_str() + position_;
+                    char* end = 0;
+                    double number = std::strtod(begin, &end);
+                    if (end == begin)
+                        fail("expected a number");
+                    position_ += end - begin;
+                    value = HostOper::Number(number);
+                    return true;
+                }
+                size_t start = position_;
+                std::string name(upper(parseName()));
+                skipSpace();
+                if ((name == "TRUE" || name == "FALSE") && peek() != '!' && peek() != '(')
+                {
+                    value = HostOper::Boolean(name == "TRUE");
+                    return true;
+                }
+                position_ = start;
+                return false;
+            }
+
+            //! {1,2;3,4}
+            HostOper parseArray()
+            {
+                ++position_;
+                std::vector<std::vector<HostOper> > rows(1);
+                while (true)
+                {
+                    HostOper value;
+                    if (!parseScalar(value))
+                        fail("expected a constant");
+                    rows.back().push_back(value);
+                    skipSpace();
+                    char c = peek();
+                    ++position_;
+                    if (c == ',')
+                        continue;
+                    if (c == ';')
+                    {
+                        rows.push_back(std::vector<HostOper>());
+                        continue;
+                    }
+                    if (c == '}')
+                        break;
+                    --position_;
+                    fail("expected ',', ';' or '}'");
+                }
+                size_t columns = rows[0].size();
+                HostOper result(HostOper::Array(static_cast<RW>(rows.size()), static_cast<COL>(columns)));
+                for (size_t i = 0; i < rows.size(); ++i)
+                {
+                    if (rows[i].size() != columns)
+                        fail("rows of an array must have the same length");
+                    for (size_t j = 0; j < columns; ++j)
+                        CopyOper(rows[i][j].Get(), result.Get().val.array.lparray[i * columns + j]);
+                }
+                return result;
+            }
+
+            HostOper parseArgument()
+            {
+                skipSpace();
+                if (peek() == '{')
+                    return parseArray();
+                if (peek() == '(')
+                    return parseUnion();
+                HostOper value;
+                if (parseScalar(value))
+                    return value;
+                return parseReference();
+            }
+
+            void parseArguments(std::vector<HostOper>& arguments)
+            {
+                skipSpace();
+                if (peek() == ')')
+                    return;
+                while (true)
+                {
+                    skipSpace();
+                    if (peek() == ',' || peek() == ')')
+                        arguments.push_back(HostOper::Missing());
+                    else
+                        arguments.push_back(parseArgument());
+                    skipSpace();
+                    if (peek() != ',')
+                        break;
+                    ++position_;
+                }
+            }
+
+            const std::string& text_;
+            size_t position_;
+            Grid& grid_;
+            IDSHEET sheet_;
+        };
+
+        std::string trim(const std::string& text)
+        {
+            size_t first = text.find_first_not_of(" \t\r\n");
+            if (first == std::string::npos)
+                return std::string();
+            size_t last = text.find_last_not_of(" \t\r\n");
+            return text.substr(first, last - first + 1);
+        }
+    }
+
+    void ReadWorkbook(std::istream& input, Grid& grid, RecalcDriver& driver)
+    {
+        IDSHEET sheet = grid.GetActiveSheet();
+        std::string line;
+        size_t lineNumber = 0;
+        while (std::getline(input, line))
+        {
+            ++lineNumber;
+            std::string content(trim(line));
+            if (content.empty() || content.compare(0, 2, "//") == 0)
+                continue;
+            try
+            {
+                if (content[0] == '[')
+                {
+                    if (content[content.size() - 1] != ']' || content.size() < 3)
+                        throw std::runtime_error("bad sheet name");
+                    sheet = grid.AddSheet(content.substr(1, content.size() - 2));
+                    continue;
+                }
+
+                if (content.compare(0, 6, "check ") == 0)
+                {
+                    std::string check(content.substr(6));
+                    Parser parser(check, grid, sheet);
+                    Check expected;
+                    expected.sheet = sheet;
+                    parser.ParseTarget(expected.row, expected.col);
+                    std::string function;
+                    std::vector<HostOper> arguments;
+                    if (parser.ParseContent(expected.expected, function, arguments))
+                        throw std::runtime_error("a check compares a cell with a constant");
+                    driver.AddCheck(expected);
+                    continue;
+                }
+                if (content.compare(0, 13, "cancel after ") == 0)
+                {
+                    std::string seconds(trim(content.substr(13)));
+                    char* end = 0;
+                    double value = std::strtod(seconds.c_str(), &end);
+                    if (seconds.empty() || *end || value <= 0.0)
+                        throw std::runtime_error("expected a number of seconds to cancel after");
+                    driver.CancelAfter(value);
+                    continue;
+                }
+
+                Parser parser(content, grid, sheet);
+                Formula formula;
+                formula.sheet = sheet;
+                parser.ParseTarget(formula.row, formula.col);
+                HostOper value;
+                if (parser.ParseContent(value, formula.function, formula.arguments))
+                    driver.AddFormula(formula);
+                else
+                    grid.SetValue(sheet, formula.row, formula.col, value.Get());
+            }
+            catch (std::exception& error)
+            {
+                std::ostringstream message;
+                message << "line " << lineNumber << ": " << error.what();
+                throw std::runtime_error(message.str());
+            }
+        }
+    }
+
+    std::string CellName(RW row, COL col)
+    {
+        std::string letters;
+        for (long column = col + 1; column > 0; column = (column - 1) / 26)
+            letters.insert(letters.begin(), static_cast<char>('A' + (column - 1) % 26));
+        std::ostringstream name;
+        name << letters << row + 1;
+        return name.str();
+    }
+
+    std::string DisplayText(const XLOPER12& value)
+    {
+        std::ostringstream text;
+        switch (BaseType(value))
+        {
+        case xltypeNum:
+            text.precision(15);
+            text << value.val.num;
+            break;
+        case xltypeInt:
+            text << value.val.w;
+            break;
+        case xltypeStr:
+            text << '"' << Narrow(ToWString(value.val.str)) << '"';
+            break;
+        case xltypeBool:
+            text << (value.val.xbool ? "TRUE" : "FALSE");
+            break;
+        case xltypeErr:
+            {
+                const char* name = "#ERROR";
+                for (size_t i = 0; i < sizeof(errorNames) / sizeof(errorNames[0]); ++i)
+                {
+                    if (errorNames[i].code == value.val.err)
+                        name = errorNames[i].name;
+                }
+                text << name;
+            }
+            break;
+        case xltypeMulti:
+            text << '{';
+            for (RW i = 0; i < value.val.array.rows; ++i)
+            {
+                for (COL j = 0; j < value.val.array.columns; ++j)
+                {
+                    if (j)
+                        text << ',';
+                    text << DisplayText(value.val.array.lparray[i * value.val.array.columns + j]);
+                }
+                if (i + 1 < value.val.array.rows)
+                    text << ';';
+            }
+            text << '}';
+            break;
+        default:
+            break;
+        }
+        return text.str();
+    }
+
+}}
@@ -0,0 +1,67 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef HOST_WORKBOOK_HEADER_GUARD
+#define HOST_WORKBOOK_HEADER_GUARD
+
+/*!
+\file Workbook.h
+\brief Text description of a workbook for the host simulator
+
+One cell per line, blank lines and lines starting with // are ignored:
+
+\code
+[Sheet1]
+A1 = 1.5
+A2 = "some text"
+A3 = TRUE
+A4 = #N/A
+A5 = {1,2;3,4}
+B1 = EchoShort(A1)
+B2 = MyFunction(A1:A10, Sheet2!B1, (A1:A3,C1:C3), , "x")
+check B1 = 1.5
+cancel after 2
+\endcode
+
+A line in square brackets selects, and if needed adds, the sheet for the lines
+that follow. Constants go straight into the grid, a function call becomes a
+formula for the recalc driver. Arguments are constants, references (a list in
+brackets for a multi area reference) or nothing for a missing argument.
+Calls can't be nested.
+
+A check line gives the value a cell should hold after the recalculation, an
+array checking the cells a result spills over. cancel after makes the driver
+cancel each pass of the calculation that many seconds in, as pressing escape
+would.
+*/
+
+#include "RecalcDriver.h"
+#include <istream>
+#include <string>
+
+namespace xlw { namespace HostSimulator {
+
+    //! Fills the grid and the driver, throws std::runtime_error on bad input.
+    void ReadWorkbook(std::istream& input, Grid& grid, RecalcDriver& driver);
+
+    //! A1 style name of a cell.
+    std::string CellName(RW row, COL col);
+
+    //! Text shown for a value when printing the grid.
+    std::string DisplayText(const XLOPER12& value);
+
+}}
+
+#endif
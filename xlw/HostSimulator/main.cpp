@@ -0,0 +1,144 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+// xlwhost: loads an XLL into the host simulator and recalculates a workbook
+// with it, so that add-ins can be load tested and profiled outside Excel.
+
+#include "Workbook.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace xlw::HostSimulator;
+
+namespace
+{
+    void usage()
+    {
+        std::cerr << "usage: xlwhost [--threads N] [--passes N] [--print] addin [workbook]\n"
+                     "  without a workbook the functions the add-in registers are listed,\n"
+                     "  with one the exit code is 3 if any of its checks fail\n";
+    }
+
+    void listRegistrations(const std::vector<Registration>& registrations)
+    {
+        for (size_t i = 0; i < registrations.size(); ++i)
+        {
+            const Registration& registration = registrations[i];
+            std::cout << registration.functionText << "\t" << registration.typeText << "\t"
+                      << registration.procedure << "\t" << registration.argumentText << "\n";
+        }
+    }
+
+    void printFormulas(const std::vector<Formula>& formulas, Grid& grid)
+    {
+        for (size_t i = 0; i < formulas.size(); ++i)
+        {
+            const Formula& formula = formulas[i];
+            std::cout << grid.GetSheetName(formula.sheet) << "!" << CellName(formula.row, formula.col)
+                      << " = " << DisplayText(grid.GetValue(formula.sheet, formula.row, formula.col).Get()) << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+    unsigned passes = 1;
+    bool print = false;
+    bool failed = false;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        if ((arg == "--threads" || arg == "--passes") && i + 1 < argc)
+        {
+            unsigned value = static_cast<unsigned>(std::strtoul(argv[++i], 0, 10));
+            (arg == "--threads" ? threads : passes) = value;
+        }
+        else if (arg == "--print")
+        {
+            print = true;
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            usage();
+            return 2;
+        }
+        else
+        {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty() || files.size() > 2)
+    {
+        usage();
+        return 2;
+    }
+
+    try
+    {
+        Host& host(Host::Instance());
+        host.LoadAddin(files[0]);
+
+        if (files.size() == 1)
+        {
+            listRegistrations(host.GetRegistrations());
+        }
+        else
+        {
+            std::ifstream input(files[1].c_str());
+            if (!input)
+                throw std::runtime_error("could not open " + files[1]);
+            RecalcDriver driver(host);
+            ReadWorkbook(input, host.GetGrid(), driver);
+
+            RecalcStatistics statistics(driver.Run(threads, passes));
+            if (print)
+                printFormulas(driver.GetFormulas(), host.GetGrid());
+            std::cout << "threads " << statistics.threads
+                      << " passes " << statistics.passes
+                      << " levels " << statistics.levels
+                      << " calls " << statistics.calls
+                      << " errors " << statistics.errors
+                      << " seconds " << statistics.seconds
+                      << " calls/s " << (statistics.seconds > 0 ? statistics.calls / statistics.seconds : 0.0)
+                      << std::endl;
+
+            if (!driver.GetChecks().empty())
+            {
+                std::vector<std::string> failures(driver.FailedChecks());
+                for (size_t i = 0; i < failures.size(); ++i)
+                    std::cout << "failed: " << failures[i] << "\n";
+                std::cout << "checks " << driver.GetChecks().size() << " failed " << failures.size() << std::endl;
+                failed = !failures.empty();
+            }
+        }
+
+        host.UnloadAddins();
+    }
+    catch (std::exception& error)
+    {
+        std::cerr << "xlwhost: " << error.what() << std::endl;
+        return 1;
+    }
+    return failed ? 3 : 0;
+}
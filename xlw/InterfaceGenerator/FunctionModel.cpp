@@ -19,10 +19,14 @@
 
 FunctionModel::FunctionModel(std::string ReturnType_, std::string Name, std::string Description,
                   bool Volatile_, bool Time_, bool Threadsafe_,
-                  std::string helpID_,bool Asynchronous_,bool MacroSheet_, bool ClusterSafe_)
+                  std::string helpID_,bool Asynchronous_,bool MacroSheet_, bool ClusterSafe_,
+                  bool FpReturn_, unsigned long InPlaceArgument_,
+                  bool NoWizardCheck_, unsigned long CacheMegabytes_)
 : ReturnType(ReturnType_), FunctionName(Name), FunctionDescription(Description), helpID(helpID_),
   Volatile(Volatile_), Time(Time_), Threadsafe(Threadsafe_),
-  Asynchronous(Asynchronous_),MacroSheet(MacroSheet_),ClusterSafe(ClusterSafe_)
+  Asynchronous(Asynchronous_),MacroSheet(MacroSheet_),ClusterSafe(ClusterSafe_),
+  FpReturn(FpReturn_), InPlaceArgument(InPlaceArgument_),
+  NoWizardCheck(NoWizardCheck_), CacheMegabytes(CacheMegabytes_)
 {
 }
 
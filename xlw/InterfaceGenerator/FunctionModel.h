@@ -28,7 +28,9 @@ public:
     FunctionModel(std::string ReturnType_, std::string Name, std::string Description,
                   bool Volatile_=false, bool Time_=false, bool Threadsafe_=false,
                   std::string helpID_="",
-                  bool asynchronous=false,bool macrosheet=false, bool clustersafe=false);
+                  bool asynchronous=false,bool macrosheet=false, bool clustersafe=false,
+                  bool fpReturn=false, unsigned long inPlaceArgument=0,
+                  bool noWizardCheck=false, unsigned long cacheMegabytes=0);
 
     void AddArgument(std::string Type_, std::string Name_, std::string Description_);
 
@@ -102,6 +104,35 @@ public:
         return ClusterSafe;
     }
 
+    //! returns an FP12 (K%) rather than an XlfOper
+    bool GetFpReturn() const
+    {
+        return FpReturn;
+    }
+
+    //! the argument, counting from 1, whose FP12 Excel takes as the result, 0 if none
+    unsigned long GetInPlaceArgument() const
+    {
+        return InPlaceArgument;
+    }
+
+    void SetInPlaceArgument(unsigned long argument)
+    {
+        InPlaceArgument=argument;
+    }
+
+    //! runs even when called by the function wizard, without asking Excel whether it is
+    bool GetNoWizardCheck() const
+    {
+        return NoWizardCheck;
+    }
+
+    //! the budget of its result cache, 0 if results aren't cached
+    unsigned long GetCacheMegabytes() const
+    {
+        return CacheMegabytes;
+    }
+
 private:
     std::string ReturnType;
     std::string FunctionName;
@@ -113,6 +144,10 @@ private:
     bool Asynchronous;
     bool MacroSheet;
     bool ClusterSafe;
+    bool FpReturn;
+    unsigned long InPlaceArgument;
+    bool NoWizardCheck;
+    unsigned long CacheMegabytes;
 
     std::vector<std::string > ArgumentTypes;
     std::vector<std::string > ArgumentNames;
@@ -99,7 +99,8 @@ std::vector<FunctionDescription> FunctionTyper(std::vector<FunctionModel>& input
         }
 
         FunctionDescription thisDescription(name,desc,returnType,key,Arguments,it->GetVolatile(),it->DoTime(),it->GetThreadsafe(),it->GetHelpID(),
-                                            it->GetAsynchronous(), it->GetMacroSheet(), it->GetClusterSafe());
+                                            it->GetAsynchronous(), it->GetMacroSheet(), it->GetClusterSafe(), it->GetFpReturn(),
+                                            it->GetInPlaceArgument(), it->GetNoWizardCheck(), it->GetCacheMegabytes());
         output.push_back(thisDescription);
         ++it;
     }
@@ -15,6 +15,7 @@ FOR A PARTICULAR PURPOSE.  See the license for more details.
 */
 #include "Functionizer.h"
 #include "TypeRegister.h"
+#include <cstdlib>
 #include <iostream>
 
 
@@ -79,6 +80,11 @@ FunctionModel FunctionFind(std::vector<Token>::const_iterator& it, std::vector<T
     bool asynchronous  = false;
     bool macrosheet = false;
     bool clustersafe = false;
+    bool fpReturn = false;
+    bool timeAsked = false;
+    bool noWizardCheck = false;
+    unsigned long cacheMegabytes = 0;
+    std::string inPlace;
     std::string helpID = "";
 
     if (it == end)
@@ -114,6 +120,7 @@ FunctionModel FunctionFind(std::vector<Token>::const_iterator& it, std::vector<T
         if (commentString == "<xlw:time")
         {
             time = true;
+            timeAsked = true;
             ++it;
             found = true;
             if (it == end)
@@ -129,7 +136,11 @@ FunctionModel FunctionFind(std::vector<Token>::const_iterator& it, std::vector<T
         }
         if (commentString == "<xlw:asynchronous")
         {
-            throw("asynchronous not yet implemented");
+            asynchronous = true;
+            ++it;
+            found = true;
+            if (it == end)
+                throw("function half declared at end of file");
         }
         if (commentString == "<xlw:macrosheet")
         {
@@ -147,6 +158,48 @@ FunctionModel FunctionFind(std::vector<Token>::const_iterator& it, std::vector<T
             if (it == end)
                 throw("function half declared at end of file");
         }
+        if (commentString == "<xlw:fparray")
+        {
+            fpReturn = true;
+            ++it;
+            found = true;
+            if (it == end)
+                throw("function half declared at end of file");
+        }
+        if (commentString == "<xlw:nowizardcheck")
+        {
+            noWizardCheck = true;
+            ++it;
+            found = true;
+            if (it == end)
+                throw("function half declared at end of file");
+        }
+        if (commentString == "<xlw:cache" || commentString.find("<xlw:cache=") == 0 )
+        {
+            cacheMegabytes = 16;
+            if (commentString.size() > 10)
+            {
+                std::string megabytes(commentString.substr(11));
+                if (megabytes.empty() || megabytes.size() > 6 ||
+                    megabytes.find_first_not_of("0123456789") != std::string::npos)
+                    throw("<xlw:cache= expects a number of megabytes: "+commentString);
+                cacheMegabytes = std::strtoul(megabytes.c_str(), 0, 10);
+                if (cacheMegabytes == 0)
+                    throw("<xlw:cache= expects a number of megabytes: "+commentString);
+            }
+            ++it;
+            found = true;
+            if (it == end)
+                throw("function half declared at end of file");
+        }
+        if (commentString.find("<xlw:inplace=") == 0 )
+        {
+            inPlace = commentString.substr(13);
+            ++it;
+            found = true;
+            if (it == end)
+                throw("function half declared at end of file");
+        }
         if (commentString.find("<xlw:help=") == 0 )
         {
             helpID = commentString.substr(10);
@@ -164,8 +217,51 @@ FunctionModel FunctionFind(std::vector<Token>::const_iterator& it, std::vector<T
 
     std::string functionName(it->GetValue());
 
+    // numeric matrices and arrays are returned as an FP12 only when asked
+    // to with <xlw:fparray, an LPXLARRAY can't be returned any other way
+    if (returnType == "LPXLARRAY" && !fpReturn)
+        throw("an LPXLARRAY return needs <xlw:fparray: "+functionName);
+    if (fpReturn)
+    {
+        if (returnType != "NEMatrix" && returnType != "LPXLARRAY" && returnType != "MyMatrix" && returnType != "MyArray")
+            throw("<xlw:fparray needs a return type of MyMatrix, MyArray, NEMatrix or LPXLARRAY: "+functionName);
+        if (timeAsked)
+            throw("<xlw:time can't be used with an FP12 return: "+functionName);
+        time = false;
+    }
+    if (!inPlace.empty())
+    {
+        if (returnType != "void")
+            throw("<xlw:inplace needs a void return type: "+functionName);
+        if (timeAsked)
+            throw("<xlw:time can't be used with <xlw:inplace: "+functionName);
+        time = false;
+    }
+    // a cached result is returned without calling the function, so
+    // there would be nothing to time
+    if (cacheMegabytes)
+    {
+        if (returnType == "void")
+            throw("<xlw:cache needs a return value: "+functionName);
+        if (Volatile)
+            throw("<xlw:cache can't be used with <xlw:volatile: "+functionName);
+        if (timeAsked)
+            throw("<xlw:time can't be used with <xlw:cache: "+functionName);
+        time = false;
+    }
+    // the result is returned later through xlAsyncReturn, which takes an XLOPER12
+    if (asynchronous)
+    {
+        if (returnType == "void")
+            throw("<xlw:asynchronous needs a return value: "+functionName);
+        if (returnType == "LPXLARRAY")
+            throw("<xlw:asynchronous can't return an LPXLARRAY: "+functionName);
+        if (cacheMegabytes)
+            throw("<xlw:cache can't be used with <xlw:asynchronous: "+functionName);
+    }
+
     FunctionModel theFunction(returnType,functionName,functionDesc,Volatile,time,threadsafe,
-        helpID,asynchronous,macrosheet,clustersafe);
+        helpID,asynchronous,macrosheet,clustersafe,fpReturn,0,noWizardCheck,cacheMegabytes);
 
     ++it;
     if (it == end)
@@ -221,6 +317,35 @@ FunctionModel FunctionFind(std::vector<Token>::const_iterator& it, std::vector<T
 
     }
     ++it; // get past final right bracket
+
+    // the arguments of an asynchronous function are used after Excel has
+    // freed what it passed, so they must own their values
+    if (asynchronous)
+    {
+        for (unsigned long i=0; i < theFunction.GetNumberArgs(); i++)
+        {
+            std::string argType(theFunction.GetArgumentReturnType(i));
+            if (argType == "FpMatrixView" || argType == "LPXLARRAY" || argType == "XCHAR*" ||
+                argType == "XlfOper" || argType == "LPXLFOPER" || argType == "reftest")
+                throw("<xlw:asynchronous arguments can't be of type "+argType+", which points into memory Excel owns: "+functionName);
+        }
+    }
+
+    // Excel writes the result over the FP12 it passed for this argument
+    if (!inPlace.empty())
+    {
+        unsigned long argument = 0;
+        for (unsigned long i=0; i < theFunction.GetNumberArgs(); i++)
+            if (theFunction.GetArgumentFunctionName(i) == inPlace)
+                argument = i+1;
+        if (argument == 0)
+            throw("<xlw:inplace names no argument of "+functionName+": "+inPlace);
+        if (argument > 9)
+            throw("<xlw:inplace argument must be one of the first nine: "+functionName);
+        if (theFunction.GetArgumentReturnType(argument-1) != "LPXLARRAY")
+            throw("<xlw:inplace argument must be an LPXLARRAY: "+functionName);
+        theFunction.SetInPlaceArgument(argument);
+    }
     return theFunction;
 
 }
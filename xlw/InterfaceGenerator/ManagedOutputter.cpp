@@ -75,6 +75,10 @@ void OutputFileCreatorMan(std::vector<FunctionDescription>& functionDescriptions
   {
 	bool isCommand(functionDescriptions[i].GetReturnType() == "void");
 
+	// a void function is wrapped as a command, which has no array for Excel to pass
+	if (functionDescriptions[i].GetInPlaceArgument())
+		throw("<xlw:inplace can't be used with managed functions: "+functionDescriptions[i].GetFunctionName());
+
 	if (isCommand)
 	{
 		AddLine(outputVector_h, "void //" + functionDescriptions[i].GetFunctionDescription());
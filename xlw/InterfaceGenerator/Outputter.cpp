@@ -45,6 +45,103 @@ void WriteMacrosInitialisation(std::vector<char> &output,
 
 
 
+// Declares each argument as the function takes it, going along its
+// conversion chain from what Excel passed
+void WriteArgumentConversions(std::vector<char> &output, const FunctionDescription &function)
+{
+    for (unsigned long j=0; j < function.NumberOfArguments(); j++)
+    {
+      // we converted to XlfOper now we have to go through our conversion chain
+
+      std::vector<std::string> chain = function.GetArgument(j).GetTheType().GetConversionChain();
+      char id = 'a';
+
+      std::string lastId = function.GetArgument(j).GetArgumentName()+id;
+      ++id;
+
+      for (unsigned long k=0; k < chain.size() -1; k++)
+      {
+        std::vector<std::string>::const_iterator it = chain.begin()+chain.size()-2-k;
+        std::string newId = function.GetArgument(j).GetArgumentName();
+
+        if (k+1 != chain.size() -1)
+          newId+= id;
+
+        TypeRegistry<native>::regData argData = TypeRegistry<native>::Instance().GetRegistration(*it);
+        AddLine(output, argData.NewType+" "+newId+"(");
+
+        bool specIdentifier = argData.TakesIdentifier;
+        std::string identifierBit;
+        bool isMethod = argData.IsAMethod;
+
+        if (specIdentifier && !isMethod)
+          identifierBit = ",\""+newId+"\"";
+        if (specIdentifier && isMethod)
+          identifierBit = "\""+newId+"\"";
+
+
+        if (isMethod)
+          AddLine(output, "\t"+lastId+"."+argData.Converter+"("+identifierBit+"));");
+        else
+          AddLine(output, "\t"+argData.Converter+"("+lastId+identifierBit+"));");
+
+        ++id;
+        lastId=newId;
+      }
+
+      AddLine(output,"");
+
+    }
+    AddLine(output,"profiledCall.Converted();");
+}
+
+// Calls the function, leaving what it returns in result
+void WriteFunctionCall(std::vector<char> &output, const FunctionDescription &function, bool inPlace)
+{
+    if (function.DoTime())
+    {
+      AddLine(output," HiResTimer t;");
+    }
+
+    if (!inPlace)
+      AddLine(output,function.GetReturnType()+" result(");
+    if (function.NumberOfArguments() >0)
+    {
+      AddLine(output,'\t'+function.GetFunctionName()+"(");
+      for (unsigned long j=0; j < function.NumberOfArguments(); j++)
+      {
+        std::string delimiter;
+        if (j +1 < function.NumberOfArguments())
+          delimiter = ",";
+        else
+          delimiter = ")";
+
+        AddLine(output,"\t\t"+function.GetArgument(j).GetArgumentName()+delimiter);
+      }
+      AddLine(output,inPlace ? "\t;" : "\t);");
+    }
+    else
+      AddLine(output,'\t'+function.GetFunctionName()+"());");
+    AddLine(output,"profiledCall.Called();");
+}
+
+// The statement returning value, which ends the call's profile
+std::string ProfiledReturn(const std::string &value)
+{
+    return "return profiledCall.Returned("+value+");";
+}
+
+// Returns the result with the time the call took under it
+void WriteTimedResult(std::vector<char> &output)
+{
+    AddLine(output,"CellMatrix resultCells(result);");
+    AddLine(output,"CellMatrix time(1,2);");
+    AddLine(output,"time(0,0) = \"time taken\";");
+    AddLine(output,"time(0,1) = t.elapsed();");
+    AddLine(output,"resultCells.PushBottom(time);");
+    AddLine(output,ProfiledReturn("XlfOper(resultCells)"));
+}
+
 std::vector<char> OutputFileCreator(const std::vector<FunctionDescription>& functionDescriptions,
                                     std::string inputFileName, std::string LibraryName, 
                                     const std::vector<std::string> &openMethods, 
@@ -59,12 +156,38 @@ std::vector<char> OutputFileCreator(const std::vector<FunctionDescription>& func
   AddLine(output,"");
   AddLine(output,"#include \"xlw/MyContainers.h\"");
   AddLine(output,"#include <xlw/CellMatrix.h>");
-  AddLine(output,"#include \"..\\"+strip(inputFileName)+"\"");
+  AddLine(output,"#include \"../"+strip(inputFileName)+"\"");
   AddLine(output,"#include <xlw/xlw.h>");
   AddLine(output,"#include <xlw/XlFunctionRegistration.h>");
   AddLine(output,"#include <stdexcept>");
   AddLine(output,"#include <xlw/XlOpenClose.h>");
   AddLine(output,"#include <xlw/HiResTimer.h>");
+  AddLine(output,"#include <xlw/XlfProfiler.h>");
+  for (unsigned long i=0; i < functionDescriptions.size(); i++)
+  {
+    if (functionDescriptions[i].GetFpReturn())
+    {
+      AddLine(output,"#include <xlw/xlarray.h>");
+      break;
+    }
+  }
+  for (unsigned long i=0; i < functionDescriptions.size(); i++)
+  {
+    if (functionDescriptions[i].GetCacheMegabytes())
+    {
+      AddLine(output,"#include <xlw/XlfResultCache.h>");
+      break;
+    }
+  }
+  for (unsigned long i=0; i < functionDescriptions.size(); i++)
+  {
+    if (functionDescriptions[i].GetAsynchronous())
+    {
+      AddLine(output,"#include <xlw/XlfAsync.h>");
+      AddLine(output,"#include <utility>");
+      break;
+    }
+  }
 
   const std::set<std::string>& includes = IncludeRegistry<native>::Instance().GetIncludes();
   for (std::set<std::string>::const_iterator it = includes.begin(); it!= includes.end(); ++it)
@@ -88,7 +211,10 @@ std::vector<char> OutputFileCreator(const std::vector<FunctionDescription>& func
 
   for (unsigned long i=0; i < functionDescriptions.size(); i++)
   {
-    bool isCommand(functionDescriptions[i].GetReturnType() == "void");
+    unsigned long inPlace(functionDescriptions[i].GetInPlaceArgument());
+    bool isCommand(functionDescriptions[i].GetReturnType() == "void" && !inPlace);
+    bool fpReturn(functionDescriptions[i].GetFpReturn());
+    unsigned long cacheMegabytes(functionDescriptions[i].GetCacheMegabytes());
     std::string name = functionDescriptions[i].GetFunctionName();
     std::string display_name = functionDescriptions[i].GetDisplayName();
     //std::string keys;
@@ -108,6 +234,7 @@ std::vector<char> OutputFileCreator(const std::vector<FunctionDescription>& func
         AddLine(output,"\""+ functionDescriptions[i].GetFunctionDescription()+" \",");
         AddLine(output, "LibraryName,");
         AddLine(output, "\""+ functionDescriptions[i].GetFunctionDescription()+" \");");
+        AddLine(output,"XlfProfiler profile"+name+"(\""+display_name+"\");");
         AddLine(output,"}");
 
         AddLine(output,"");
@@ -122,7 +249,10 @@ std::vector<char> OutputFileCreator(const std::vector<FunctionDescription>& func
         AddLine(output,"xl"+name+"()");
         AddLine(output,"{");
         AddLine(output,"EXCEL_BEGIN;");
+        AddLine(output,"XlfProfiler::Call profiledCall(profile"+name+");");
         AddLine(output,"\t"+functionDescriptions[i].GetFunctionName()+"();");
+        AddLine(output,"profiledCall.Called();");
+        AddLine(output,"profiledCall.Finished();");
         AddLine(output,"EXCEL_END_CMD;");
         AddLine(output,"}");
         AddLine(output,"}");
@@ -184,7 +314,12 @@ std::vector<char> OutputFileCreator(const std::vector<FunctionDescription>& func
           AddLine(output,",true");
         else
           AddLine(output,",false");
-        AddLine(output,",\"\"");
+        if ( fpReturn )
+          AddLine(output,",\"XLW_FP\"");
+        else if ( inPlace )
+          AddLine(output,",\""+std::string(1, static_cast<char>('0'+inPlace))+"\"");
+        else
+          AddLine(output,",\"\"");
         if ( functionDescriptions[i].GetHelpID().length() > 0 )
         {
             std::string helpline(",");
@@ -207,6 +342,17 @@ std::vector<char> OutputFileCreator(const std::vector<FunctionDescription>& func
           AddLine(output,",false");
 
         AddLine(output, ");");
+        AddLine(output,"XlfProfiler profile"+name+"(\""+display_name+"\");");
+        // an asynchronous function's task is profiled on its own, as it
+        // runs on another thread once the wrapper has returned
+        if (functionDescriptions[i].GetAsynchronous())
+          AddLine(output,"XlfProfiler profile"+name+"Task(\""+display_name+" task\");");
+        if (cacheMegabytes)
+        {
+          std::ostringstream budget;
+          budget << cacheMegabytes;
+          AddLine(output,"XlfResultCache cache"+name+"(\""+display_name+"\", static_cast<size_t>("+budget.str()+"UL) << 20);");
+        }
         AddLine(output,"}");
 
         // ok we've done the registration, we still need to do the function
@@ -220,7 +366,12 @@ std::vector<char> OutputFileCreator(const std::vector<FunctionDescription>& func
         AddLine(output,"{");
 
         //AddLine(output,"LPXLOPER EXCEL_EXPORT");
-        AddLine(output,"LPXLFOPER EXCEL_EXPORT");
+        if (fpReturn)
+          AddLine(output,"LPXLARRAY EXCEL_EXPORT");
+        else if (inPlace)
+          AddLine(output,"void EXCEL_EXPORT");
+        else
+          AddLine(output,"LPXLFOPER EXCEL_EXPORT");
         AddLine(output,"xl"+name+"(");
 
 
@@ -251,104 +402,167 @@ std::vector<char> OutputFileCreator(const std::vector<FunctionDescription>& func
         AddLine(output,"{");
         AddLine(output,"EXCEL_BEGIN;");
         AddLine(output,"");
-        if(functionDescriptions[i].GetReturnType() != "void")
+        if(functionDescriptions[i].GetReturnType() != "void" || inPlace)
         {
-            AddLine( output, "\tif (XlfExcel::Instance().IsCalledByFuncWiz())");
-            AddLine(output,"\t\treturn XlfOper(true);");
-            AddLine(output,"");
-
-            {for (unsigned long j=0; j < functionDescriptions[i].NumberOfArguments(); j++)
+            // <xlw:nowizardcheck functions are cheap enough to run in the wizard
+            if (!functionDescriptions[i].GetNoWizardCheck())
             {
-
-              // we converted to XlfOper now we have to go through our conversion chain
-
-              std::vector<std::string> chain = functionDescriptions[i].GetArgument(j).GetTheType().GetConversionChain();
-              char id = 'a';
-
-              std::string lastId = functionDescriptions[i].GetArgument(j).GetArgumentName()+id;
-              ++id;
-
-              for (unsigned long k=0; k < chain.size() -1; k++)
+              AddLine( output, "\tif (XlfExcel::Instance().IsCalledByFuncWiz())");
+              if (inPlace)
+                AddLine(output,"\t\treturn;");
+              else if (fpReturn)
               {
-                std::vector<std::string>::const_iterator it = chain.begin()+chain.size()-2-k;
-                std::string newId = functionDescriptions[i].GetArgument(j).GetArgumentName();
-
-                if (k+1 != chain.size() -1)
-                  newId+= id;
-
-                TypeRegistry<native>::regData argData = TypeRegistry<native>::Instance().GetRegistration(*it);
-                AddLine(output, argData.NewType+" "+newId+"(");
-
-                bool specIdentifier = argData.TakesIdentifier;
-                std::string identifierBit;
-                bool isMethod = argData.IsAMethod;
-
-                if (specIdentifier && !isMethod)
-                  identifierBit = ",\""+newId+"\"";
-                if (specIdentifier && isMethod)
-                  identifierBit = "\""+newId+"\"";
-
+                AddLine(output,"\t{");
+                AddLine(output,"\t\tdouble* placeholder;");
+                AddLine(output,"\t\tLPXLARRAY wizardResult = createTempFpArray(1, 1, placeholder);");
+                AddLine(output,"\t\tplaceholder[0] = 0.0;");
+                AddLine(output,"\t\treturn wizardResult;");
+                AddLine(output,"\t}");
+              }
+              else
+                AddLine(output,"\t\treturn XlfOper(true);");
+              AddLine(output,"");
+            }
 
-                if (isMethod)
-                  AddLine(output, "\t"+lastId+"."+argData.Converter+"("+identifierBit+"));");
-                else
-                  AddLine(output, "\t"+argData.Converter+"("+lastId+identifierBit+"));");
+            AddLine(output,"XlfProfiler::Call profiledCall(profile"+name+");");
 
-                ++id;
-                lastId=newId;
+            // the key is made of the arguments as Excel passed them, so a
+            // hit costs no conversions
+            if (cacheMegabytes)
+            {
+              AddLine(output,"\tXlfResultCache::Key cacheKey;");
+              for (unsigned long j=0; j < functionDescriptions[i].NumberOfArguments(); j++)
+              {
+                std::string uniqifier("a");
+                if (functionDescriptions[i].GetArgument(j).GetTheType().GetConversionChain().size() == 1)
+                  uniqifier = "";
+                AddLine(output,"\tcacheKey.Add("+functionDescriptions[i].GetArgument(j).GetArgumentName()+uniqifier+");");
               }
-
+              AddLine(output,fpReturn ? "\tLPXLARRAY cached;" : "\tLPXLFOPER cached;");
+              AddLine(output,"\tif (cache"+name+".Find(cacheKey, cached))");
+              AddLine(output,"\t\t"+ProfiledReturn("cached"));
               AddLine(output,"");
+            }
+
+            WriteArgumentConversions(output, functionDescriptions[i]);
 
-            }}
+            WriteFunctionCall(output, functionDescriptions[i], inPlace != 0);
 
             if (functionDescriptions[i].DoTime())
             {
-              AddLine(output," HiResTimer t;");
+              WriteTimedResult(output);
             }
-
-            AddLine(output,functionDescriptions[i].GetReturnType()+" result(");
-            if (functionDescriptions[i].NumberOfArguments() >0)
+            else if (inPlace)
             {
-              AddLine(output,'\t'+functionDescriptions[i].GetFunctionName()+"(");
-              for (unsigned long j=0; j < functionDescriptions[i].NumberOfArguments(); j++)
+              // Excel takes the argument as the result
+              AddLine(output,"profiledCall.Finished();");
+            }
+            else if (functionDescriptions[i].GetReturnType() == "LPXLARRAY")
+            {
+              if (cacheMegabytes)
+                AddLine(output,"cache"+name+".Insert(cacheKey, result);");
+              AddLine(output,ProfiledReturn("result"));
+            }
+            else if (fpReturn)
+            {
+              if (cacheMegabytes)
               {
-                std::string delimiter;
-                if (j +1 < functionDescriptions[i].NumberOfArguments())
-                  delimiter = ",";
-                else
-                  delimiter = ")";
-
-                AddLine(output,"\t\t"+functionDescriptions[i].GetArgument(j).GetArgumentName()+delimiter);
+                AddLine(output,"LPXLARRAY cacheResult(createTempFpArray(result));");
+                AddLine(output,"cache"+name+".Insert(cacheKey, cacheResult);");
+                AddLine(output,ProfiledReturn("cacheResult"));
               }
-              AddLine(output,"\t);");
+              else
+                AddLine(output,ProfiledReturn("createTempFpArray(result)"));
             }
-            else
-              AddLine(output,'\t'+functionDescriptions[i].GetFunctionName()+"());");
-
-            if (functionDescriptions[i].DoTime())
+            else if (cacheMegabytes)
             {
-              AddLine(output,"CellMatrix resultCells(result);");
-              AddLine(output,"CellMatrix time(1,2);");
-              AddLine(output,"time(0,0) = \"time taken\";");
-              AddLine(output,"time(0,1) = t.elapsed();");
-              AddLine(output,"resultCells.PushBottom(time);");
-              AddLine(output,"return XlfOper(resultCells);");
+              AddLine(output,"XlfOper cacheResult(result);");
+              AddLine(output,"cache"+name+".Insert(cacheKey, cacheResult);");
+              AddLine(output,ProfiledReturn("cacheResult"));
             }
             else
             {
-              AddLine(output,"return XlfOper(result);");
+              AddLine(output,ProfiledReturn("XlfOper(result)"));
             }
         }
         else
         {
+            AddLine(output,"XlfProfiler::Call profiledCall(profile"+name+");");
             AddLine(output,'\t'+functionDescriptions[i].GetFunctionName()+"();");
+            AddLine(output,"profiledCall.Called();");
+            AddLine(output,"profiledCall.Finished();");
         }
-        AddLine(    output,"EXCEL_END");
+        if (fpReturn)
+          AddLine(  output,"EXCEL_END_ARRAY");
+        else if (inPlace)
+          AddLine(  output,"EXCEL_END_VOID");
+        else
+          AddLine(  output,"EXCEL_END");
 
         AddLine(output,"}");
 
         AddLine(output,"}");
+
+        // From Excel 2010 the function is registered as xl<Name>Sync, which
+        // converts the arguments, so the task owns copies of them, and
+        // returns straight away. The result goes back through the handle.
+        if (functionDescriptions[i].GetAsynchronous())
+        {
+          AddLine(output,"");
+          AddLine(output,"extern \"C\"");
+          AddLine(output,"{");
+          AddLine(output,"void EXCEL_EXPORT");
+          AddLine(output,"xl"+name+"Sync(");
+          for (unsigned long j=0; j < functionDescriptions[i].NumberOfArguments(); j++)
+          {
+            std::vector<std::string> chain = functionDescriptions[i].GetArgument(j).GetTheType().GetConversionChain();
+            std::string uniqifier("a");
+            if (chain.size() ==1)
+              uniqifier ="";
+            AddLine(output,chain.back()+" "+functionDescriptions[i].GetArgument(j).GetArgumentName()+uniqifier+",");
+          }
+          AddLine(output,"LPXLOPER12 asyncHandle)");
+          AddLine(output,"{");
+          AddLine(output,"EXCEL_BEGIN;");
+          AddLine(output,"");
+          if (!functionDescriptions[i].GetNoWizardCheck())
+          {
+            AddLine(output,"\tif (XlfExcel::Instance().IsCalledByFuncWiz())");
+            AddLine(output,"\t{");
+            AddLine(output,"\t\tXlfAsync::Return(asyncHandle, XlfOper(true));");
+            AddLine(output,"\t\treturn;");
+            AddLine(output,"\t}");
+            AddLine(output,"");
+          }
+
+          AddLine(output,"XlfProfiler::Call profiledCall(profile"+name+");");
+          WriteArgumentConversions(output, functionDescriptions[i]);
+
+          std::string captures;
+          for (unsigned long j=0; j < functionDescriptions[i].NumberOfArguments(); j++)
+          {
+            std::string argName(functionDescriptions[i].GetArgument(j).GetArgumentName());
+            if (j > 0)
+              captures += ", ";
+            captures += argName+" = std::move("+argName+")";
+          }
+          AddLine(output,"XlfAsync::Submit(asyncHandle, ["+captures+"]() mutable -> LPXLFOPER");
+          AddLine(output,"{");
+          AddLine(output,"EXCEL_BEGIN;");
+          AddLine(output,"XlfProfiler::Call profiledCall(profile"+name+"Task);");
+          WriteFunctionCall(output, functionDescriptions[i], false);
+          if (functionDescriptions[i].DoTime())
+            WriteTimedResult(output);
+          else
+            AddLine(output,ProfiledReturn("XlfOper(result)"));
+          AddLine(output,"EXCEL_END");
+          AddLine(output,"});");
+          // the wrapper's marshalling is handing the task to the pool
+          AddLine(output,"profiledCall.Finished();");
+          AddLine(output,"EXCEL_END_ASYNC(asyncHandle)");
+          AddLine(output,"}");
+          AddLine(output,"}");
+        }
     }
 
     AddLine(output,"");
@@ -115,7 +115,11 @@ FunctionDescription::FunctionDescription(std::string FunctionName_,
                          std::string helpID_,
                          bool Asynchronous_,
                          bool MacroSheet_,
-                         bool ClusterSafe_)
+                         bool ClusterSafe_,
+                         bool FpReturn_,
+                         unsigned long InPlaceArgument_,
+                         bool NoWizardCheck_,
+                         unsigned long CacheMegabytes_)
                          :
                          FunctionName(FunctionName_),
                          DisplayName(FunctionName_),
@@ -129,7 +133,11 @@ FunctionDescription::FunctionDescription(std::string FunctionName_,
                          Threadsafe(Threadsafe_),
                          Asynchronous(Asynchronous_),
                          MacroSheet(MacroSheet_),
-                         ClusterSafe(ClusterSafe_)
+                         ClusterSafe(ClusterSafe_),
+                         FpReturn(FpReturn_),
+                         InPlaceArgument(InPlaceArgument_),
+                         NoWizardCheck(NoWizardCheck_),
+                         CacheMegabytes(CacheMegabytes_)
 {
 }
 
@@ -177,6 +185,26 @@ bool FunctionDescription::GetClusterSafe() const
     return ClusterSafe;
 }
 
+bool FunctionDescription::GetFpReturn() const
+{
+    return FpReturn;
+}
+
+unsigned long FunctionDescription::GetInPlaceArgument() const
+{
+    return InPlaceArgument;
+}
+
+bool FunctionDescription::GetNoWizardCheck() const
+{
+    return NoWizardCheck;
+}
+
+unsigned long FunctionDescription::GetCacheMegabytes() const
+{
+    return CacheMegabytes;
+}
+
 #include<iostream>
 void FunctionDescription::Transit(const std::vector<FunctionDescription> &source, 
 			 std::vector<FunctionDescription> & destination)
@@ -193,6 +221,9 @@ void FunctionDescription::Transit(const std::vector<FunctionDescription> &source
 		destination[i].FunctionHelpDescription  = source[i].FunctionHelpDescription  ;
 		destination[i].helpID                   = source[i].helpID  ;
 		destination[i].MacroSheet               = source[i].MacroSheet  ;
+		destination[i].NoWizardCheck            = source[i].NoWizardCheck  ;
+		destination[i].CacheMegabytes           = source[i].CacheMegabytes  ;
+		destination[i].FpReturn                 = source[i].FpReturn  ;
 		destination[i].Threadsafe               = source[i].Threadsafe  ;
 		destination[i].Time                     = source[i].Time  ;
 		destination[i].Volatile                 = source[i].Volatile  ;
@@ -70,7 +70,11 @@ public:
                          std::string helpID_,
                          bool Asynchronous_,
                          bool MacroSheet_,
-                         bool ClusterSafe_);
+                         bool ClusterSafe_,
+                         bool FpReturn_ = false,
+                         unsigned long InPlaceArgument_ = 0,
+                         bool NoWizardCheck_ = false,
+                         unsigned long CacheMegabytes_ = 0);
 
      std::string GetFunctionName() const;
      std::string GetDisplayName() const;
@@ -86,6 +90,10 @@ public:
      bool GetAsynchronous() const;
      bool GetMacroSheet() const;
      bool GetClusterSafe() const;
+     bool GetFpReturn() const;
+     unsigned long GetInPlaceArgument() const;
+     bool GetNoWizardCheck() const;
+     unsigned long GetCacheMegabytes() const;
      void setFunctionName(const std::string &newName);
 
 	 static void Transit(const std::vector<FunctionDescription> &source, 
@@ -107,6 +115,10 @@ private:
      bool Asynchronous;
      bool MacroSheet;
      bool ClusterSafe;
+     bool FpReturn;
+     unsigned long InPlaceArgument;
+     bool NoWizardCheck;
+     unsigned long CacheMegabytes;
 };
 
 
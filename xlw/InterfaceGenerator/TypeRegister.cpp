@@ -54,6 +54,12 @@ bool TypeRegistry<native>::IsOfBaseType(const std::string & id) const
     if (id == "double")
         return true;
 
+    if (id == "int" || id == "short")
+        return true;
+
+    if (id == "XCHAR*")
+        return true;
+
     if (id == "LPXLARRAY")
         return true;
 
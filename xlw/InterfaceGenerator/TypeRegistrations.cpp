@@ -49,6 +49,41 @@ TypeRegistry<native>::Helper doubleFundamentalReg("double", // New type
                "B"              // Type code
                );
 
+// Excel passes these itself, so the wrapper has nothing to convert
+TypeRegistry<native>::Helper intFundamentalReg("int", // New type
+               "int",           // Old type, a 32 bit integer
+               "",              // Converter name, we just pass into the constructor as a declaration
+               false,           // Is a method
+               false,           // Takes identifier
+               "J"              // Type code
+               );
+
+TypeRegistry<native>::Helper shortFundamentalReg("short", // New type
+               "short",         // Old type, a 16 bit integer
+               "",              // Converter name, we just pass into the constructor as a declaration
+               false,           // Is a method
+               false,           // Takes identifier
+               "I"              // Type code
+               );
+
+TypeRegistry<native>::Helper wstrFundamentalReg("XCHAR*", // New type
+               "XCHAR*",        // Old type, a counted wide string
+               "",              // Converter name, we just pass into the constructor as a declaration
+               false,           // Is a method
+               false,           // Takes identifier
+               "D%",            // Type code
+               "<xlw/PascalStringConversions.h>" // Include file
+               );
+
+TypeRegistry<native>::Helper fpFundamentalReg("LPXLARRAY", // New type
+               "LPXLARRAY",     // Old type, the FP12 as EXCEL passes it
+               "",              // Converter name, we just pass into the constructor as a declaration
+               false,           // Is a method
+               false,           // Takes identifier
+               "XLW_FP",        // Type code
+               "<xlw/xlarray.h>"// Include file
+               );
+
 TypeRegistry<native>::Helper arrayFundamentalReg("NEMatrix", // New type
                "LPXLARRAY",     // Old type
                "GetMatrix",     // Converter name, we just pass into the constructor as a declaration
@@ -58,28 +93,33 @@ TypeRegistry<native>::Helper arrayFundamentalReg("NEMatrix", // New type
                "<xlw/xlarray.h>"// Include file
                );
 
-TypeRegistry<native>::Helper shortreg("short", // New type
-               "XlfOper",       // Old type
-               "AsShort",       // Converter name
-               true,            // Is a method
-               true,            // Takes identifier
-               "XLF_OPER"       // Type code
+TypeRegistry<native>::Helper arrayViewReg("FpMatrixView", // New type
+               "LPXLARRAY",     // Old type
+               "GetMatrixView", // Converter name, reads the FP12 in place
+               false,           // Is a method
+               false,           // Takes identifier
+               "XLW_FP",        // Type code
+               "<xlw/xlarray.h>"// Include file
                );
 
+// Numeric arrays come as an FP12, so Excel does the checking and
+// converting of each cell
 TypeRegistry<native>::Helper arrayreg("MyArray", // New type
-               "XlfOper",       // Old type
-               "AsArray",       // Converter name
-               true,            // Is a method
+               "LPXLARRAY",     // Old type
+               "GetArray",      // Converter name
+               false,           // Is a method
                true,            // Takes identifier
-               "XLF_OPER"       // Type code
+               "XLW_FP",        // Type code
+               "<xlw/xlarray.h>"// Include file
                );
 
 TypeRegistry<native>::Helper matrixreg("MyMatrix", // New type
-               "XlfOper",       // Old type
-               "AsMatrix",      // Converter name
-               true,            // Is a method
-               true,            // Takes identifier
-               "XLF_OPER"       // Type code
+               "LPXLARRAY",     // Old type
+               "GetMatrix",     // Converter name
+               false,           // Is a method
+               false,           // Takes identifier
+               "XLW_FP",        // Type code
+               "<xlw/xlarray.h>"// Include file
                );
 
 TypeRegistry<native>::Helper cellsreg("CellMatrix", // New type
@@ -90,28 +130,28 @@ TypeRegistry<native>::Helper cellsreg("CellMatrix", // New type
                "XLF_OPER"       // Type code
                );
 
+// Excel coerces strings and booleans itself; a missing one arrives as
+// empty or FALSE
 TypeRegistry<native>::Helper stringreg("string", // New type
-               "XlfOper",       // Old type
-               "AsString",      // Converter name
-               true,            // Is a method
-               true,            // Takes identifier
-               "XLF_OPER"       // Type code
+               "XCHAR*",        // Old type
+               "PascalStringConversions::WPascalStringToString", // Converter name
+               false,           // Is a method
+               false            // Takes identifier
                );
 
 TypeRegistry<native>::Helper sstringreg("std::string", // New type
-               "XlfOper",       // Old type
-               "AsString",      // Converter name
-               true,            // Is a method
-               true,            // Takes identifier
-               "XLF_OPER"       // Type code
+               "XCHAR*",        // Old type
+               "PascalStringConversions::WPascalStringToString", // Converter name
+               false,           // Is a method
+               false            // Takes identifier
                );
 
 TypeRegistry<native>::Helper boolreg("bool", // New type
-               "XlfOper",       // Old type
-               "AsBool",        // Converter name
-               true,            // Is a method
-               true,            // Takes identifier
-               "XLF_OPER"       // Type code
+               "short",         // Old type
+               "static_cast<bool>", // Converter name
+               false,           // Is a method
+               false,           // Takes identifier
+               "A"              // Type code, passed as a short
                );
 
 // Usually XlfOper is registered as type XLF_OPER   which equates to either P (OPER)   or Q (OPER12)
@@ -133,21 +173,13 @@ TypeRegistry<native>::Helper ULreg("unsigned long", // New type
                false            // Takes identifier
                );
 
-TypeRegistry<native>::Helper intreg("int", // New type
-               "double",        // Old type
-               "static_cast<int>", // Converter name
+TypeRegistry<native>::Helper wstrreg("std::wstring", // New type
+               "XCHAR*",        // Old type
+               "PascalStringConversions::WPascalStringToWString", // Converter name
                false,           // Is a method
                false            // Takes identifier
                );
 
-// Special processing of std::wstring depending on Excel version
-TypeRegistry<native>::Helper wstrreg("std::wstring", // New type
-               "XlfOper",       // Old type
-               "AsWstring",      // Converter name
-               true,            // Is a method
-               true,            // Takes identifier
-               "XLF_OPER");
-
 TypeRegistry<native>::Helper DONreg("DoubleOrNothing", // New type
                "CellMatrix",    // Old type
                "DoubleOrNothing", // Converter name
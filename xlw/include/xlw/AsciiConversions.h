@@ -0,0 +1,56 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef INC_AsciiConversions_H
+#define INC_AsciiConversions_H
+
+/*!
+\file AsciiConversions.h
+\brief Widening and narrowing the ASCII characters at the start of a string
+
+Most strings passed to and from Excel are plain ASCII, which is the same
+in every code page and in UTF-8 and UTF-16, so they can be converted a
+block of characters at a time without asking the platform. These stop at
+the first character that isn't ASCII and leave the rest to the full
+converters in PascalStringConversions.
+
+SSE2 is used where the compiler targets it, AVX2 as well when built with
+it enabled (-mavx2 or /arch:AVX2), and a portable version otherwise.
+Define XLW_NO_SIMD to use the portable version everywhere.
+*/
+
+#include <cstddef>
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+namespace xlw {
+
+    class AsciiConversions
+    {
+    public:
+        //! Copies the leading ASCII characters of the n at source to destination
+        /*!
+        \return how many were copied, n if they were all ASCII
+        */
+        static size_t Widen(const char* source, size_t n, wchar_t* destination);
+        static size_t Narrow(const wchar_t* source, size_t n, char* destination);
+        //! "AVX2", "SSE2" or "portable"
+        static const char* Backend();
+    };
+}
+
+#endif
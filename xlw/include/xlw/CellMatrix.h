@@ -22,46 +22,70 @@ FOR A PARTICULAR PURPOSE.  See the license for more details.
 #include <xlw/CellValue.h>
 #include "xlw/MyContainers.h"
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace xlw {
 
+	namespace impl
+	{
+		// shared by every empty CellMatrix that hasn't been written to
+		inline const eshared_ptr<CellMatrix_pimpl_abstract>& EmptyCellMatrix()
+		{
+			static const eshared_ptr<CellMatrix_pimpl_abstract> theEmpty(new CellMatrixImpl());
+			return theEmpty;
+		}
+	}
+
+	//! A table of cells of mixed type
+	/*!
+	Copies share their cells until one of them is changed, so passing,
+	returning and storing a CellMatrix costs the same whatever its size.
+	A non-const reference to a cell stays valid only while the matrix isn't
+	copied, so once one has been handed out copies of the matrix are taken
+	in full, as they always were.
+	*/
 
 	class CellMatrix
 	{
 	public:
 
 		//Copy Constructor
-		CellMatrix(const CellMatrix &theOther):pimpl(theOther.pimpl.copy()){}
+		CellMatrix(const CellMatrix &theOther):
+		pimpl(theOther.shareable ? theOther.pimpl : theOther.pimpl.copy()), shareable(true){}
 
+		CellMatrix(CellMatrix &&theOther):pimpl(impl::EmptyCellMatrix()), shareable(true)
+		{
+			swap(theOther);
+		}
 
-		CellMatrix(size_t rows, size_t columns):pimpl(new CellMatrixImpl(rows, columns)){}
+		CellMatrix(size_t rows, size_t columns):pimpl(new CellMatrixImpl(rows, columns)), shareable(true){}
 
-		CellMatrix():pimpl(new CellMatrixImpl()){}
+		CellMatrix():pimpl(impl::EmptyCellMatrix()), shareable(true){}
 
 
-		CellMatrix(double data):pimpl(new CellMatrixImpl(1,1))
+		CellMatrix(double data):pimpl(new CellMatrixImpl(1,1)), shareable(true)
 		{
 			(*pimpl)(0,0)=data;
 		}
 
-		CellMatrix(const std::string &  data):pimpl(new CellMatrixImpl(1,1))
+		CellMatrix(const std::string &  data):pimpl(new CellMatrixImpl(1,1)), shareable(true)
 		{
 			(*pimpl)(0,0)=data;
 		}
 
-		CellMatrix(const std::wstring &  data):pimpl(new CellMatrixImpl(1,1))
+		CellMatrix(const std::wstring &  data):pimpl(new CellMatrixImpl(1,1)), shareable(true)
 		{
 			(*pimpl)(0,0)=data;
 		}
 		
-		CellMatrix(const char* data):pimpl(new CellMatrixImpl(1,1))
+		CellMatrix(const char* data):pimpl(new CellMatrixImpl(1,1)), shareable(true)
 		{
 			(*pimpl)(0,0)=std::string(data);
 		}
 		
 		CellMatrix(const MyArray& data):
-		pimpl(new CellMatrixImpl(ArrayTraits<MyArray>::size(data),1))
+		pimpl(new CellMatrixImpl(ArrayTraits<MyArray>::size(data),1)), shareable(true)
 		{
 			for(size_t i(0); i < ArrayTraits<MyArray>::size(data); ++i)
 			{
@@ -70,7 +94,7 @@ namespace xlw {
 		}
 		
 		CellMatrix(const MyMatrix& data):
-		pimpl(new CellMatrixImpl(MatrixTraits<MyMatrix>::rows(data),MatrixTraits<MyMatrix>::columns(data)))
+		pimpl(new CellMatrixImpl(MatrixTraits<MyMatrix>::rows(data),MatrixTraits<MyMatrix>::columns(data))), shareable(true)
 		{
 
 			for(size_t i(0); i < MatrixTraits<MyMatrix>::rows(data); ++i)
@@ -83,12 +107,12 @@ namespace xlw {
 
 		}
 		
-		CellMatrix(unsigned long data):pimpl(new CellMatrixImpl(1,1))
+		CellMatrix(unsigned long data):pimpl(new CellMatrixImpl(1,1)), shareable(true)
 		{
 			(*pimpl)(0,0)=data;
 		}
 		
-		CellMatrix(int data):pimpl(new CellMatrixImpl(1,1))
+		CellMatrix(int data):pimpl(new CellMatrixImpl(1,1)), shareable(true)
 		{
 			(*pimpl)(0,0)=data;
 		}
@@ -100,12 +124,21 @@ namespace xlw {
 			return *this;
 		}
 
+		CellMatrix & operator=(CellMatrix &&theOther)
+		{
+			CellMatrix temp(std::move(theOther));
+			temp.swap(*this);
+			return *this;
+		}
+
 		const CellValue& operator()(size_t i, size_t j) const
 		{
 			return pimpl->operator()(i,j);
 		}
 		CellValue& operator()(size_t i, size_t j) 
 		{	
+			detach();
+			shareable = false;
 			return pimpl->operator()(i,j);
 		}
 
@@ -120,19 +153,43 @@ namespace xlw {
 
 		void PushBottom(const CellMatrix & newRows)
 		{
-			CellMatrix temp(*this);
-			temp.pimpl->PushBottom(*(newRows.pimpl));
-			temp.swap(*this);
-
+			// each cell is copied once, straight into storage of the final size
+			const CellMatrix& top(*this);
+			eshared_ptr<CellMatrix_pimpl_abstract> stacked(new CellMatrixImpl(top.Impl(), newRows.Impl()));
+			pimpl.swap(stacked);
+			shareable = true;
 		}
 
 		void swap(CellMatrix &theOther)
 		{
 			pimpl.swap(theOther.pimpl);
+			std::swap(shareable, theOther.shareable);
+		}
+
+		//! The storage engine, for loops that use its non-virtual accessors
+		const CellMatrixImpl& Impl() const
+		{
+			return static_cast<const CellMatrixImpl&>(*pimpl);
+		}
+		//! Unshares the cells, which must not be changed through it once the matrix is copied
+		CellMatrixImpl& Impl()
+		{
+			detach();
+			return static_cast<CellMatrixImpl&>(*pimpl);
 		}
 
 	private:
+		void detach()
+		{
+			if (pimpl.use_count() > 1)
+			{
+				pimpl = pimpl.copy();
+			}
+		}
+
 		eshared_ptr<CellMatrix_pimpl_abstract> pimpl;
+		// false once a reference to a cell may have been kept
+		bool shareable;
 
 	};
 
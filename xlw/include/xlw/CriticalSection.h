@@ -17,7 +17,7 @@
 #ifndef INC_CriticalSection_H
 #define INC_CriticalSection_H
 
-#include <xlw/XlfWindows.h>
+#include <mutex>
 
 /*!
 \file CriticalSection.h
@@ -27,7 +27,7 @@
 // $Id$
 
 namespace xlw {
-//! Wrapper for a windows critical section
+//! Wrapper for a critical section
 /*!
 Create one of these objects for each time you
 need to ensure that sections of cae cannot run at
@@ -40,25 +40,22 @@ class CriticalSection
 public:
     CriticalSection()
     {
-        InitializeCriticalSection(&m_crit);
-    }
-
-    ~CriticalSection()
-    {
-        DeleteCriticalSection(&m_crit);
     }
 
     void lock()
     {
-        EnterCriticalSection(&m_crit);
+        m_crit.lock();
     }
 
     void unlock()
     {
-        LeaveCriticalSection(&m_crit);
+        m_crit.unlock();
     }
 private:
-    CRITICAL_SECTION m_crit;
+    CriticalSection(const CriticalSection&);
+    CriticalSection& operator=(const CriticalSection&);
+    // recursive to keep the re-entrancy of a windows critical section
+    std::recursive_mutex m_crit;
 };
 
 //! Helper for locking a critical section
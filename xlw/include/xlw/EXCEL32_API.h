@@ -58,7 +58,11 @@
     #define EXCEL32_API
 #endif
 
+#if defined(_WIN32)
 #define EXCEL_EXPORT __declspec(dllexport)
+#else
+#define EXCEL_EXPORT __attribute__((visibility("default")))
+#endif
 
 /*! @}  */
 
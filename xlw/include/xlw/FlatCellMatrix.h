@@ -0,0 +1,239 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef FLAT_CELL_MATRIX_H
+#define FLAT_CELL_MATRIX_H
+
+/*!
+\file FlatCellMatrix.h
+\brief CellMatrix storage as one contiguous array of tagged cells
+
+Select it in MyContainers.h by defining USE_XLW_FLAT_CELL_MATRIX.
+*/
+
+#include <xlw/CellValue.h>
+#include <xlw/CellMatrixPimpl.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xlw {
+
+	namespace impl
+	{
+		class FlatCellMatrix;
+
+		//! A cell of a FlatCellMatrix, 32 bytes on 64 bit platforms
+		/*!
+		Short strings are held in the cell itself, longer ones in a pool of
+		characters belonging to the matrix. The non-virtual accessors let loops
+		over FlatCellMatrix::Cells avoid a virtual call per cell.
+		*/
+		class FlatCellValue final : public CellValue
+		{
+		public:
+			enum ValueType : unsigned char
+			{
+				string, wstring, number, boolean, error, empty
+			};
+
+			/// is value an ascii string type
+			bool IsAString() const { return type_ == string; }
+			/// is value a unicode string
+			bool IsAWstring() const { return type_ == wstring; }
+			/// is value either an ascii or unicode string
+			bool IsString() const { return type_ == string || type_ == wstring; }
+			bool IsANumber() const { return type_ == number; }
+			bool IsBoolean() const { return type_ == boolean; }
+			bool IsEmpty() const { return type_ == empty; }
+			bool IsError() const { return type_ == error; }
+
+			const std::string & StringValue() const;
+			const std::wstring& WstringValue() const;
+			double NumericValue() const;
+			bool BooleanValue() const;
+			unsigned long ErrorValue() const;
+
+			operator std::string() const;
+			operator std::wstring() const;
+			operator bool() const;
+			operator double() const;
+			operator unsigned long() const;
+
+			void clear();
+
+			//! Bitwise copy for the owning matrix, which then fixes up the strings.
+			FlatCellValue(const FlatCellValue&) = default;
+
+			//! \name Non-virtual access
+			//@{
+			ValueType GetType() const { return type_; }
+			//! Only meaningful when GetType() is number.
+			double GetNumber() const { return value_.number; }
+			//! Only meaningful when GetType() is boolean.
+			bool GetBoolean() const { return value_.boolean; }
+			//! Only meaningful when GetType() is error.
+			unsigned long GetError() const { return value_.error; }
+			//! Characters in a string, not counting any terminator.
+			size_t GetLength() const { return length_; }
+			//! The characters when GetType() is string, not null terminated.
+			const char* GetNarrowData() const;
+			//! The characters when GetType() is wstring, not null terminated.
+			const wchar_t* GetWideData() const;
+
+			void SetNumber(double value);
+			void SetBoolean(bool value);
+			void SetError(unsigned long code);
+			void SetString(const char* data, size_t length);
+			void SetWstring(const wchar_t* data, size_t length);
+			//! Copies the value of a cell that may belong to another matrix.
+			void SetValue(const FlatCellValue& value);
+			//@}
+
+		private:
+			friend class FlatCellMatrix;
+
+			explicit FlatCellValue(FlatCellMatrix* owner) : length_(0), type_(empty), owner_(owner)
+			{
+				value_.number = 0.0;
+			}
+			FlatCellValue& operator=(const FlatCellValue&);
+
+			static const size_t inlineBytes = 8;
+
+			// forgets strings made for StringValue and WstringValue
+			void release();
+			bool isInline() const;
+
+			CellValue & assign(const std::string& data);
+			CellValue & assign(const std::wstring& data);
+			CellValue & assign(double data);
+			CellValue & assign(unsigned long data);
+			CellValue & assign(bool data);
+			CellValue & assign(int data);
+			CellValue & assign(error_type e);
+
+			union
+			{
+				double number;
+				bool boolean;
+				unsigned long error;
+				// offset into the owner's pool when the string isn't inline
+				size_t offset;
+				char narrow[inlineBytes];
+				wchar_t wide[inlineBytes / sizeof(wchar_t)];
+			} value_;
+			unsigned int length_;
+			ValueType type_;
+			FlatCellMatrix* owner_;
+		};
+
+		//! CellMatrix engine storing its cells row by row in one array
+		class FlatCellMatrix : public CellMatrix_pimpl_abstract
+		{
+		public:
+			FlatCellMatrix();
+			FlatCellMatrix(size_t rows, size_t columns);
+			//! Copies only the strings still in use, compacting the pools.
+			FlatCellMatrix(const FlatCellMatrix &theOther);
+			//! The rows of top above the rows of bottom.
+			FlatCellMatrix(const FlatCellMatrix &top, const CellMatrix_pimpl_abstract& bottom);
+
+			const CellValue& operator()(size_t i, size_t j) const;
+			CellValue& operator()(size_t i, size_t j);
+			size_t RowsInStructure() const;
+			size_t ColumnsInStructure() const;
+			void PushBottom(const CellMatrix_pimpl_abstract& newRows);
+
+			//! \name Non-virtual access for hot loops
+			//@{
+			//! RowsInStructure() * ColumnsInStructure() cells, row by row.
+			const FlatCellValue* Cells() const { return Cells_.data(); }
+			FlatCellValue* Cells() { return Cells_.data(); }
+			//@}
+
+		private:
+			friend class FlatCellValue;
+
+			FlatCellMatrix& operator=(const FlatCellMatrix&);
+
+			void swap(FlatCellMatrix& theOther);
+			void adopt();
+
+			std::vector<FlatCellValue> Cells_;
+			size_t Rows;
+			size_t Columns;
+			std::vector<char> NarrowPool;
+			std::vector<wchar_t> WidePool;
+
+			// strings handed out by reference by StringValue and WstringValue,
+			// made on first use and kept until the cell changes
+			mutable std::mutex TextMutex;
+			mutable std::unordered_map<size_t, std::unique_ptr<std::string> > NarrowText;
+			mutable std::unordered_map<size_t, std::unique_ptr<std::wstring> > WideText;
+		};
+
+		inline bool FlatCellValue::isInline() const
+		{
+			return type_ == string ? length_ <= inlineBytes : length_ <= inlineBytes / sizeof(wchar_t);
+		}
+
+		inline const char* FlatCellValue::GetNarrowData() const
+		{
+			return isInline() ? value_.narrow : owner_->NarrowPool.data() + value_.offset;
+		}
+
+		inline const wchar_t* FlatCellValue::GetWideData() const
+		{
+			return isInline() ? value_.wide : owner_->WidePool.data() + value_.offset;
+		}
+
+		inline void FlatCellValue::SetNumber(double value)
+		{
+			release();
+			type_ = number;
+			value_.number = value;
+		}
+
+		inline void FlatCellValue::SetBoolean(bool value)
+		{
+			release();
+			type_ = boolean;
+			value_.boolean = value;
+		}
+
+		inline void FlatCellValue::SetError(unsigned long code)
+		{
+			release();
+			type_ = error;
+			value_.error = code;
+		}
+
+		inline void FlatCellValue::release()
+		{
+			if (!owner_->NarrowText.empty() || !owner_->WideText.empty())
+			{
+				std::lock_guard<std::mutex> lock(owner_->TextMutex);
+				size_t index = this - owner_->Cells_.data();
+				owner_->NarrowText.erase(index);
+				owner_->WideText.erase(index);
+			}
+		}
+	}
+}
+
+#endif // FLAT_CELL_MATRIX_H
@@ -0,0 +1,167 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef FP_MATRIX_VIEW_H
+#define FP_MATRIX_VIEW_H
+
+/*!
+\file FpMatrixView.h
+\brief Read only views of arrays of doubles owned by someone else
+
+An FpMatrixView argument in cppinterface.h is registered as an FP12 (K%),
+and reads the numbers where Excel put them. The view is only valid during
+the call, so copy anything that has to outlive it.
+*/
+
+#include <xlw/xlcall32.h>
+#include <xlw/XlfException.h>
+#include <cstddef>
+
+namespace xlw {
+
+    //! A row, a column or any other evenly spaced run of doubles
+    class FpVectorView
+    {
+    public:
+        FpVectorView() : theData(0), Size(0), Stride(1) {}
+
+        //! size values, each stride doubles after the last.
+        FpVectorView(const double* data, size_t size, std::ptrdiff_t stride = 1)
+            : theData(data), Size(size), Stride(stride) {}
+
+        size_t size() const { return Size; }
+        std::ptrdiff_t stride() const { return Stride; }
+        //! The first value; the others follow at multiples of stride().
+        const double* data() const { return theData; }
+        //! True when the values are next to each other.
+        bool IsContiguous() const { return Stride == 1 || Size <= 1; }
+
+        double operator[](size_t i) const
+        {
+#ifdef _DEBUG
+            if (i >= Size)
+                throw XlfOutOfBounds();
+#endif
+            return theData[static_cast<std::ptrdiff_t>(i) * Stride];
+        }
+
+    private:
+        const double* theData;
+        size_t Size;
+        std::ptrdiff_t Stride;
+    };
+
+    //! A matrix of doubles read in place
+    /*!
+    Element (i, j) is at data() + i * rowStride() + j * columnStride(), so
+    blocks and transposes are views of the same numbers. An FP12 from Excel
+    is row major, with a row stride of columns() and a column stride of 1.
+    */
+    class FpMatrixView
+    {
+    public:
+        FpMatrixView() : theData(0), Rows(0), Columns(0), RowStride(0), ColumnStride(1) {}
+
+        FpMatrixView(const double* data, size_t rows, size_t columns, std::ptrdiff_t rowStride, std::ptrdiff_t columnStride = 1)
+            : theData(data), Rows(rows), Columns(columns), RowStride(rowStride), ColumnStride(columnStride) {}
+
+        //! Views the numbers of an FP12, which must outlive the view.
+        explicit FpMatrixView(const FP12* array)
+            : theData(array->array),
+              Rows(array->rows > 0 ? static_cast<size_t>(array->rows) : 0),
+              Columns(array->columns > 0 ? static_cast<size_t>(array->columns) : 0),
+              RowStride(array->columns),
+              ColumnStride(1) {}
+
+        size_t rows() const { return Rows; }
+        size_t columns() const { return Columns; }
+        size_t size1() const { return Rows; }
+        size_t size2() const { return Columns; }
+        size_t size() const { return Rows * Columns; }
+
+        std::ptrdiff_t rowStride() const { return RowStride; }
+        std::ptrdiff_t columnStride() const { return ColumnStride; }
+        //! Element (0, 0).
+        const double* data() const { return theData; }
+        //! True when the elements are one row major array of rows() * columns() doubles.
+        bool IsContiguous() const
+        {
+            return (ColumnStride == 1 || Columns <= 1) && (RowStride == static_cast<std::ptrdiff_t>(Columns) || Rows <= 1);
+        }
+
+        double operator()(size_t i, size_t j) const
+        {
+            check_row(i);
+            check_column(j);
+            return theData[static_cast<std::ptrdiff_t>(i) * RowStride + static_cast<std::ptrdiff_t>(j) * ColumnStride];
+        }
+
+        //! Row i, so that m[i][j] reads like the other matrix types.
+        FpVectorView operator[](size_t i) const { return Row(i); }
+
+        FpVectorView Row(size_t i) const
+        {
+            check_row(i);
+            return FpVectorView(theData + static_cast<std::ptrdiff_t>(i) * RowStride, Columns, ColumnStride);
+        }
+
+        FpVectorView Column(size_t j) const
+        {
+            check_column(j);
+            return FpVectorView(theData + static_cast<std::ptrdiff_t>(j) * ColumnStride, Rows, RowStride);
+        }
+
+        //! The rows x columns block whose top left element is (firstRow, firstColumn).
+        FpMatrixView Block(size_t firstRow, size_t firstColumn, size_t rows, size_t columns) const
+        {
+            if (firstRow + rows > Rows || firstColumn + columns > Columns)
+                throw XlfOutOfBounds();
+            const double* first = theData + static_cast<std::ptrdiff_t>(firstRow) * RowStride
+                + static_cast<std::ptrdiff_t>(firstColumn) * ColumnStride;
+            return FpMatrixView(first, rows, columns, RowStride, ColumnStride);
+        }
+
+        FpMatrixView Transpose() const
+        {
+            return FpMatrixView(theData, Columns, Rows, ColumnStride, RowStride);
+        }
+
+    private:
+        void check_row(size_t i) const
+        {
+#ifdef _DEBUG
+            if (i >= Rows)
+                throw XlfOutOfBounds();
+#endif
+        }
+
+        void check_column(size_t j) const
+        {
+#ifdef _DEBUG
+            if (j >= Columns)
+                throw XlfOutOfBounds();
+#endif
+        }
+
+        const double* theData;
+        size_t Rows;
+        size_t Columns;
+        std::ptrdiff_t RowStride;
+        std::ptrdiff_t ColumnStride;
+    };
+
+}
+
+#endif // FP_MATRIX_VIEW_H
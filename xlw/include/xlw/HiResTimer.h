@@ -17,7 +17,7 @@
 #ifndef INC_HiResTimer_H
 #define INC_HiResTimer_H
 
-#include <xlw/XlfWindows.h>
+#include <chrono>
 
 /*!
 \file HiResTimer.h
@@ -27,7 +27,7 @@
 // $Id$
 
 namespace xlw {
-//! Wrapper for a windows High Resolution Timers functions
+//! Wrapper for the high resolution steady clock
 /*!
 Create one of these objects for each time you
 need to accurately time something.
@@ -43,7 +43,7 @@ public:
     ~HiResTimer();
     double elapsed() const;
 private:
-    LARGE_INTEGER m_start;
+    std::chrono::steady_clock::time_point m_start;
 };
 
 }
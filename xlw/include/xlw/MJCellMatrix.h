@@ -157,6 +157,8 @@ namespace xlw {
 			}
 			MJCellMatrix();
 			MJCellMatrix(size_t rows, size_t columns);
+			//! The rows of top above the rows of bottom.
+			MJCellMatrix(const MJCellMatrix &top, const CellMatrix_pimpl_abstract& bottom);
 
 			const CellValue& operator()(size_t i, size_t j) const;
 			CellValue& operator()(size_t i, size_t j);
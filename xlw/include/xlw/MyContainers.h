@@ -34,12 +34,16 @@
 // Uncomment the line below to use boost matrix
 //#define USE_XLW_WITH_BOOST_UBLAS
 
+// Uncomment the line below to store CellMatrix cells in one flat array
+//#define USE_XLW_FLAT_CELL_MATRIX
+
 #ifndef _SCL_SECURE_NO_WARNINGS
 #define _SCL_SECURE_NO_WARNINGS
 #endif
 
-#include <xlw/NCMatrices.h>
+#include <xlw/NCmatrices.h>
 #include <xlw/MJCellMatrix.h>
+#include <xlw/FlatCellMatrix.h>
 #include <vector>
 
 #ifdef USE_XLW_WITH_BOOST_UBLAS
@@ -71,7 +75,11 @@ namespace xlw {
 #endif
 
 
+#ifdef USE_XLW_FLAT_CELL_MATRIX
+	typedef impl::FlatCellMatrix CellMatrixImpl;
+#else
 	typedef impl::MJCellMatrix CellMatrixImpl;
+#endif
 
 
     template<typename MatrixType>
@@ -43,6 +43,14 @@ namespace xlw {
         static std::wstring WPascalStringToWString(const wchar_t* pascalString);
         static wchar_t* StringToWPascalString(const std::string& cString);
         static wchar_t* WStringToWPascalString(const std::wstring& cString);
+        //! As above for the first n characters at cString, which needn't be null terminated
+        static wchar_t* StringToWPascalString(const char* cString, size_t n);
+        static wchar_t* WStringToWPascalString(const wchar_t* cString, size_t n);
+        //! Conversions between narrow and wide strings, as for the Pascal strings above
+        static std::string WStringToString(const std::wstring& wString);
+        static std::string WStringToString(const wchar_t* wString, size_t n);
+        static std::wstring StringToWString(const std::string& cString);
+        static std::wstring StringToWString(const char* cString, size_t n);
         static char* PascalStringCopy(const char* pascalString);
         static wchar_t* WPascalStringCopy(const wchar_t* pascalString);
         static char* PascalStringCopyUsingNew(const char* pascalString);
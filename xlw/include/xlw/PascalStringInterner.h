@@ -0,0 +1,86 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef INC_PascalStringInterner_H
+#define INC_PascalStringInterner_H
+
+/*!
+\file PascalStringInterner.h
+\brief One Excel string per distinct value of a result
+*/
+
+#include <cstddef>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+namespace xlw {
+
+    //! Converts strings to Pascal strings in TempMemory, once for each distinct value
+    /*!
+    Used while marshalling one result, so that cells repeating a label
+    point at the same Excel string rather than each converting and
+    allocating its own. A repeat is recognised from the characters given,
+    before any conversion. Those characters are remembered rather than
+    copied, so they must not change or go away while the interner is in use.
+
+    When few strings turn out to repeat the interner stops looking them
+    up and just converts them, so results of distinct strings don't pay
+    for a table that saves nothing.
+    */
+    class PascalStringInterner
+    {
+    public:
+        PascalStringInterner();
+
+        //! The Excel string for the first length characters at data.
+        wchar_t* Narrow(const char* data, size_t length);
+        wchar_t* Wide(const wchar_t* data, size_t length);
+        //! The empty Excel string, made once and not counted as a repeat.
+        wchar_t* Empty();
+
+    private:
+        PascalStringInterner(const PascalStringInterner&);
+        PascalStringInterner& operator=(const PascalStringInterner&);
+
+        struct Entry
+        {
+            const void* data;
+            size_t length;
+            size_t hash;
+            wchar_t* pascalString;
+            bool wide;
+        };
+
+        template<class Char>
+        wchar_t* intern(const Char* data, size_t length, bool wide);
+        void grow();
+
+        // open addressing, a power of two in size and at most half full
+        std::vector<Entry> Entries;
+        size_t Used;
+        size_t Lookups;
+        size_t Hits;
+        bool Bypass;
+        wchar_t* EmptyString;
+        // the last string asked for, cells of one matrix often share characters
+        Entry Last;
+    };
+
+}
+
+#endif
@@ -21,7 +21,6 @@
 #ifndef INC_TempMemory_H
 #define INC_TempMemory_H
 #include<memory>
-#include<xlw/XlfWindows.h>
 /*!
 \file TempMemory.h
 \brief Declares class TempMemory.
@@ -29,7 +28,9 @@
 
 // $Id$
 
-#include <list>
+#include <vector>
+#include <cstddef>
+#include <atomic>
 
 #if defined(_MSC_VER)
 #pragma once
@@ -41,10 +42,38 @@ namespace xlw {
     /*!
     Used by the XLOPER code to create objects that are returnable
     to excel without having to deal with full memory management.
+
+    Each thread owns its own arena held in thread_local storage so
+    allocation never takes a lock, it simply bumps a pointer through
+    the current buffer. Requests are rounded up to the platform's
+    fundamental alignment so that any type can be placed in the arena.
     */
     class TempMemory
     {
     public:
+        //! Usage counters for temporary memory
+        /*!
+        Counters are kept per thread and merged on read, the peaks are
+        the largest seen on any single thread.
+        */
+        struct Statistics
+        {
+            //! Total bytes handed out, after rounding for alignment
+            unsigned long long bytesRequested;
+            //! Number of buffers taken from the heap
+            unsigned long long buffersAllocated;
+            //! Number of times a call outgrew its buffer and had to chain a new one
+            unsigned long long bufferGrowths;
+            //! Number of top-level exported function calls
+            unsigned long long topLevelCalls;
+            //! Most bytes used by a single top-level call
+            unsigned long long peakBytesPerCall;
+            //! Deepest nesting of exported function calls
+            unsigned long long peakDepth;
+            //! Number of threads that have used temporary memory
+            unsigned long long threads;
+        };
+
         //! \name Structors and static members
         //@{
         //! Dtor.
@@ -53,13 +82,23 @@ namespace xlw {
 
         //! \name Memory management
         //@{
-        //! Allocates memory in the framework temporary buffer
+        //! Allocates value-initialised (zeroed) memory in the framework temporary buffer
         template<typename TYPE>
         static TYPE* GetMemory(size_t numItems = 1)
         {
             return reinterpret_cast<TYPE*>(GetBytes(numItems * sizeof(TYPE)));
         }
 
+        //! Allocates memory in the framework temporary buffer without clearing it
+        /*!
+        Only for callers that overwrite every item before it is read.
+        */
+        template<typename TYPE>
+        static TYPE* GetMemoryUninitialised(size_t numItems = 1)
+        {
+            return reinterpret_cast<TYPE*>(GetRawBytes(numItems * sizeof(TYPE)));
+        }
+
 		//! Allocates memory using new operator
         template<typename TYPE>
         static TYPE* GetMemoryUsingNew(size_t numItems = 1)
@@ -84,31 +123,62 @@ namespace xlw {
         static void InitializeProcess();
         //! To be called to clean up TempMemory
         static void TerminateProcess();
+
+        //! Largest buffer a thread keeps between top-level calls
+        /*!
+        Between calls each thread keeps a single buffer sized to a
+        decaying high-water mark of recent usage, never more than this.
+        */
+        static void SetRetentionCeiling(size_t bytes);
+        //! The current retention ceiling in bytes
+        static size_t GetRetentionCeiling();
+
+        //! Buffers of at least this size are mapped directly from the OS
+        /*!
+        Such regions use huge pages where the platform allows and are
+        kept in a small per-thread cache for reuse rather than being
+        handed back to the OS.
+        */
+        static void SetLargeBlockThreshold(size_t bytes);
+        //! The current large block threshold in bytes
+        static size_t GetLargeBlockThreshold();
         //@}
 
-        //! \name Utilities
+        //! \name Instrumentation
         //@{
-        //! Has this thread stopped
-        bool isThreadDead() const;
+        //! Counters aggregated over every thread, including those that have exited
+        static Statistics GetStatistics();
+        //! Counters for the calling thread only
+        static Statistics GetThreadStatistics();
+        //! Bytes the calling thread has been handed out, read at the start and end of a call to measure it
+        static unsigned long long GetThreadBytesRequested();
         //@}
 
     private:
-        typedef std::shared_ptr<char> shared_char_ptr;
         //! \name Structors and static members
         //@{
         //! Ctor.
         TempMemory();
+        TempMemory(const TempMemory&);
+        TempMemory& operator=(const TempMemory&);
         //@}
 
-        //! Allocates memory in the framework temporary buffer
+        //! The arena belonging to the calling thread
+        static TempMemory& ThreadInstance();
+
+        //! Allocates zeroed memory in the framework temporary buffer
         static char* GetBytes(size_t bytes);
+        //! Allocates memory in the framework temporary buffer
+        static char* GetRawBytes(size_t bytes);
 
+        //! Slow path of GetBytes, called when the current buffer is exhausted
         char* InternalGetMemory(size_t bytes);
         //! Frees temporary memory used by the XLL
         void InternalFreeMemory(bool finished=false);
+        //! Update the high-water mark and keep one right-sized buffer
+        void RetainBuffer();
         void InternalEnterExportedFunction();
         void InternalLeaveExportedFunction();
-        static TempMemory* CreateTempMemory();
 
         //! Memory buffer used to store data that are passed to Excel
         /*!
@@ -127,25 +197,58 @@ namespace xlw {
         */
         struct XlfBuffer
         {
+            //! Returns a buffer to the heap, or its pages to the OS
+            struct Release
+            {
+                void operator()(char* start) const;
+                //! Size of the mapping, zero for heap buffers
+                size_t mappedSize;
+            };
+
             //! Size of the buffer.
             size_t size;
             //! Start address.
-            shared_char_ptr start;
+            std::unique_ptr<char, Release> start;
         };
 
-        //! A list of buffers.
-        typedef std::list<XlfBuffer> BufferList;
-        //! Internal memory buffer holding memory to be referenced by Excel (excluded from the pimpl to allow inlining).
-        BufferList freeList_;
-        //! Pointer to next free area (excluded from the pimpl to allow inlining).
-        size_t offset_;
-        //! Thread Id that this object belongs to
-        DWORD threadId_;
+        //! A list of buffers, the one being allocated from is at the back.
+        typedef std::vector<XlfBuffer> BufferList;
+        //! Internal memory buffer holding memory to be referenced by Excel.
+        BufferList buffers_;
+        //! Large mapped regions kept for reuse
+        BufferList regionCache_;
+        //! Pointer to next free area in the current buffer
+        char* current_;
+        //! One past the end of the current buffer
+        char* end_;
+        //! Bytes handed out from buffers before the current one
+        size_t retiredBytes_;
+        //! Decaying high-water mark of bytes used per top-level call
+        size_t highWater_;
         //! Recurse depth
         int depth_;
 
-        //! Create a new static buffer and add it to the free list.
+        //! Create a new static buffer and make it the current one.
         void PushNewBuffer(size_t);
+        //! A buffer of at least size bytes from the region cache, the OS or the heap
+        XlfBuffer AllocateBuffer(size_t size);
+        //! Drops every buffer, keeping large regions in the cache
+        void DiscardBuffers();
+
+        //! Bytes used since the start of the current top-level call
+        size_t BytesInUse() const;
+        //! Snapshot of this thread's counters
+        Statistics Snapshot() const;
+
+        //! \name Counters, written only by the owning thread
+        //@{
+        std::atomic<unsigned long long> bytesRequested_;
+        std::atomic<unsigned long long> buffersAllocated_;
+        std::atomic<unsigned long long> bufferGrowths_;
+        std::atomic<unsigned long long> topLevelCalls_;
+        std::atomic<unsigned long long> peakBytesPerCall_;
+        std::atomic<unsigned long long> peakDepth_;
+        //@}
     };
 
     //! RAII class to signal that we are using Temporary memory
@@ -17,51 +17,65 @@
 #ifndef INC_ThreadLocalStorage_H
 #define INC_ThreadLocalStorage_H
 
-#include <xlw/XlfWindows.h>
-#include <xlw/XlfException.h>
+#include <atomic>
+#include <vector>
+#include <cstddef>
 
 /*!
 \file ThreadLocalStorage.h
-\brief Declares class CriticalSection and ProtectInScope
+\brief Declares class ThreadLocalStorage
 */
 
 // $Id$
 
 namespace xlw {
 
+namespace impl {
+    // Each ThreadLocalStorage object takes a slot in a thread_local table.
+    // Slots are never reused so a new object can't see a value left behind
+    // by an old one
+    inline size_t NewThreadLocalSlot()
+    {
+        static std::atomic<size_t> nextSlot(0);
+        return nextSlot.fetch_add(1);
+    }
+
+    inline std::vector<void*>& ThreadLocalSlots()
+    {
+        static thread_local std::vector<void*> slots;
+        return slots;
+    }
+}
+
 // This is essential a smart pointer .. when
 // thinking in terms of resource allocation
 template<typename T>
 class ThreadLocalStorage
 {
 public:
-    ThreadLocalStorage()
+    ThreadLocalStorage() : m_slot(impl::NewThreadLocalSlot())
     {
-        m_tlsIndex = TlsAlloc();
-        if(m_tlsIndex == TLS_OUT_OF_INDEXES)
-        {
-            THROW_XLW("TLS run out of TLS indices");
-        }
-    }
-
-    ~ThreadLocalStorage()
-    {
-        TlsFree(m_tlsIndex);
     }
 
     T* GetValue()
     {
-        return reinterpret_cast<T*>(TlsGetValue(m_tlsIndex));
+        const std::vector<void*>& slots(impl::ThreadLocalSlots());
+        return m_slot < slots.size() ? reinterpret_cast<T*>(slots[m_slot]) : 0;
     }
     void SetValue(T* newValue)
     {
-        TlsSetValue(m_tlsIndex, reinterpret_cast<void*>(newValue));
+        std::vector<void*>& slots(impl::ThreadLocalSlots());
+        if(m_slot >= slots.size())
+        {
+            slots.resize(m_slot + 1, 0);
+        }
+        slots[m_slot] = reinterpret_cast<void*>(newValue);
     }
 
 private:
     ThreadLocalStorage(const ThreadLocalStorage &);
     ThreadLocalStorage & operator=(const ThreadLocalStorage&);
-    DWORD m_tlsIndex;
+    size_t m_slot;
 };
 
 }
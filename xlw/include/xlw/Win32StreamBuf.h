@@ -27,6 +27,7 @@
 #define INC_Win32StreamBuf_H
 
 #include <streambuf>
+#include <string>
 #include <iostream>
 #include "xlw/macros.h"
 
@@ -57,7 +58,9 @@ namespace xlw {
     private:
         //! Redirect output to compiler debug window
         void SendToDebugWindow();
-        std::string buf_;
+        //! Text waiting to be sent, one per thread as calculation threads
+        //! write to std::cerr at the same time
+        static std::string& buffer();
 
         //! Copy ctor not implemented to prevent use
         Win32StreamBuf(const Win32StreamBuf&);
@@ -28,10 +28,16 @@ namespace xlw {
     This method is called to dump stuff in the put area out to the file.
     We intercept it to send to debug window.
     */
+    inline std::string& Win32StreamBuf::buffer()
+    {
+        static thread_local std::string theBuffer;
+        return theBuffer;
+    }
+
     inline int Win32StreamBuf::sync()
     {
         SendToDebugWindow();
-        buf_.erase();
+        buffer().erase();
         return 0;
     }
 
@@ -43,7 +49,7 @@ namespace xlw {
     {
         if (!traits_type::eq_int_type(traits_type::eof(), ch))
         {
-            buf_.append(1, traits_type::to_char_type(ch));
+            buffer().append(1, traits_type::to_char_type(ch));
         }
         else
         {
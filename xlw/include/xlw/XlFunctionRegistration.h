@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <set>
 #include <xlw/XlfExcel.h>
 #include <xlw/Singleton.h>
 #include <xlw/eshared_ptr.h>
@@ -44,12 +45,14 @@ namespace xlw {
                                   const std::string& ExcelCommandName_,
                                   const std::string& Comment_,
                                   const std::string& Menu_,
-                                  const std::string& MenuText_):
+                                  const std::string& MenuText_,
+                                  bool AddinQualified_ = false):
                                   CommandName(CommandName_),
                                   ExcelCommandName(ExcelCommandName_),
                                   Comment(Comment_),
                                   Menu(Menu_),
-                                  MenuText(MenuText_){}
+                                  MenuText(MenuText_),
+                                  AddinQualified(AddinQualified_){}
         
 
         const std::string& GetCommandName() const;
@@ -57,6 +60,10 @@ namespace xlw {
         const std::string& GetCommandComment() const;
         const std::string& GetMenu() const;
         const std::string& GetMenuText() const;
+        bool GetAddinQualified() const
+        {
+            return AddinQualified;
+        }
 
 
     private:
@@ -65,6 +72,7 @@ namespace xlw {
         std::string Comment;
         std::string Menu;
         std::string MenuText;
+        bool AddinQualified;
 
     
     };
@@ -85,7 +93,8 @@ namespace xlw {
                          const std::string &HelpID_,
                          bool Asynchronous_,
                          bool MacroSheetEquivalent_,
-                         bool ClusterSafe_);
+                         bool ClusterSafe_,
+                         bool AddinQualified_ = false);
 
         const std::string&  GetFunctionName() const;
         const std::string&  GetExcelFunctionName() const;
@@ -121,6 +130,11 @@ namespace xlw {
             return ClusterSafe;
         }
 
+        bool GetAddinQualified() const
+        {
+            return AddinQualified;
+        }
+
         const std::string & GetReturnTypeCode() const;
         const std::string & GetHelpID() const;
     private:
@@ -140,6 +154,7 @@ namespace xlw {
         bool Asynchronous;
         bool MacroSheetEquivalent;
         bool ClusterSafe;
+        bool AddinQualified;
     };
 
     class XLFunctionRegistrationHelper
@@ -158,7 +173,8 @@ namespace xlw {
                          const std::string &HelpID = "",
                          bool Asynchronous = false,
                          bool MacroSheetEquivalent = false,
-                         bool ClusterSafe = false);
+                         bool ClusterSafe = false,
+                         bool AddinQualified = false);
 
     };
 
@@ -170,10 +186,19 @@ namespace xlw {
                                   const std::string& ExcelCommandName_,
                                   const std::string& Comment_,
                                   const std::string& Menu_,
-                                  const std::string& MenuText_);
+                                  const std::string& MenuText_,
+                                  bool AddinQualified_ = false);
 
     };
 
+    //! name prefixed with the file name of the XLL, as in MyAddin.name
+    /*! For the functions and commands the library itself adds to every
+        add-in, which would otherwise clash when two add-ins are open.
+        Registrations made with AddinQualified get their Excel names this
+        way when the add-in is opened.
+    */
+    std::string AddinQualifiedName(const std::string& name);
+
 
     // singleton pattern, cf the Factory
     class ExcelFunctionRegistrationRegistry: public singleton<ExcelFunctionRegistrationRegistry>
@@ -184,15 +209,23 @@ namespace xlw {
         void DoTheDeregistrations() const;
         void AddFunction(const XLFunctionRegistrationData&);
         void AddCommand(const XLCommandRegistrationData&);
+        //! True once a function declared with <xlw:asynchronous has been added.
+        bool HasAsynchronousFunctions() const
+        {
+            return Asynchronous;
+        }
         void GenerateDocumentation(const std::string& outputDir);
     private:
         typedef std::map<std::string, std::shared_ptr<xlw::XlfFuncDesc> > functionCache;
         typedef std::map<std::string, std::shared_ptr<XlfCmdDesc> > commandCache;
-        ExcelFunctionRegistrationRegistry(){}
+        ExcelFunctionRegistrationRegistry() : Asynchronous(false) {}
         void GenerateChmBuilderConfig(const std::string& fileName);
         void GenerateToc(const std::string& outputDir);
         std::map<std::string, std::shared_ptr<XlfFuncDesc> > Functions;
         std::map<std::string, std::shared_ptr<XlfCmdDesc> >  Commands;
+        //! The Excel names of the registrations made with AddinQualified.
+        std::set<std::string> Qualified;
+        bool Asynchronous;
 
     };
 
@@ -0,0 +1,97 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef INC_XlfAsync_H
+#define INC_XlfAsync_H
+
+/*!
+\file XlfAsync.h
+\brief Running asynchronous functions on a pool of threads
+*/
+
+#include <xlw/xlcall32.h>
+#include <cstddef>
+#include <functional>
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+namespace xlw {
+
+    //! Runs asynchronous functions and returns their results to Excel
+    /*!
+    From Excel 2010 a function declared with <xlw:asynchronous is registered
+    as xl<Name>Sync, which gets a handle as an extra last argument and
+    returns nothing. Its wrapper converts the arguments, which copies them
+    out of the memory Excel and TempMemory own, and submits a task with the
+    handle. The task runs on a pool of at most GetThreadCount() threads, and
+    its result is handed back with xlAsyncReturn, together with any others
+    that finished while the last results were being returned.
+
+    When Excel cancels a calculation the handles it gave out are no longer
+    valid. Tasks that haven't started are dropped, the results of those
+    running are thrown away, and a long task can poll Cancelled() to give up
+    early.
+    */
+    class XlfAsync
+    {
+    public:
+        //! Works out a result, an XLOPER12 in the TempMemory of the thread running it.
+        typedef std::function<LPXLOPER12()> Task;
+
+        //! Counters since the add-in was loaded
+        struct Statistics
+        {
+            unsigned long long submitted;
+            unsigned long long completed;
+            //! Results Excel accepted.
+            unsigned long long returned;
+            //! Calls to xlAsyncReturn, each returning one or more results.
+            unsigned long long batches;
+            //! Tasks and results dropped by a cancelled calculation.
+            unsigned long long dropped;
+            size_t queued;
+            size_t threads;
+        };
+
+        //! Queues task, whose result is returned for handle.
+        /*! handle is the xltypeBigData Excel passes to xl<Name>Sync. */
+        static void Submit(const XLOPER12* handle, Task task);
+        //! Returns result for handle without running anything, as when the arguments are wrong.
+        static void Return(const XLOPER12* handle, const XLOPER12* result);
+        //! True once the calculation the task being run belongs to has been cancelled.
+        static bool Cancelled();
+
+        //! \name The pool
+        //@{
+        //! The most threads that run tasks, by default the number of cores and at least two.
+        static void SetThreadCount(size_t count);
+        static size_t GetThreadCount();
+        //! Stops the threads once the tasks they are running finish, dropping the rest.
+        static void Shutdown();
+        static Statistics GetStatistics();
+        //@}
+
+        //! Drops the work of the calculation Excel has just cancelled.
+        static void CalculationCanceled();
+
+    private:
+        XlfAsync();
+    };
+
+}
+
+#endif
@@ -160,7 +160,18 @@ namespace xlw {
         //! Was the Esc key pressed ?
         bool IsEscPressed() const;
         //! Is the function being calculated currently called by the Function Wizard ?
+        /*!
+        The wizard only evaluates on Excel's main thread, so calls on the
+        other calculation threads are answered straight away. On the main
+        thread a negative answer is kept for a short interval, see
+        SetFuncWizCacheInterval(), so a long recalc looks for the wizard's
+        window now and then rather than on every call.
+        */
         bool IsCalledByFuncWiz() const;
+        //! How long, in milliseconds, to trust that the wizard isn't open; 0 looks every time.
+        void SetFuncWizCacheInterval(unsigned long milliseconds);
+        //! Forgets that the wizard wasn't open, so the next call looks again.
+        void ResetFuncWizCache();
         //! Gets the HWND of excel's main window
         HWND GetMainWindow();
         //! Gets the instance of Excel we are running under
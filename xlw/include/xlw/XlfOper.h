@@ -31,9 +31,12 @@
 //#include "xlw/MyContainers.h"
 #include <xlw/xlcall32.h>
 #include <xlw/XlfOperProperties.h>
+#include <xlw/PascalStringInterner.h>
+#include <xlw/XlfOperCells.h>
 #include <xlw/CellMatrix.h>
 #include <xlw/XlfRef.h>
 #include <vector>
+#include <utility>
 #include <string>
 
 #if defined(_MSC_VER)
@@ -72,6 +75,10 @@ namespace xlw {
         //@{
         //! Internal LPXLFOPER/LPXLOPER/LPXLOPER12.
         mutable LPXLOPER12 lpxloper_;
+        //! The cells of a reference, coerced when first read and kept in TempMemory.
+        mutable LPXLOPER12 values_;
+        //! False when lpxloper_ is memory the oper was given, such as a cell of an array.
+        mutable bool ownsOper_;
         //@}
 
         typedef XlfOperProperties OperProps;
@@ -103,6 +110,206 @@ namespace xlw {
                 OperProps::copy(lpxloper_, result);
                 OperProps::XlFree(lpxloper_);
                 lpxloper_ = result;
+                ownsOper_ = true;
+            }
+        }
+
+        bool isReference() const
+        {
+            XlTypeType type(OperProps::getXlType(lpxloper_) & 0xFFF);
+            return type == xltypeRef || type == xltypeSRef;
+        }
+
+        // What the cells are read from: the oper itself, or for a reference
+        // its values, coerced with one callback for the whole range the first
+        // time they're needed rather than one callback for each cell.
+        LPXLOPER12 values(const char* ErrorId = 0) const
+        {
+            if (!isReference())
+            {
+                return lpxloper_;
+            }
+            if (!values_)
+            {
+                LPXLOPER12 result = TempMemory::GetMemory<OperType>();
+                int xlret = OperProps::coerceToMulti(lpxloper_, result);
+                if (xlret != xlretSuccess)
+                {
+                    xlw::XlfOperImpl::ThrowOnError(xlret, ErrorId, "Conversion of Ref to values");
+                    throw XlfNeverGetHere();
+                }
+                values_ = result;
+            }
+            return values_;
+        }
+
+        // The CellMatrix conversions, overloaded on the storage engine so that
+        // the cells of a FlatCellMatrix are read and written without a virtual
+        // call for each one. Strings are interned, so a label repeated across
+        // a result is converted and stored once.
+        template<class Engine>
+        void setCells(const CellMatrix& cellmatrix, const Engine&, RW nbRows, COL nbCols)
+        {
+            PascalStringInterner strings;
+            for (RW row(0); row < nbRows; ++row)
+            {
+                for (COL col(0); col < nbCols; ++col)
+                {
+                    LPXLOPER12 elementOper = OperProps::getElement(lpxloper_, row, col);
+                    const CellValue& cellValue(cellmatrix(row,col));
+                    if (cellValue.IsANumber())
+                    {
+                        OperProps::setDouble(elementOper, cellValue.NumericValue());
+                    }
+                    else if (cellValue.IsAString())
+                    {
+                        const std::string& text(cellValue.StringValue());
+                        OperProps::setPascalString(elementOper, strings.Narrow(text.data(), text.size()));
+                    }
+                    else if (cellValue.IsAWstring())
+                    {
+                        const std::wstring& text(cellValue.WstringValue());
+                        OperProps::setPascalString(elementOper, strings.Wide(text.data(), text.size()));
+                    }
+                    else if (cellValue.IsBoolean())
+                    {
+                        OperProps::setBool(elementOper, cellValue.BooleanValue());
+                    }
+                    else if (cellValue.IsError())
+                    {
+                        OperProps::setError(elementOper, static_cast<short>(cellValue.ErrorValue()));
+                    }
+                    else
+                    {
+                        OperProps::setPascalString(elementOper, strings.Empty());
+                    }
+                }
+            }
+        }
+
+        void setCells(const CellMatrix&, const impl::FlatCellMatrix& cells, RW nbRows, COL nbCols)
+        {
+            PascalStringInterner strings;
+            size_t columns = cells.ColumnsInStructure();
+            for (RW row(0); row < nbRows; ++row)
+            {
+                const impl::FlatCellValue* cellValue = cells.Cells() + row * columns;
+                LPXLOPER12 elementOper = OperProps::getElement(lpxloper_, row, 0);
+                for (COL col(0); col < nbCols; ++col, ++cellValue, ++elementOper)
+                {
+                    switch (cellValue->GetType())
+                    {
+                    case impl::FlatCellValue::number:
+                        OperProps::setDouble(elementOper, cellValue->GetNumber());
+                        break;
+                    case impl::FlatCellValue::string:
+                        OperProps::setPascalString(elementOper, strings.Narrow(cellValue->GetNarrowData(), cellValue->GetLength()));
+                        break;
+                    case impl::FlatCellValue::wstring:
+                        OperProps::setPascalString(elementOper, strings.Wide(cellValue->GetWideData(), cellValue->GetLength()));
+                        break;
+                    case impl::FlatCellValue::boolean:
+                        OperProps::setBool(elementOper, cellValue->GetBoolean());
+                        break;
+                    case impl::FlatCellValue::error:
+                        OperProps::setError(elementOper, static_cast<short>(cellValue->GetError()));
+                        break;
+                    default:
+                        OperProps::setPascalString(elementOper, strings.Empty());
+                        break;
+                    }
+                }
+            }
+        }
+
+        template<class Engine>
+        void getCells(Engine& cells, const char* ErrorId) const
+        {
+            struct Store
+            {
+                Engine& cells;
+                void operator()(RW row, COL col, double value) { cells(row, col) = value; }
+                void operator()(RW row, COL col, XlfStringView value) { cells(row, col) = value.str(); }
+                void operator()(RW row, COL col, bool value) { cells(row, col) = value; }
+                void operator()(RW row, COL col, XlfErrorValue value)
+                {
+                    cells(row, col) = CellValue::error_type(static_cast<unsigned long>(value.code));
+                }
+                void operator()(RW, COL, XlfEmptyValue) {}
+            };
+            Store store = { cells };
+            Visit(store, ErrorId);
+        }
+
+        void getCells(impl::FlatCellMatrix& cells, const char* ErrorId) const
+        {
+            if ((OperProps::getXlType(lpxloper_) & 0xFFF) != xltypeMulti)
+            {
+                getCells<impl::FlatCellMatrix>(cells, ErrorId);
+                return;
+            }
+            size_t size = static_cast<size_t>(OperProps::getRows(lpxloper_)) * OperProps::getCols(lpxloper_);
+            impl::FlatCellValue* cellValue = cells.Cells();
+            LPXLOPER12 element = OperProps::getElement(lpxloper_, 0, 0);
+            for (size_t i(0); i < size; ++i, ++cellValue, ++element)
+            {
+                switch (OperProps::getXlType(element) & 0xFFF)
+                {
+                case xltypeNum:
+                    cellValue->SetNumber(OperProps::getDouble(element));
+                    break;
+                case xltypeStr:
+                    cellValue->SetWstring(element->val.str + 1, static_cast<size_t>(element->val.str[0]));
+                    break;
+                case xltypeBool:
+                    cellValue->SetBoolean(OperProps::getBool(element));
+                    break;
+                case xltypeInt:
+                    cellValue->SetNumber(OperProps::getInt(element));
+                    break;
+                case xltypeErr:
+                    cellValue->SetError(OperProps::getError(element));
+                    break;
+                case xltypeNil:
+                    break;
+                default:
+                    THROW_XLW("Unsupported type in CellMatrix conversion");
+                }
+            }
+        }
+
+        // Reads an xltypeMulti as doubles, calling store(row, col, value) for
+        // each cell. The type tags are checked a chunk at a time so that runs
+        // of numbers are copied without branching on each cell; only a chunk
+        // holding something else converts its cells one by one with AsDouble,
+        // which may ask Excel to coerce them.
+        template<class Store>
+        void getDoubles(Store& store, const char* ErrorId) const
+        {
+            const size_t chunk = 8;
+            MultiRowType nbRows(OperProps::getRows(lpxloper_));
+            MultiColType nbCols(OperProps::getCols(lpxloper_));
+            size_t size = static_cast<size_t>(nbRows) * nbCols;
+            LPXLOPER12 cells = OperProps::getElement(lpxloper_, 0, 0);
+            MultiRowType row(0);
+            MultiColType col(0);
+            for (size_t start(0); start < size; start += chunk)
+            {
+                size_t end = start + chunk < size ? start + chunk : size;
+                XlTypeType others(0);
+                for (size_t i(start); i < end; ++i)
+                {
+                    others |= (OperProps::getXlType(cells + i) & 0xFFF) ^ xltypeNum;
+                }
+                for (size_t i(start); i < end; ++i)
+                {
+                    store(row, col, others ? XlfOper(cells + i).AsDouble(ErrorId) : OperProps::getDouble(cells + i));
+                    if (++col == nbCols)
+                    {
+                        col = 0;
+                        ++row;
+                    }
+                }
             }
         }
 
@@ -138,109 +345,90 @@ namespace xlw {
         //@{
         //! Default ctor.
         XlfOper() :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setXlType(lpxloper_, xltypeMissing);
         }
         //! Copy ctor.
         XlfOper(const XlfOper& oper) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(oper.values_), ownsOper_(true)
         {
             OperProps::copy(oper.lpxloper_, lpxloper_);
         }
+        //! Move ctor, takes the value without copying it.
+        /*!
+        oper is left missing.
+        */
+        XlfOper(XlfOper&& oper) :
+            lpxloper_(oper.lpxloper_), values_(oper.values_), ownsOper_(oper.ownsOper_)
+        {
+            oper.lpxloper_ = TempMemory::GetMemory<OperType>();
+            oper.values_ = 0;
+            oper.ownsOper_ = true;
+            OperProps::setXlType(oper.lpxloper_, xltypeMissing);
+        }
 
         //! LPXLOPER/LPXLOPER12 ctor.
         XlfOper(LPXLOPER12 lpxloper) :
-            lpxloper_(lpxloper)
+            lpxloper_(lpxloper), values_(0), ownsOper_(false)
         {
         }
         //! double ctor.
         XlfOper(double value) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setDouble(lpxloper_, value);
         }
         //! short ctor.
         XlfOper(short value) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setInt(lpxloper_, value);
         }
         //! int ctor.
         XlfOper(int value) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setInt(lpxloper_, value);
         }
         //! unsigned long ctor.
         XlfOper(unsigned long value) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setDouble(lpxloper_, static_cast<double>(value));
         }
 
         //! boolean ctor.
         XlfOper(bool value) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setBool(lpxloper_, value);
         }
 
         //! Cellmatrix ctor.
         XlfOper(const CellMatrix& cellmatrix) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             RW nbRows = (RW)cellmatrix.RowsInStructure();
             COL nbCols = (COL)cellmatrix.ColumnsInStructure();
 
-            OperProps::setArraySize(lpxloper_, nbRows, nbCols);
+            OperProps::setArraySize(lpxloper_, nbRows, nbCols, false);
 
             // get actual number of rows in case of truncation
             nbRows = OperProps::getRows(lpxloper_);
             nbCols = OperProps::getCols(lpxloper_);
 
-            for (RW row(0); row < nbRows; ++row)
-            {
-                for (COL col(0); col < nbCols; ++col)
-                {
-                    LPXLOPER12 elementOper = OperProps::getElement(lpxloper_, row, col);
-                    const CellValue& cellValue(cellmatrix(row,col));
-                    if (cellValue.IsANumber())
-                    {
-                        OperProps::setDouble(elementOper, cellValue.NumericValue());
-                    }
-                    else if (cellValue.IsAString())
-                    {
-                        OperProps::setString(elementOper, cellValue.StringValue());
-                    }
-                    else if (cellValue.IsAWstring())
-                    {
-                        OperProps::setWString(elementOper, cellValue.WstringValue());
-                    }
-                    else if (cellValue.IsBoolean())
-                    {
-                        OperProps::setBool(elementOper, cellValue.BooleanValue());
-                    }
-                    else if (cellValue.IsError())
-                    {
-                        OperProps::setError(elementOper, static_cast<short>(cellValue.ErrorValue()));
-                    }
-                    else
-                    {
-                        OperProps::setString(elementOper, "");
-                    }
-                }
-            }
+            setCells(cellmatrix, cellmatrix.Impl(), nbRows, nbCols);
         }
 
         //! MyMatrix ctor.
         XlfOper(const MyMatrix& matrix) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             RW nbRows = (RW)MatrixTraits<MyMatrix>::rows(matrix);
             COL nbCols = (COL)MatrixTraits<MyMatrix>::columns(matrix);
 
-            OperProps::setArraySize(lpxloper_, nbRows, nbCols);
+            OperProps::setArraySize(lpxloper_, nbRows, nbCols, false);
 
             // get actual number of rows in case of truncation
             nbRows = OperProps::getRows(lpxloper_);
@@ -258,11 +446,11 @@ namespace xlw {
 
         //! MyArray ctor.
         XlfOper(const MyArray& values) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             RW nbRows = (RW)ArrayTraits<MyArray>::size(values);
 
-            OperProps::setArraySize(lpxloper_, nbRows, 1);
+            OperProps::setArraySize(lpxloper_, nbRows, 1, false);
 
             // get actual number of rows in case of truncation
             nbRows = OperProps::getRows(lpxloper_);
@@ -275,37 +463,37 @@ namespace xlw {
         }
         //!  string ctor.
         XlfOper(const std::string& value) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setString(lpxloper_, value);
         }
         //!  string ctor.
         XlfOper(const char* value) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setString(lpxloper_, value);
         }
         //!  wide string ctor.
         XlfOper(const wchar_t* value) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setWString(lpxloper_, value);
         }
         //!  wstring ctor.
         XlfOper(const std::wstring& value) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setWString(lpxloper_, value);
         }
         //!  XlfRef ctor.
         XlfOper(const XlfRef& value) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setRef(lpxloper_, value);
         }
         //! XlfMulti ctor.
         XlfOper(RW rows, COL cols) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             OperProps::setArraySize(lpxloper_, rows, cols);
         }
@@ -313,7 +501,7 @@ namespace xlw {
         //! Container ctor.
         template <class FwdIt>
         XlfOper(RW rows, COL cols, FwdIt start) :
-            lpxloper_(TempMemory::GetMemory<OperType>())
+            lpxloper_(TempMemory::GetMemory<OperType>()), values_(0), ownsOper_(true)
         {
             Set(rows, cols, start);
         }
@@ -452,6 +640,10 @@ namespace xlw {
         \endcode
         */
         //! Number of rows in matrix.
+        /*!
+        For a reference this is worked out from its bounds, without reading
+        the cells.
+        */
         MultiRowType rows() const
         {
             return OperProps::getRows(lpxloper_);
@@ -463,10 +655,34 @@ namespace xlw {
             return OperProps::getCols(lpxloper_);
         }
 
+        //! The cells, read in place without an XlfOper for each
+        /*!
+        A reference is coerced once, and a single value is a one by one
+        array. See XlfOperCells.h.
+        */
+        XlfOperCells Cells(const char* ErrorId = 0) const
+        {
+            LPXLOPER12 cells = values(ErrorId);
+            MultiRowType nbRows(OperProps::getRows(cells));
+            MultiColType nbCols(OperProps::getCols(cells));
+            if ((OperProps::getXlType(cells) & 0xFFF) == xltypeMulti)
+            {
+                return XlfOperCells(cells->val.array.lparray, nbRows, nbCols);
+            }
+            return XlfOperCells(cells, nbRows, nbCols);
+        }
+
+        //! Calls visitor(row, col, value) for each cell, row by row, see XlfOperCells.h
+        template<class Visitor>
+        void Visit(Visitor&& visitor, const char* ErrorId = 0) const
+        {
+            Cells(ErrorId).Visit(visitor);
+        }
+
         //! Function call operator, used here to subscript a two dimensional array.
         XlfOper operator()(MultiRowType row, MultiColType col)
         {
-            return XlfOper(OperProps::getElement(lpxloper_, row, col));
+            return XlfOper(OperProps::getElement(values(), row, col));
         }
 
         //! Set the value of array element with specified subscript.
@@ -780,6 +996,10 @@ namespace xlw {
 
         std::vector<double> AsDoubleVector(const char* ErrorId = 0, XlfOperImpl::DoubleVectorConvPolicy policy = XlfOperImpl::UniDimensional) const
         {
+            if (isReference())
+            {
+                return XlfOper(values(ErrorId)).AsDoubleVector(ErrorId, policy);
+            }
             std::vector<double> result;
             MultiRowType nbRows(OperProps::getRows(lpxloper_));
             MultiColType nbCols(OperProps::getCols(lpxloper_));
@@ -794,6 +1014,22 @@ namespace xlw {
 
             result.resize(nbRows * nbCols);
 
+            if ((OperProps::getXlType(lpxloper_) & 0xFFF) == xltypeMulti)
+            {
+                double* data = result.empty() ? 0 : &result[0];
+                if (policy == XlfOperImpl::RowMajor || isUniDimRange)
+                {
+                    auto store = [=](MultiRowType row, MultiColType col, double value) { data[row * nbCols + col] = value; };
+                    getDoubles(store, ErrorId);
+                }
+                else
+                {
+                    auto store = [=](MultiRowType row, MultiColType col, double value) { data[col * nbRows + row] = value; };
+                    getDoubles(store, ErrorId);
+                }
+                return result;
+            }
+
             for(MultiRowType row(0); row < nbRows; ++row)
             {
                 for(MultiRowType col(0); col < nbCols; ++col)
@@ -814,6 +1050,10 @@ namespace xlw {
 
         MyArray AsArray(const char* ErrorId = 0, XlfOperImpl::DoubleVectorConvPolicy policy = XlfOperImpl::UniDimensional) const
         {
+            if (isReference())
+            {
+                return XlfOper(values(ErrorId)).AsArray(ErrorId, policy);
+            }
             MultiRowType nbRows(OperProps::getRows(lpxloper_));
             MultiColType nbCols(OperProps::getCols(lpxloper_));
 
@@ -827,6 +1067,17 @@ namespace xlw {
 
             MyArray result(ArrayTraits<MyArray>::create(nbRows * nbCols));
 
+            if ((OperProps::getXlType(lpxloper_) & 0xFFF) == xltypeMulti)
+            {
+                bool rowMajor = policy == XlfOperImpl::RowMajor || isUniDimRange;
+                auto store = [&](MultiRowType row, MultiColType col, double value)
+                {
+                    ArrayTraits<MyArray>::setAt(result, rowMajor ? row * nbCols + col : col * nbRows + row, value);
+                };
+                getDoubles(store, ErrorId);
+                return result;
+            }
+
             for(MultiRowType row(0); row < nbRows; ++row)
             {
                 for(MultiRowType col(0); col < nbCols; ++col)
@@ -847,9 +1098,22 @@ namespace xlw {
 
         MyMatrix AsMatrix(const char* ErrorId = 0) const
         {
+            if (isReference())
+            {
+                return XlfOper(values(ErrorId)).AsMatrix(ErrorId);
+            }
             MultiRowType nbRows(OperProps::getRows(lpxloper_));
             MultiColType nbCols(OperProps::getCols(lpxloper_));
             MyMatrix result(MatrixTraits<MyMatrix>::create(nbRows, nbCols));
+            if ((OperProps::getXlType(lpxloper_) & 0xFFF) == xltypeMulti)
+            {
+                auto store = [&](MultiRowType row, MultiColType col, double value)
+                {
+                    MatrixTraits<MyMatrix>::setAt(result, row, col, value);
+                };
+                getDoubles(store, ErrorId);
+                return result;
+            }
             for(MultiRowType row(0); row < nbRows; ++row)
             {
                 for(MultiRowType col(0); col < nbCols; ++col)
@@ -863,6 +1127,10 @@ namespace xlw {
 
         CellMatrix AsCellMatrix(const char* ErrorId = 0) const
         {
+            if (isReference())
+            {
+                return XlfOper(values(ErrorId)).AsCellMatrix(ErrorId);
+            }
             if(IsMissing() || IsNil())
             {
                 CellMatrix result(1,1);
@@ -877,41 +1145,7 @@ namespace xlw {
             MultiRowType nbRows(OperProps::getRows(lpxloper_));
             MultiColType nbCols(OperProps::getCols(lpxloper_));
             CellMatrix result(nbRows, nbCols);
-            for(MultiRowType row(0); row < nbRows; ++row)
-            {
-                for(MultiRowType col(0); col < nbCols; ++col)
-                {
-                    XlfOper element(OperProps::getElement(lpxloper_, row, col));
-                    if(element.IsNumber())
-                    {
-                        result(row, col) = element.AsDouble(ErrorId);
-                    }
-                    else if(element.IsString())
-                    {
-                        result(row, col) = element.AsWstring(ErrorId);
-                    }
-                    else if(element.IsBool())
-                    {
-                        result(row, col) = element.AsBool(ErrorId);
-                    }
-                    else if(element.IsInt())
-                    {
-                        result(row, col) = element.AsInt(ErrorId);
-                    }
-                    else if(element.IsError())
-                    {
-						result(row, col) = CellValue::error_type(OperProps::getError(element.lpxloper_));
-                    }
-                    else if(element.IsNil())
-                    {
-                        ; // do nothing
-                    }
-                    else
-                    {
-                        THROW_XLW("Unsupported type in CellMatrix conversion");
-                    }
-                }
-            }
+            getCells(result.Impl(), ErrorId);
             return result;
         }
 
@@ -924,6 +1158,7 @@ namespace xlw {
         void Set(LPXLOPER12 lpxloper)
         {
             OperProps::copy(lpxloper, lpxloper_);
+            values_ = 0;
         }
         //! Set to a string.value
         void Set(const std::string& value)
@@ -972,23 +1207,31 @@ namespace xlw {
         }
         void Set(const CellMatrix& cells)
         {
-            XlfOper temp(cells);
-            std::swap(temp, *this);
+            Set(XlfOper(cells));
         }
         void Set(const MyMatrix& matrix)
         {
-            XlfOper temp(matrix);
-            std::swap(temp, *this);
+            Set(XlfOper(matrix));
         }
         void Set(const MyArray& values)
         {
-            XlfOper temp(values);
-            std::swap(temp, *this);
+            Set(XlfOper(values));
         }
         void Set(const XlfRef& range)
         {
-            XlfOper temp(range);
-            std::swap(temp, *this);
+            Set(XlfOper(range));
+        }
+        //! Takes the value of oper, without copying it when oper owns its XLOPER.
+        void Set(XlfOper&& oper)
+        {
+            *this = std::move(oper);
+        }
+        //! Exchanges the XLOPERs the two opers refer to, without copying either.
+        void swap(XlfOper& other)
+        {
+            std::swap(lpxloper_, other.lpxloper_);
+            std::swap(values_, other.values_);
+            std::swap(ownsOper_, other.ownsOper_);
         }
         //! Set to an error code
         void SetError(ErrorType errorCode)
@@ -1003,6 +1246,35 @@ namespace xlw {
         XlfOper& operator=(const XlfOper& rhs)
         {
             OperProps::copy(rhs.lpxloper_, lpxloper_);
+            values_ = rhs.values_;
+            return *this;
+        }
+
+        //! move assignment, takes the value without copying it
+        /*!
+        When this oper refers to memory it was given, such as the cell of an
+        array operator() returns, the value is written into that memory. A
+        value rhs doesn't own, or that Excel has to free, is copied as for
+        copy assignment.
+        */
+        XlfOper& operator=(XlfOper&& rhs)
+        {
+            if (this == &rhs || !rhs.ownsOper_ ||
+                (OperProps::getXlType(rhs.lpxloper_) & xlw::XlfOperImpl::xlbitFreeAuxMem))
+            {
+                return *this = static_cast<const XlfOper&>(rhs);
+            }
+            if (ownsOper_)
+            {
+                // rhs is left the old value, and frees it if need be
+                swap(rhs);
+                return *this;
+            }
+            // the value's own memory is in TempMemory, so only the XLOPER is copied
+            *lpxloper_ = *rhs.lpxloper_;
+            values_ = rhs.values_;
+            OperProps::setXlType(rhs.lpxloper_, xltypeMissing);
+            rhs.values_ = 0;
             return *this;
         }
 
@@ -1010,6 +1282,7 @@ namespace xlw {
         XlfOper& operator=(const LPXLOPER12 rhs)
         {
             OperProps::copy(rhs, lpxloper_);
+            values_ = 0;
             return *this;
         }
 
@@ -0,0 +1,269 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef XLF_OPER_BUILDER_H
+#define XLF_OPER_BUILDER_H
+
+/*!
+\file XlfOperBuilder.h
+\brief Building an array result a row at a time
+*/
+
+#include <xlw/XlfOper.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace xlw {
+
+    //! Writes cells straight into the xltypeMulti returned to Excel
+    /*!
+    For results whose size isn't known up front, such as the rows of a
+    query. Cells are added left to right and rows top to bottom, into
+    TempMemory laid out as Excel wants it, so there is no CellMatrix to
+    build and convert afterwards. The space doubles when it runs out.
+    Rows may be of different lengths; short ones are padded with empty
+    cells. Anything beyond Excel's grid is dropped.
+    \code
+    XlfOperBuilder table(3);
+    for (...)
+    {
+        table.Add(name);
+        table.Add(price);
+        table.Add(isLive);
+        table.EndRow();
+    }
+    return table.Finish();
+    \endcode
+    */
+    class XlfOperBuilder
+    {
+    public:
+        //! Starts with room for rows rows of columns cells; both grow as needed.
+        explicit XlfOperBuilder(COL columns = 1, RW rows = 16) :
+            Cells(0), CapacityRows(0), CapacityColumns(0), Row(0), Column(0), Width(0), Truncated(false)
+        {
+            reserve(std::min<RW>(std::max<RW>(rows, 1), maxRows), std::min<COL>(std::max<COL>(columns, 1), maxColumns));
+        }
+
+        //! \name Adding a cell to the current row
+        //@{
+        void Add(double value)
+        {
+            if (LPXLOPER12 cell = next())
+                XlfOperProperties::setDouble(cell, value);
+        }
+        void Add(int value)
+        {
+            if (LPXLOPER12 cell = next())
+                XlfOperProperties::setInt(cell, value);
+        }
+        void Add(unsigned long value)
+        {
+            Add(static_cast<double>(value));
+        }
+        void Add(bool value)
+        {
+            if (LPXLOPER12 cell = next())
+                XlfOperProperties::setBool(cell, value);
+        }
+        void Add(const char* value)
+        {
+            Add(value, std::strlen(value));
+        }
+        void Add(const std::string& value)
+        {
+            Add(value.data(), value.size());
+        }
+        void Add(const char* data, size_t length)
+        {
+            if (LPXLOPER12 cell = next())
+                XlfOperProperties::setString(cell, data, length);
+        }
+        void Add(const wchar_t* value)
+        {
+            Add(value, std::wcslen(value));
+        }
+        void Add(const std::wstring& value)
+        {
+            Add(value.data(), value.size());
+        }
+        void Add(const wchar_t* data, size_t length)
+        {
+            if (LPXLOPER12 cell = next())
+                XlfOperProperties::setWString(cell, data, length);
+        }
+        void AddError(int code)
+        {
+            if (LPXLOPER12 cell = next())
+                XlfOperProperties::setError(cell, code);
+        }
+        void AddEmpty()
+        {
+            if (LPXLOPER12 cell = next())
+                cell->xltype = xltypeNil;
+        }
+        //@}
+
+        //! Adds each value in [first, last) and ends the row.
+        template<class FwdIt>
+        void AddRow(FwdIt first, FwdIt last)
+        {
+            for (; first != last; ++first)
+                Add(*first);
+            EndRow();
+        }
+
+        //! Pads the current row with empty cells and starts the next.
+        void EndRow()
+        {
+            if (Row < maxRows)
+            {
+                grow(0);
+                LPXLOPER12 cell = rowStart(Row);
+                for (COL col = Column; col < CapacityColumns; ++col)
+                    cell[col].xltype = xltypeNil;
+            }
+            else
+            {
+                Truncated = true;
+            }
+            ++Row;
+            Column = 0;
+        }
+
+        //! Rows finished so far, whether or not they fit in Excel's grid.
+        RW rows() const { return Row; }
+
+        //! The array built, after ending any unfinished row.
+        /*!
+        The builder is left empty. An empty result is a missing value, as
+        for XlfOper(RW, COL).
+        */
+        XlfOper Finish()
+        {
+            if (Column > 0)
+                EndRow();
+            if (Truncated)
+                std::cerr << "Truncating result to " << maxRows << " rows and " << maxColumns << " columns" << std::endl;
+
+            RW rows = std::min<RW>(Row, maxRows);
+            XlfOper result;
+            if (rows > 0 && Width > 0)
+            {
+                // close up the unused columns reserved on the right
+                if (Width < CapacityColumns)
+                {
+                    for (RW row = 1; row < rows; ++row)
+                        std::memmove(Cells + static_cast<size_t>(row) * Width, rowStart(row), Width * sizeof(XLOPER12));
+                }
+                LPXLOPER12 array = TempMemory::GetMemory<XLOPER12>();
+                array->xltype = xltypeMulti;
+                array->val.array.lparray = Cells;
+                array->val.array.rows = rows;
+                array->val.array.columns = Width;
+                result = XlfOper(array);
+            }
+
+            Cells = 0;
+            CapacityRows = 0;
+            CapacityColumns = 0;
+            Row = 0;
+            Column = 0;
+            Width = 0;
+            Truncated = false;
+            return result;
+        }
+
+    private:
+        XlfOperBuilder(const XlfOperBuilder&);
+        XlfOperBuilder& operator=(const XlfOperBuilder&);
+
+        // Excel's grid
+        enum { maxRows = 1048576, maxColumns = 16384 };
+
+        LPXLOPER12 rowStart(RW row) const
+        {
+            return Cells + static_cast<size_t>(row) * CapacityColumns;
+        }
+
+        // where the next cell of the current row goes, 0 if it's off the grid
+        LPXLOPER12 next()
+        {
+            if (Row >= maxRows || Column >= maxColumns)
+            {
+                Truncated = true;
+                ++Column;
+                return 0;
+            }
+            grow(Column);
+            LPXLOPER12 cell = rowStart(Row) + Column;
+            ++Column;
+            Width = std::max(Width, Column);
+            return cell;
+        }
+
+        // makes room for cell column of the current row, doubling whichever
+        // dimension is short
+        void grow(COL column)
+        {
+            if (Row < CapacityRows && column < CapacityColumns)
+                return;
+            RW rows = std::max<RW>(CapacityRows, 16);
+            while (rows <= Row)
+                rows *= 2;
+            COL columns = std::max<COL>(CapacityColumns, 1);
+            while (columns <= column)
+                columns *= 2;
+            reserve(std::min<RW>(rows, maxRows), std::min<COL>(columns, maxColumns));
+        }
+
+        // moves what has been added so far into a rows by columns layout; the
+        // old space stays in TempMemory until the call ends
+        void reserve(RW rows, COL columns)
+        {
+            LPXLOPER12 cells = TempMemory::GetMemoryUninitialised<XLOPER12>(static_cast<size_t>(rows) * columns);
+            for (RW row = 0; row <= Row && row < CapacityRows; ++row)
+            {
+                COL used = row < Row ? CapacityColumns : std::min(Column, CapacityColumns);
+                LPXLOPER12 to = cells + static_cast<size_t>(row) * columns;
+                std::memcpy(to, rowStart(row), used * sizeof(XLOPER12));
+                // earlier rows are padded out to the new width
+                if (row < Row)
+                {
+                    for (COL col = used; col < columns; ++col)
+                        to[col].xltype = xltypeNil;
+                }
+            }
+            Cells = cells;
+            CapacityRows = rows;
+            CapacityColumns = columns;
+        }
+
+        LPXLOPER12 Cells;
+        RW CapacityRows;
+        COL CapacityColumns;
+        // the cell the next value goes in
+        RW Row;
+        COL Column;
+        // the longest row so far, within the grid
+        COL Width;
+        bool Truncated;
+    };
+
+}
+
+#endif // XLF_OPER_BUILDER_H
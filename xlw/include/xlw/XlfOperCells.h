@@ -0,0 +1,254 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef XLF_OPER_CELLS_H
+#define XLF_OPER_CELLS_H
+
+/*!
+\file XlfOperCells.h
+\brief Reading the cells of an XlfOper in place
+
+XlfOper::Cells() and XlfOper::Visit() walk the XLOPER12 array Excel
+passed, without making an XlfOper or allocating anything for each cell.
+A visitor is one object whose operator() is overloaded on the kinds of
+value, for example
+\code
+struct Sum
+{
+    double total = 0.0;
+    void operator()(RW, COL, double value) { total += value; }
+    void operator()(RW, COL, XlfStringView) {}
+    void operator()(RW, COL, bool) {}
+    void operator()(RW, COL, XlfErrorValue) {}
+    void operator()(RW, COL, XlfEmptyValue) {}
+};
+
+Sum sum;
+oper.Visit(sum);
+\endcode
+Everything read this way is only valid during the call.
+*/
+
+#include <xlw/xlcall32.h>
+#include <xlw/XlfException.h>
+#include <cstddef>
+#include <iterator>
+#include <string>
+
+namespace xlw {
+
+    //! The characters of an Excel string, read in place and not null terminated
+    class XlfStringView
+    {
+    public:
+        XlfStringView() : theData(0), Size(0) {}
+        XlfStringView(const wchar_t* data, size_t size) : theData(data), Size(size) {}
+
+        const wchar_t* data() const { return theData; }
+        size_t size() const { return Size; }
+        bool empty() const { return Size == 0; }
+        wchar_t operator[](size_t i) const { return theData[i]; }
+        const wchar_t* begin() const { return theData; }
+        const wchar_t* end() const { return theData + Size; }
+        //! A copy that outlives the call.
+        std::wstring str() const { return std::wstring(theData, Size); }
+
+    private:
+        const wchar_t* theData;
+        size_t Size;
+    };
+
+    //! An error cell, as seen by a visitor
+    struct XlfErrorValue
+    {
+        int code;
+    };
+
+    //! An empty or missing cell, as seen by a visitor
+    struct XlfEmptyValue
+    {
+    };
+
+    //! Calls visitor with the value of cell
+    /*!
+    Numbers and integers are passed as double, strings as XlfStringView,
+    booleans as bool, errors as XlfErrorValue and empty or missing cells as
+    XlfEmptyValue.
+    */
+    template<class Visitor>
+    void VisitValue(const XLOPER12& cell, Visitor& visitor)
+    {
+        switch (cell.xltype & 0xFFF)
+        {
+        case xltypeNum:
+            visitor(cell.val.num);
+            break;
+        case xltypeInt:
+            visitor(static_cast<double>(cell.val.w));
+            break;
+        case xltypeStr:
+            visitor(XlfStringView(cell.val.str + 1, static_cast<size_t>(cell.val.str[0])));
+            break;
+        case xltypeBool:
+            visitor(cell.val.xbool != 0);
+            break;
+        case xltypeErr:
+            {
+                XlfErrorValue error = { cell.val.err };
+                visitor(error);
+            }
+            break;
+        case xltypeNil:
+        case xltypeMissing:
+            visitor(XlfEmptyValue());
+            break;
+        default:
+            THROW_XLW("Unsupported type in cell visit");
+        }
+    }
+
+    //! A row or a column of cells, each stride cells after the last
+    class XlfOperSpan
+    {
+    public:
+        class const_iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef XLOPER12 value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const XLOPER12* pointer;
+            typedef const XLOPER12& reference;
+
+            const_iterator() : Cell(0), Stride(1) {}
+            const_iterator(const XLOPER12* cell, std::ptrdiff_t stride) : Cell(cell), Stride(stride) {}
+
+            reference operator*() const { return *Cell; }
+            pointer operator->() const { return Cell; }
+            const_iterator& operator++() { Cell += Stride; return *this; }
+            const_iterator operator++(int) { const_iterator result(*this); Cell += Stride; return result; }
+            bool operator==(const const_iterator& other) const { return Cell == other.Cell; }
+            bool operator!=(const const_iterator& other) const { return Cell != other.Cell; }
+
+        private:
+            const XLOPER12* Cell;
+            std::ptrdiff_t Stride;
+        };
+
+        XlfOperSpan() : theData(0), Size(0), Stride(1) {}
+        XlfOperSpan(const XLOPER12* data, size_t size, std::ptrdiff_t stride = 1)
+            : theData(data), Size(size), Stride(stride) {}
+
+        size_t size() const { return Size; }
+        std::ptrdiff_t stride() const { return Stride; }
+        const XLOPER12* data() const { return theData; }
+
+        const XLOPER12& operator[](size_t i) const
+        {
+#ifdef _DEBUG
+            if (i >= Size)
+                throw XlfOutOfBounds();
+#endif
+            return theData[static_cast<std::ptrdiff_t>(i) * Stride];
+        }
+
+        const_iterator begin() const { return const_iterator(theData, Stride); }
+        const_iterator end() const { return const_iterator(theData + static_cast<std::ptrdiff_t>(Size) * Stride, Stride); }
+
+        //! Calls visitor(i, value) for each cell in turn.
+        template<class Visitor>
+        void Visit(Visitor&& visitor) const
+        {
+            const XLOPER12* cell = theData;
+            for (size_t i = 0; i < Size; ++i, cell += Stride)
+            {
+                auto call = [&](auto value) { visitor(i, value); };
+                VisitValue(*cell, call);
+            }
+        }
+
+    private:
+        const XLOPER12* theData;
+        size_t Size;
+        std::ptrdiff_t Stride;
+    };
+
+    //! The cells of an array, row by row, as Excel laid them out
+    class XlfOperCells
+    {
+    public:
+        XlfOperCells() : theData(0), Rows(0), Columns(0) {}
+        XlfOperCells(const XLOPER12* data, RW rows, COL columns) : theData(data), Rows(rows), Columns(columns) {}
+
+        RW rows() const { return Rows; }
+        COL columns() const { return Columns; }
+        size_t size() const { return static_cast<size_t>(Rows) * static_cast<size_t>(Columns); }
+        //! Cell (0, 0); the others follow row by row.
+        const XLOPER12* data() const { return theData; }
+
+        const XLOPER12& operator()(RW row, COL col) const
+        {
+#ifdef _DEBUG
+            if (row < 0 || row >= Rows || col < 0 || col >= Columns)
+                throw XlfOutOfBounds();
+#endif
+            return theData[static_cast<size_t>(row) * Columns + col];
+        }
+
+        XlfOperSpan Row(RW row) const
+        {
+#ifdef _DEBUG
+            if (row < 0 || row >= Rows)
+                throw XlfOutOfBounds();
+#endif
+            return XlfOperSpan(theData + static_cast<size_t>(row) * Columns, Columns);
+        }
+
+        XlfOperSpan Column(COL col) const
+        {
+#ifdef _DEBUG
+            if (col < 0 || col >= Columns)
+                throw XlfOutOfBounds();
+#endif
+            return XlfOperSpan(theData + col, Rows, Columns);
+        }
+
+        //! Every cell, row by row.
+        XlfOperSpan All() const { return XlfOperSpan(theData, size()); }
+
+        //! Calls visitor(row, col, value) for each cell, row by row.
+        template<class Visitor>
+        void Visit(Visitor&& visitor) const
+        {
+            const XLOPER12* cell = theData;
+            for (RW row = 0; row < Rows; ++row)
+            {
+                for (COL col = 0; col < Columns; ++col, ++cell)
+                {
+                    auto call = [&](auto value) { visitor(row, col, value); };
+                    VisitValue(*cell, call);
+                }
+            }
+        }
+
+    private:
+        const XLOPER12* theData;
+        RW Rows;
+        COL Columns;
+    };
+
+}
+
+#endif // XLF_OPER_CELLS_H
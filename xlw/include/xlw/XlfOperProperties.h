@@ -19,6 +19,8 @@
 #include <xlw/XlfRef.h>
 #include <xlw/XlfException.h>
 #include <string>
+#include <cstring>
+#include <algorithm>
 
 
 #ifndef  XLFOPERPROPERTIES
@@ -93,13 +95,19 @@ namespace xlw {
                 break;
 
             case xltypeRef:
-                if(oper->val.mref.lpmref->count == 1)
-                {
-                    return oper->val.mref.lpmref->reftbl[0].rwLast - oper->val.mref.lpmref->reftbl[0].rwFirst + 1;
-                }
-                else
                 {
-                    THROW_XLW("No implementation for multiple Refs");
+                    // the areas are stacked one above the other, as coerceToMulti does
+                    const XLMREF12& areas(*oper->val.mref.lpmref);
+                    size_t rows(0);
+                    for (WORD i(0); i < areas.count; ++i)
+                    {
+                        rows += areas.reftbl[i].rwLast - areas.reftbl[i].rwFirst + 1;
+                    }
+                    if (rows > 1048576)
+                    {
+                        THROW_XLW("Too many rows in multiple area reference");
+                    }
+                    return static_cast<RW>(rows);
                 }
                 break;
 
@@ -120,7 +128,8 @@ namespace xlw {
             }
             THROW_XLW("No implementation on XlfOper rows");
         }
-        static void setArraySize(LPXLOPER12 oper, RW rows, COL cols)
+        //! Pass initialiseElements as false only when every element will be overwritten
+        static void setArraySize(LPXLOPER12 oper, RW rows, COL cols, bool initialiseElements = true)
         {
             if(rows > 0 && cols > 0)
             {
@@ -135,7 +144,9 @@ namespace xlw {
                     rows = 1048576;
                 }
 
-                oper->val.array.lparray = TempMemory::GetMemory<XLOPER12>((size_t)rows * (size_t)cols);
+                oper->val.array.lparray = initialiseElements ?
+                    TempMemory::GetMemory<XLOPER12>((size_t)rows * (size_t)cols) :
+                    TempMemory::GetMemoryUninitialised<XLOPER12>((size_t)rows * (size_t)cols);
                 oper->val.array.rows = rows;
                 oper->val.array.columns = cols;
                 oper->xltype = xltypeMulti;
@@ -158,13 +169,15 @@ namespace xlw {
                 break;
 
             case xltypeRef:
-                if(oper->val.mref.lpmref->count == 1)
                 {
-                    return oper->val.mref.lpmref->reftbl[0].colLast - oper->val.mref.lpmref->reftbl[0].colFirst +1;
-                }
-                else
-                {
-                    THROW_XLW("No implementation for multiple Refs");
+                    // as wide as the widest area
+                    const XLMREF12& areas(*oper->val.mref.lpmref);
+                    COL cols(0);
+                    for (WORD i(0); i < areas.count; ++i)
+                    {
+                        cols = std::max(cols, areas.reftbl[i].colLast - areas.reftbl[i].colFirst + 1);
+                    }
+                    return cols;
                 }
                 break;
 
@@ -202,7 +215,7 @@ namespace xlw {
 
             case xltypeSRef:
                 {
-                    LPXLOPER12 result = TempMemory::GetMemory<XLOPER12>();
+                    LPXLOPER12 result = TempMemory::GetMemoryUninitialised<XLOPER12>();
                     *result = *oper;
                     result->val.sref.ref.rwFirst += row;
                     result->val.sref.ref.rwLast = result->val.sref.ref.rwFirst;
@@ -220,6 +233,7 @@ namespace xlw {
                     result->val.mref.idSheet = oper->val.mref.idSheet;
                     result->val.mref.lpmref = TempMemory::GetMemory<XLMREF12>();
                     result->val.mref.lpmref->count = 1;
+                    result->val.mref.lpmref->reftbl[0] = oper->val.mref.lpmref->reftbl[0];
                     result->val.mref.lpmref->reftbl[0].rwFirst += row;
                     result->val.mref.lpmref->reftbl[0].rwLast = result->val.mref.lpmref->reftbl[0].rwFirst;
                     result->val.mref.lpmref->reftbl[0].colFirst += column;
@@ -262,6 +276,22 @@ namespace xlw {
             oper->val.str = PascalStringConversions::WStringToWPascalString(newValue);
             oper->xltype = xltypeStr;
         }
+        static void setString(LPXLOPER12 oper, const char* data, size_t length)
+        {
+            oper->val.str = PascalStringConversions::StringToWPascalString(data, length);
+            oper->xltype = xltypeStr;
+        }
+        static void setWString(LPXLOPER12 oper, const wchar_t* data, size_t length)
+        {
+            oper->val.str = PascalStringConversions::WStringToWPascalString(data, length);
+            oper->xltype = xltypeStr;
+        }
+        //! points oper at an Excel string kept alive by someone else, such as TempMemory
+        static void setPascalString(LPXLOPER12 oper, wchar_t* pascalString)
+        {
+            oper->val.str = pascalString;
+            oper->xltype = xltypeStr;
+        }
         static XlfRef getRef(LPXLOPER12 oper)
         {
             const XLREF12& ref = oper->val.mref.lpmref->reftbl[0];
@@ -279,7 +309,7 @@ namespace xlw {
             {
                 XlfExcel::Instance().Call12(xlSheetId, oper, 0);
             }
-            XLMREF12* pmRef = TempMemory::GetMemory<XLMREF12>();
+            XLMREF12* pmRef = TempMemory::GetMemoryUninitialised<XLMREF12>();
             pmRef->count=1;
             pmRef->reftbl[0].rwFirst = newValue.GetRowBegin();
             pmRef->reftbl[0].rwLast = newValue.GetRowEnd()-1;
@@ -294,6 +324,71 @@ namespace xlw {
             typeOper.xltype = xltypeInt;
             return XlfExcel::Instance().Call12(xlCoerce, toOper, 2, fromOper, &typeOper);
         }
+        //! The values of a reference as an xltypeMulti in TempMemory
+        /*!
+        One xlCoerce for each area rather than one for each cell. The areas of
+        a multiple area reference are stacked one above the other, narrower
+        ones padded on the right with empty cells.
+        */
+        static int coerceToMulti(LPXLOPER12 reference, LPXLOPER12 result)
+        {
+            if ((reference->xltype & 0xFFF) == xltypeSRef || reference->val.mref.lpmref->count == 1)
+            {
+                return coerceArea(reference, result);
+            }
+
+            const XLMREF12& areas(*reference->val.mref.lpmref);
+            size_t rows(0);
+            COL cols(0);
+            for (WORD i(0); i < areas.count; ++i)
+            {
+                rows += areas.reftbl[i].rwLast - areas.reftbl[i].rwFirst + 1;
+                cols = std::max(cols, areas.reftbl[i].colLast - areas.reftbl[i].colFirst + 1);
+            }
+            if (rows > 1048576)
+            {
+                THROW_XLW("Too many rows in multiple area reference");
+            }
+            setArraySize(result, static_cast<RW>(rows), cols, false);
+
+            LPXLOPER12 destination = result->val.array.lparray;
+            for (WORD i(0); i < areas.count; ++i)
+            {
+                XLMREF12 single;
+                single.count = 1;
+                single.reftbl[0] = areas.reftbl[i];
+                XLOPER12 area;
+                area.xltype = xltypeRef;
+                area.val.mref.idSheet = reference->val.mref.idSheet;
+                area.val.mref.lpmref = &single;
+
+                XLOPER12 values;
+                values.xltype = xltypeNil;
+                int xlret = coerceArea(&area, &values);
+                if (xlret != xlretSuccess)
+                {
+                    return xlret;
+                }
+                if ((values.xltype & 0xFFF) != xltypeMulti)
+                {
+                    return xlretInvXloper;
+                }
+                // the elements are already in TempMemory, so a shallow copy will do
+                for (RW row(0); row < values.val.array.rows; ++row)
+                {
+                    COL col(0);
+                    for (; col < values.val.array.columns; ++col)
+                    {
+                        *destination++ = values.val.array.lparray[row * values.val.array.columns + col];
+                    }
+                    for (; col < cols; ++col)
+                    {
+                        (destination++)->xltype = xltypeNil;
+                    }
+                }
+            }
+            return xlretSuccess;
+        }
         static void XlFree(LPXLOPER12 oper)
         {
             XlfExcel::Instance().Call12(xlFree, 0, 1, oper);
@@ -305,7 +400,7 @@ namespace xlw {
                 case xltypeMulti:
                     // need to do a deep copy of each element
                     toOper->xltype = xltypeMulti;
-                    toOper->val.array.lparray = TempMemory::GetMemory<XLOPER12>(fromOper->val.array.rows * fromOper->val.array.columns);
+                    toOper->val.array.lparray = TempMemory::GetMemoryUninitialised<XLOPER12>((size_t)fromOper->val.array.rows * (size_t)fromOper->val.array.columns);
                     for(size_t item(0) ; item < (size_t)(fromOper->val.array.rows * fromOper->val.array.columns); ++item)
                     {
                         copy(fromOper->val.array.lparray + item, toOper->val.array.lparray + item);
@@ -318,7 +413,7 @@ namespace xlw {
                         toOper->xltype = xltypeRef;
                         toOper->val.mref.idSheet = fromOper->val.mref.idSheet;
                         size_t bytes(sizeof(XLMREF12) + (fromOper->val.mref.lpmref->count - 1) * sizeof(XLREF12));
-                        toOper->val.mref.lpmref = (XLMREF12*)TempMemory::GetMemory<BYTE>(bytes);
+                        toOper->val.mref.lpmref = (XLMREF12*)TempMemory::GetMemoryUninitialised<BYTE>(bytes);
                         memcpy(toOper->val.mref.lpmref, fromOper->val.mref.lpmref, bytes);
                     }
                     break;
@@ -345,7 +440,7 @@ namespace xlw {
                     toOper->val.array.lparray = TempMemory::GetMemoryUsingNew<XLOPER12>((size_t)fromOper->val.array.rows * (size_t)fromOper->val.array.columns);
                     for(size_t item(0) ; item < ((size_t)fromOper->val.array.rows * (size_t)fromOper->val.array.columns); ++item)
                     {
-                        copyUsingNew(toOper->val.array.lparray + item, toOper->val.array.lparray + item);
+                        copyUsingNew(fromOper->val.array.lparray + item, toOper->val.array.lparray + item);
                     }
                     toOper->val.array.rows = fromOper->val.array.rows;
                     toOper->val.array.columns = fromOper->val.array.columns;
@@ -369,6 +464,18 @@ namespace xlw {
                     break;
             }
         }
+        // coerces a single area to an xltypeMulti and moves it into TempMemory
+        static int coerceArea(LPXLOPER12 reference, LPXLOPER12 result)
+        {
+            XLOPER12 excelValues;
+            int xlret = coerce(reference, xltypeMulti, &excelValues);
+            if (xlret == xlretSuccess)
+            {
+                copy(&excelValues, result);
+                XlFree(&excelValues);
+            }
+            return xlret;
+        }
         static void freeCreatedUsingNew(LPXLOPER12 oper)
         {
             switch(oper->xltype & 0xFFF)
@@ -0,0 +1,163 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef INC_XlfProfiler_H
+#define INC_XlfProfiler_H
+
+/*!
+\file XlfProfiler.h
+\brief Counting and timing the calls of each function
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+namespace xlw {
+
+    //! Where the time of one function's calls goes
+    /*!
+    Every generated wrapper has one, and times each call with a Call,
+    splitting it into the conversion of the arguments, the function itself
+    and the marshalling of its result. The times go into log-linear
+    histograms, with four buckets for each power of two nanoseconds, so
+    percentiles are within a quarter of the true value.
+
+    Each thread counts into its own blocks, written without locked
+    instructions, and GetStatistics adds up the blocks of every thread.
+    */
+    class XlfProfiler
+    {
+    public:
+        enum Phase { Conversion, Function, Marshalling, phaseCount };
+
+        //! The counts of one thread, defined in XlfProfiler.cpp
+        struct Counters;
+
+        //! Call times in nanoseconds
+        class Histogram
+        {
+        public:
+            enum { subBuckets = 4, bucketCount = 176 };
+
+            Histogram();
+            //! The bucket holding nanoseconds, the last one taking everything longer.
+            static size_t Bucket(unsigned long long nanoseconds);
+            //! The shortest time in bucket.
+            static unsigned long long LowerBound(size_t bucket);
+
+            unsigned long long Count() const;
+            //! Seconds, 0 when nothing has been counted.
+            double Mean() const;
+            //! Seconds below which the fraction of the calls fall, taken from the middle of its bucket.
+            double Percentile(double fraction) const;
+            double Max() const;
+
+            unsigned long long counts[bucketCount];
+            unsigned long long totalNanoseconds;
+            unsigned long long maxNanoseconds;
+        };
+
+        //! Counters for one function, over every thread
+        struct Statistics
+        {
+            //! Calls that returned a result, including those that hit a cache.
+            unsigned long long calls;
+            //! Calls ended by an exception.
+            unsigned long long exceptions;
+            //! TempMemory handed out during the calls.
+            unsigned long long bytes;
+            Histogram phases[phaseCount];
+        };
+
+        //! Times one call, from construction until Finished
+        /*!
+        A phase that isn't marked takes no time, so a call that is answered
+        from a cache is all marshalling. A call destroyed before Finished
+        counts as an exception.
+        */
+        class Call
+        {
+        public:
+            explicit Call(XlfProfiler& profiler);
+            ~Call();
+
+            void Converted();
+            void Called();
+            void Finished();
+            //! Finished, passing on what is being returned.
+            template<class T>
+            T&& Returned(T&& value)
+            {
+                Finished();
+                return std::forward<T>(value);
+            }
+
+        private:
+            Call(const Call&);
+            Call& operator=(const Call&);
+
+            Counters* Counters_;
+            unsigned long long Start;
+            unsigned long long Converted_;
+            unsigned long long Called_;
+            unsigned long long Bytes;
+        };
+
+        //! Profiles functionName, which is how it shows in the results.
+        explicit XlfProfiler(const std::string& functionName);
+        ~XlfProfiler();
+
+        Statistics GetStatistics() const;
+        const std::string& FunctionName() const { return Name; }
+
+        //! \name Every profiler in the add-in
+        //@{
+        static std::vector<XlfProfiler*> Profilers();
+        //! Turns timing on or off for every function, it is on to start with.
+        static void SetEnabled(bool enabled);
+        static bool IsEnabled();
+        //! Writes the statistics of the functions that have been called, then their histograms, as CSV.
+        static void Dump(std::ostream& out);
+        //! The phase as it is named in the results.
+        static const char* PhaseName(Phase phase);
+        //@}
+
+    private:
+        XlfProfiler(const XlfProfiler&);
+        XlfProfiler& operator=(const XlfProfiler&);
+
+        //! The counters of the calling thread, made on its first call.
+        Counters* threadCounters();
+
+        std::string Name;
+        //! Where the thread's counters are found in each thread's table.
+        size_t Slot;
+        mutable std::mutex Mutex;
+        std::vector<std::unique_ptr<Counters> > Threads;
+    };
+
+}
+
+#endif
@@ -0,0 +1,155 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef INC_XlfResultCache_H
+#define INC_XlfResultCache_H
+
+/*!
+\file XlfResultCache.h
+\brief Remembering the results of pure functions
+*/
+
+#include <xlw/xlcall32.h>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+namespace xlw {
+
+    //! The last results of one function, by the values of its arguments
+    /*!
+    Made for each function declared with <xlw:cache, whose generated
+    wrapper builds a Key from the arguments as Excel passed them and
+    returns a copy of the stored result when there is one, without
+    calling the function. Only functions whose result depends on nothing
+    but their arguments should be cached.
+
+    Entries are spread over shards, each with its own lock. Once the entries
+    take more than the budget, the least recently used of the shard being
+    stored into are dropped, then those of the other shards, so a single
+    result may use the whole budget.
+    */
+    class XlfResultCache
+    {
+    public:
+        //! The values of a call's arguments, in a form that can be compared
+        class Key
+        {
+        public:
+            Key();
+
+            //! \name Adding the next argument
+            //@{
+            void Add(double value);
+            void Add(int value);
+            void Add(short value);
+            //! A counted string, as passed for D%
+            void Add(const XCHAR* value);
+            void Add(const FP12* value);
+            //! References make the call uncacheable, as the cells they name can change.
+            void Add(const XLOPER12* value);
+            //@}
+
+            //! False when an argument can't be compared by value.
+            bool IsCacheable() const { return Cacheable; }
+            unsigned long long Hash() const;
+            const std::string& Bytes() const { return Data; }
+
+        private:
+            void addOper(const XLOPER12& value);
+
+            std::string Data;
+            bool Cacheable;
+        };
+
+        //! Counters for one cache
+        struct Statistics
+        {
+            unsigned long long hits;
+            unsigned long long misses;
+            unsigned long long evictions;
+            //! Results that weren't stored because they are bigger than the whole budget.
+            unsigned long long skipped;
+            size_t entries;
+            size_t bytes;
+            size_t budget;
+        };
+
+        //! A cache for functionName that may hold up to budget bytes.
+        XlfResultCache(const std::string& functionName, size_t budget);
+        ~XlfResultCache();
+
+        //! \name Looking up and storing results
+        /*!
+        Find gives a copy of the stored result in TempMemory, so it can be
+        returned to Excel as it is.
+        */
+        //@{
+        bool Find(const Key& key, LPXLOPER12& result);
+        bool Find(const Key& key, FP12*& result);
+        //! Stores a copy of result; references and results bigger than the budget aren't kept.
+        void Insert(const Key& key, const XLOPER12* result);
+        void Insert(const Key& key, const FP12* result);
+        //@}
+
+        //! Drops every entry.
+        void Flush();
+        //! Changes the budget, dropping entries that no longer fit.
+        void SetBudget(size_t budget);
+        Statistics GetStatistics() const;
+        const std::string& FunctionName() const { return Name; }
+
+        //! \name Every cache in the add-in
+        //@{
+        //! The cache of functionName, 0 if it has none.
+        static XlfResultCache* ForFunction(const std::string& functionName);
+        static std::vector<XlfResultCache*> Caches();
+        static void FlushAll();
+        //@}
+
+    private:
+        XlfResultCache(const XlfResultCache&);
+        XlfResultCache& operator=(const XlfResultCache&);
+
+        struct Shard;
+        enum { shardCount = 16 };
+
+        Shard& shardFor(unsigned long long hash) const;
+        // a copy in TempMemory of what is stored for key, 0 if nothing is
+        char* find(const Key& key, bool isArray);
+        void insert(const Key& key, bool isArray, std::string& stored);
+        // evicts from every shard but skip until the entries fit the budget
+        void trim(const Shard* skip);
+
+        std::string Name;
+        std::atomic<size_t> Budget;
+        std::atomic<unsigned long long> Hits;
+        std::atomic<unsigned long long> Misses;
+        std::atomic<unsigned long long> Evictions;
+        std::atomic<unsigned long long> Skipped;
+        //! What the entries of every shard take.
+        std::atomic<size_t> Bytes;
+        std::unique_ptr<Shard[]> Shards;
+    };
+
+}
+
+#endif
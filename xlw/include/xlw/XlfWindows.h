@@ -17,6 +17,8 @@
 #ifndef INC_XlfWindows_H
 #define INC_XlfWindows_H
 
+#if defined(_WIN32)
+
 // put on seat belts
 #ifndef STRICT
 #define STRICT
@@ -48,4 +50,41 @@
 
 #include <windows.h>
 
+#else
+
+// Outside Windows we only need the handful of Win32 types used by
+// the Excel SDK header and the portable core, so the core can be
+// built against an in-process host.
+
+#include <cstddef>
+#include <cstdint>
+
+#define pascal
+#define PASCAL
+#define _cdecl
+#define CALLBACK
+#define FAR
+#define VOID void
+
+typedef int32_t INT32;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef uintptr_t DWORD_PTR;
+typedef wchar_t WCHAR;
+typedef char* LPSTR;
+typedef const char* LPCSTR;
+typedef void* HANDLE;
+typedef void* HWND;
+typedef void* HINSTANCE;
+typedef void* HMODULE;
+
+typedef struct tagPOINT
+{
+    long x;
+    long y;
+} POINT;
+
+#endif
+
 #endif
@@ -38,7 +38,11 @@
 /*!
 Export macro that tells the compiler that the function is to be exported.
 */
+#if defined(_WIN32)
 #define EXCEL_EXPORT __declspec(dllexport)
+#else
+#define EXCEL_EXPORT __attribute__((visibility("default")))
+#endif
 
 //! Initialization macro
 /*!
@@ -146,6 +150,34 @@ return 1;
     return 0; \
 } \
 
+//! Cleanup macro for function modifying an FP12 argument in place, with return type void
+/*! Excel takes the argument as the result whatever happens, so errors can't
+    be reported and the array is left as the function left it.
+*/
+#define EXCEL_END_VOID \
+} catch (...) { \
+    return; \
+}
+
+//! Cleanup macro for the synchronous part of an asynchronous function, with return type void
+/*! Excel waits for a result for every handle it gives out, so errors are
+    returned through the handle as EXCEL_END would return them.
+*/
+#define EXCEL_END_ASYNC(handle) \
+} catch (XlfException&) { \
+    XlfAsync::Return(handle, XlfOper::Error(xlerrNum)); \
+} catch (std::exception& error){\
+    XlfAsync::Return(handle, XlfOper(error.what()));\
+} catch (std::string& error){\
+    XlfAsync::Return(handle, XlfOper(error));\
+} catch (const char* error){\
+    XlfAsync::Return(handle, XlfOper(error));\
+} catch (const CellMatrix& error){\
+    XlfAsync::Return(handle, XlfOper(error));\
+} catch (...) { \
+    XlfAsync::Return(handle, XlfOper::Error(xlerrValue)); \
+}
+
 //@}
 #endif
 
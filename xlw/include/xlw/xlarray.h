@@ -20,8 +20,11 @@
 
 #include "xlcall32.h"
 #include "xlw/MyContainers.h"
-#include <xlw/xlfExcel.h>
+#include <xlw/FpMatrixView.h>
+#include <xlw/XlfExcel.h>
 #include <xlw/TempMemory.h>
+#include <xlw/XlfException.h>
+#include <iostream>
 
 namespace xlw {
 
@@ -54,6 +57,29 @@ namespace xlw {
         return result;
     }
 
+    //! convert an incoming excel row or column into our array type
+    inline MyArray GetArray(LPXLARRAY input, const char* ErrorId)
+    {
+        size_t rows = input->rows;
+        size_t cols = input->columns;
+        if (rows != 1 && cols != 1)
+            THROW_XLW(ErrorId << " is not a single row or column");
+
+        size_t size = rows * cols;
+        MyArray result(ArrayTraits<MyArray>::create(size));
+        for (size_t i = 0; i < size; ++i)
+        {
+            ArrayTraits<MyArray>::setAt(result, i, input->array[i]);
+        }
+        return result;
+    }
+
+    //! view an incoming excel array in place, without copying it
+    inline FpMatrixView GetMatrixView(LPXLARRAY input)
+    {
+        return FpMatrixView(input);
+    }
+
     inline void extractArrayInfo(const LPXLARRAY input, int& rows, int& cols, double*& arrayData)
     {
 
@@ -63,17 +89,72 @@ namespace xlw {
 
     }
 
+    //! allocates an FP12 in temporary memory, the caller must fill every element of arrayData
     inline LPXLARRAY createTempFpArray(int rows, int cols, double*& arrayData)
     {
         LPXLARRAY result = 0;
 
-        result = (LPXLARRAY)TempMemory::GetMemory<BYTE>(sizeof(FP12) + (rows * cols - 1) * sizeof(double));
+        result = (LPXLARRAY)TempMemory::GetMemoryUninitialised<BYTE>(sizeof(FP12) + ((size_t)rows * (size_t)cols - 1) * sizeof(double));
         result->rows = rows;
         result->columns = cols;
         arrayData = result->array;
 
         return result;
     }
+
+    //! limits the size of an FP12 to a worksheet, as XlfOper does for arrays
+    inline void truncateFpArraySize(size_t& rows, size_t& cols)
+    {
+        if (cols > 16384)
+        {
+            std::cerr << "Truncating columns to 16384" << std::endl;
+            cols = 16384;
+        }
+        if (rows > 1048576)
+        {
+            std::cerr << "Truncating rows to 1048576" << std::endl;
+            rows = 1048576;
+        }
+    }
+
+    //! copies a matrix into an FP12 in temporary memory, to return to excel as K%
+    inline LPXLARRAY createTempFpArray(const MyMatrix& values)
+    {
+        size_t rows = MatrixTraits<MyMatrix>::rows(values);
+        size_t cols = MatrixTraits<MyMatrix>::columns(values);
+        if (rows == 0 || cols == 0)
+            THROW_XLW("An empty matrix can't be returned as an FP12");
+
+        truncateFpArraySize(rows, cols);
+        double* arrayData;
+        LPXLARRAY result = createTempFpArray(static_cast<int>(rows), static_cast<int>(cols), arrayData);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t j = 0; j < cols; ++j)
+            {
+                *arrayData++ = MatrixTraits<MyMatrix>::getAt(values, i, j);
+            }
+        }
+        return result;
+    }
+
+    //! copies an array into a one column FP12 in temporary memory, to return to excel as K%
+    inline LPXLARRAY createTempFpArray(const MyArray& values)
+    {
+        size_t size = ArrayTraits<MyArray>::size(values);
+        if (size == 0)
+            THROW_XLW("An empty array can't be returned as an FP12");
+
+        size_t cols = 1;
+        truncateFpArraySize(size, cols);
+        double* arrayData;
+        LPXLARRAY result = createTempFpArray(static_cast<int>(size), 1, arrayData);
+        for (size_t i = 0; i < size; ++i)
+        {
+            arrayData[i] = ArrayTraits<MyArray>::getAt(values, i);
+        }
+        return result;
+    }
 }
 
 #endif
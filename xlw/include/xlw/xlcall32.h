@@ -308,6 +308,10 @@ int pascal Excel12v(int xlfn, LPXLOPER12 operRes, int count, const LPXLOPER12 op
 #define xlEventRegister    (17 | xlSpecial)
 #define xlRunningOnCluster (18 | xlSpecial)
 
+/* xlEventRegister events */
+#define xleventCalculationEnded      1    /* Fires at the end of calculation */
+#define xleventCalculationCanceled   2    /* Fires when calculation is interrupted */
+
 /* edit modes */
 #define xlModeReady    0    // not in edit mode
 #define xlModeEnter    1    // enter mode
@@ -46,6 +46,9 @@
 #        pragma comment (linker, "/export:_xlAutoOpen")
 #        pragma comment (linker, "/export:_xlAutoClose")
 #        pragma comment (linker, "/export:_xlAutoRemove")
+#        pragma comment (linker, "/export:_xlwTempMemoryStatistics")
+#        pragma comment (linker, "/export:_xlwProfile")
+#        pragma comment (linker, "/export:_xlwProfileDump")
 #        ifndef NDEBUG
 #            pragma comment (linker, "/export:_xlwGenDoc")
 #        endif
@@ -53,6 +56,9 @@
 #        pragma comment (linker, "/export:xlAutoOpen")
 #        pragma comment (linker, "/export:xlAutoClose")
 #        pragma comment (linker, "/export:xlAutoRemove")
+#        pragma comment (linker, "/export:xlwTempMemoryStatistics")
+#        pragma comment (linker, "/export:xlwProfile")
+#        pragma comment (linker, "/export:xlwProfileDump")
 #        ifndef NDEBUG
 #            pragma comment (linker, "/export:xlwGenDoc")
 #        endif
@@ -0,0 +1,239 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include <xlw/AsciiConversions.h>
+#include <cstring>
+
+#if !defined(XLW_NO_SIMD)
+#if defined(__AVX2__)
+#define XLW_ASCII_AVX2
+#define XLW_ASCII_SSE2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XLW_ASCII_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+// Each stage converts whole blocks from i onwards and returns where it
+// stopped, at the end or at a block with a character that isn't ASCII, so
+// the next, narrower stage can carry on from there.
+namespace
+{
+    bool isAscii(wchar_t c)
+    {
+        // wchar_t is signed on some platforms
+        return static_cast<unsigned long>(c) < 0x80;
+    }
+
+#if defined(XLW_ASCII_AVX2)
+    size_t widenAvx2(const char* source, size_t i, size_t n, wchar_t* destination)
+    {
+        for (; i + 32 <= n; i += 32)
+        {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+            if (_mm256_movemask_epi8(bytes))
+                break;
+            __m128i low = _mm256_castsi256_si128(bytes);
+            __m128i high = _mm256_extracti128_si256(bytes, 1);
+            __m256i* out = reinterpret_cast<__m256i*>(destination + i);
+            if (sizeof(wchar_t) == 2)
+            {
+                _mm256_storeu_si256(out, _mm256_cvtepu8_epi16(low));
+                _mm256_storeu_si256(out + 1, _mm256_cvtepu8_epi16(high));
+            }
+            else
+            {
+                _mm256_storeu_si256(out, _mm256_cvtepu8_epi32(low));
+                _mm256_storeu_si256(out + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+                _mm256_storeu_si256(out + 2, _mm256_cvtepu8_epi32(high));
+                _mm256_storeu_si256(out + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+            }
+        }
+        return i;
+    }
+
+    size_t narrowAvx2(const wchar_t* source, size_t i, size_t n, char* destination)
+    {
+        const __m256i* in = reinterpret_cast<const __m256i*>(source + i);
+        if (sizeof(wchar_t) == 2)
+        {
+            const __m256i notAscii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+            for (; i + 32 <= n; i += 32, in += 2)
+            {
+                __m256i a = _mm256_loadu_si256(in);
+                __m256i b = _mm256_loadu_si256(in + 1);
+                if (!_mm256_testz_si256(_mm256_or_si256(a, b), notAscii))
+                    break;
+                // packing works within each 128 bit lane, so put the quarters back in order
+                __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), packed);
+            }
+        }
+        else
+        {
+            const __m256i notAscii = _mm256_set1_epi32(static_cast<int>(0xFFFFFF80));
+            const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+            for (; i + 32 <= n; i += 32, in += 4)
+            {
+                __m256i a = _mm256_loadu_si256(in);
+                __m256i b = _mm256_loadu_si256(in + 1);
+                __m256i c = _mm256_loadu_si256(in + 2);
+                __m256i d = _mm256_loadu_si256(in + 3);
+                if (!_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d)), notAscii))
+                    break;
+                __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_permutevar8x32_epi32(packed, order));
+            }
+        }
+        return i;
+    }
+#endif
+
+#if defined(XLW_ASCII_SSE2)
+    size_t widenSse2(const char* source, size_t i, size_t n, wchar_t* destination)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            if (_mm_movemask_epi8(bytes))
+                break;
+            __m128i low = _mm_unpacklo_epi8(bytes, zero);
+            __m128i high = _mm_unpackhi_epi8(bytes, zero);
+            __m128i* out = reinterpret_cast<__m128i*>(destination + i);
+            if (sizeof(wchar_t) == 2)
+            {
+                _mm_storeu_si128(out, low);
+                _mm_storeu_si128(out + 1, high);
+            }
+            else
+            {
+                _mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+                _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+                _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+            }
+        }
+        return i;
+    }
+
+    size_t narrowSse2(const wchar_t* source, size_t i, size_t n, char* destination)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i* in = reinterpret_cast<const __m128i*>(source + i);
+        if (sizeof(wchar_t) == 2)
+        {
+            const __m128i notAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+            for (; i + 16 <= n; i += 16, in += 2)
+            {
+                __m128i a = _mm_loadu_si128(in);
+                __m128i b = _mm_loadu_si128(in + 1);
+                __m128i high = _mm_and_si128(_mm_or_si128(a, b), notAscii);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, zero)) != 0xFFFF)
+                    break;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(a, b));
+            }
+        }
+        else
+        {
+            const __m128i notAscii = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+            for (; i + 16 <= n; i += 16, in += 4)
+            {
+                __m128i a = _mm_loadu_si128(in);
+                __m128i b = _mm_loadu_si128(in + 1);
+                __m128i c = _mm_loadu_si128(in + 2);
+                __m128i d = _mm_loadu_si128(in + 3);
+                __m128i high = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), notAscii);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, zero)) != 0xFFFF)
+                    break;
+                // every value is below 0x80, so the saturating packs are exact
+                __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+            }
+        }
+        return i;
+    }
+#endif
+
+    // eight characters at a time, testing their top bits together
+    size_t widenPortable(const char* source, size_t i, size_t n, wchar_t* destination)
+    {
+        for (; i + 8 <= n; i += 8)
+        {
+            unsigned long long block;
+            std::memcpy(&block, source + i, sizeof(block));
+            if (block & 0x8080808080808080ULL)
+                break;
+            for (size_t j = 0; j < 8; ++j)
+                destination[i + j] = static_cast<wchar_t>(source[i + j]);
+        }
+        for (; i < n && static_cast<unsigned char>(source[i]) < 0x80; ++i)
+            destination[i] = static_cast<wchar_t>(source[i]);
+        return i;
+    }
+
+    size_t narrowPortable(const wchar_t* source, size_t i, size_t n, char* destination)
+    {
+        for (; i + 8 <= n; i += 8)
+        {
+            unsigned long bits = 0;
+            for (size_t j = 0; j < 8; ++j)
+                bits |= static_cast<unsigned long>(source[i + j]);
+            if (bits >= 0x80)
+                break;
+            for (size_t j = 0; j < 8; ++j)
+                destination[i + j] = static_cast<char>(source[i + j]);
+        }
+        for (; i < n && isAscii(source[i]); ++i)
+            destination[i] = static_cast<char>(source[i]);
+        return i;
+    }
+}
+
+size_t xlw::AsciiConversions::Widen(const char* source, size_t n, wchar_t* destination)
+{
+    size_t i = 0;
+#if defined(XLW_ASCII_AVX2)
+    i = widenAvx2(source, i, n, destination);
+#endif
+#if defined(XLW_ASCII_SSE2)
+    i = widenSse2(source, i, n, destination);
+#endif
+    return widenPortable(source, i, n, destination);
+}
+
+size_t xlw::AsciiConversions::Narrow(const wchar_t* source, size_t n, char* destination)
+{
+    size_t i = 0;
+#if defined(XLW_ASCII_AVX2)
+    i = narrowAvx2(source, i, n, destination);
+#endif
+#if defined(XLW_ASCII_SSE2)
+    i = narrowSse2(source, i, n, destination);
+#endif
+    return narrowPortable(source, i, n, destination);
+}
+
+const char* xlw::AsciiConversions::Backend()
+{
+#if defined(XLW_ASCII_AVX2)
+    return "AVX2";
+#elif defined(XLW_ASCII_SSE2)
+    return "SSE2";
+#else
+    return "portable";
+#endif
+}
@@ -0,0 +1,346 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+#include <xlw/FlatCellMatrix.h>
+#include <xlw/XlfException.h>
+#include <xlw/PascalStringConversions.h>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace
+{
+    void checkLength(size_t length)
+    {
+        if (length > UINT_MAX)
+            THROW_XLW("string too long for a CellMatrix cell");
+    }
+
+    // returns the offset of the copy
+    template<class Char>
+    size_t appendToPool(std::vector<Char>& pool, const Char* data, size_t length)
+    {
+        std::less_equal<const Char*> notAfter;
+        if (!pool.empty() && notAfter(pool.data(), data) && notAfter(data, pool.data() + pool.size()))
+        {
+            // the characters are already in the pool and would move as it grows
+            std::vector<Char> copy(data, data + length);
+            return appendToPool(pool, copy.data(), length);
+        }
+        size_t offset = pool.size();
+        pool.insert(pool.end(), data, data + length);
+        return offset;
+    }
+}
+
+const std::string & xlw::impl::FlatCellValue::StringValue() const
+{
+    if (type_ != string && type_ != wstring)
+        THROW_XLW("non string cell asked to be a string");
+
+    std::lock_guard<std::mutex> lock(owner_->TextMutex);
+    std::unique_ptr<std::string>& text = owner_->NarrowText[this - owner_->Cells_.data()];
+    if (!text)
+    {
+        if (type_ == string)
+        {
+            text.reset(new std::string(GetNarrowData(), length_));
+        }
+        else
+        {
+            text.reset(new std::string(PascalStringConversions::WStringToString(GetWideData(), length_)));
+        }
+    }
+    return *text;
+}
+
+const std::wstring& xlw::impl::FlatCellValue::WstringValue() const
+{
+    if (type_ != string && type_ != wstring)
+        THROW_XLW("non string cell asked to be a string");
+
+    std::lock_guard<std::mutex> lock(owner_->TextMutex);
+    std::unique_ptr<std::wstring>& text = owner_->WideText[this - owner_->Cells_.data()];
+    if (!text)
+    {
+        if (type_ == wstring)
+        {
+            text.reset(new std::wstring(GetWideData(), length_));
+        }
+        else
+        {
+            text.reset(new std::wstring(PascalStringConversions::StringToWString(GetNarrowData(), length_)));
+        }
+    }
+    return *text;
+}
+
+double xlw::impl::FlatCellValue::NumericValue() const
+{
+    if (type_ != number)
+        THROW_XLW("non number cell asked to be a number");
+    return value_.number;
+}
+
+bool xlw::impl::FlatCellValue::BooleanValue() const
+{
+    if (type_ != boolean)
+        THROW_XLW("non boolean cell asked to be a bool");
+    return value_.boolean;
+}
+
+unsigned long xlw::impl::FlatCellValue::ErrorValue() const
+{
+    if (type_ != error)
+        THROW_XLW("non error cell asked to be an error");
+    return value_.error;
+}
+
+xlw::impl::FlatCellValue::operator std::string() const
+{
+    return StringValue();
+}
+
+xlw::impl::FlatCellValue::operator std::wstring() const
+{
+    return WstringValue();
+}
+
+xlw::impl::FlatCellValue::operator bool() const
+{
+    return BooleanValue();
+}
+
+xlw::impl::FlatCellValue::operator double() const
+{
+    return NumericValue();
+}
+
+xlw::impl::FlatCellValue::operator unsigned long() const
+{
+    return static_cast<unsigned long>(NumericValue());
+}
+
+void xlw::impl::FlatCellValue::clear()
+{
+    release();
+    type_ = empty;
+    length_ = 0;
+}
+
+void xlw::impl::FlatCellValue::SetString(const char* data, size_t length)
+{
+    checkLength(length);
+    release();
+    if (length <= inlineBytes)
+    {
+        std::memcpy(value_.narrow, data, length);
+    }
+    else
+    {
+        value_.offset = appendToPool(owner_->NarrowPool, data, length);
+    }
+    length_ = static_cast<unsigned int>(length);
+    type_ = string;
+}
+
+void xlw::impl::FlatCellValue::SetWstring(const wchar_t* data, size_t length)
+{
+    checkLength(length);
+    release();
+    if (length <= inlineBytes / sizeof(wchar_t))
+    {
+        std::memcpy(value_.wide, data, length * sizeof(wchar_t));
+    }
+    else
+    {
+        value_.offset = appendToPool(owner_->WidePool, data, length);
+    }
+    length_ = static_cast<unsigned int>(length);
+    type_ = wstring;
+}
+
+void xlw::impl::FlatCellValue::SetValue(const FlatCellValue& value)
+{
+    if (this == &value)
+        return;
+    if (value.owner_ == owner_ || !value.IsString() || value.isInline())
+    {
+        // pooled characters are never changed, so cells of one matrix can share them
+        release();
+        value_ = value.value_;
+        length_ = value.length_;
+        type_ = value.type_;
+    }
+    else if (value.type_ == string)
+    {
+        SetString(value.GetNarrowData(), value.length_);
+    }
+    else
+    {
+        SetWstring(value.GetWideData(), value.length_);
+    }
+}
+
+xlw::CellValue & xlw::impl::FlatCellValue::assign(const std::string& data)
+{
+    SetString(data.data(), data.size());
+    return *this;
+}
+
+xlw::CellValue & xlw::impl::FlatCellValue::assign(const std::wstring& data)
+{
+    SetWstring(data.data(), data.size());
+    return *this;
+}
+
+xlw::CellValue & xlw::impl::FlatCellValue::assign(double data)
+{
+    SetNumber(data);
+    return *this;
+}
+
+xlw::CellValue & xlw::impl::FlatCellValue::assign(unsigned long data)
+{
+    SetNumber(static_cast<double>(data));
+    return *this;
+}
+
+xlw::CellValue & xlw::impl::FlatCellValue::assign(bool data)
+{
+    SetBoolean(data);
+    return *this;
+}
+
+xlw::CellValue & xlw::impl::FlatCellValue::assign(int data)
+{
+    SetNumber(data);
+    return *this;
+}
+
+xlw::CellValue & xlw::impl::FlatCellValue::assign(error_type e)
+{
+    SetError(e.value);
+    return *this;
+}
+
+xlw::impl::FlatCellMatrix::FlatCellMatrix() : Rows(0), Columns(0)
+{
+}
+
+xlw::impl::FlatCellMatrix::FlatCellMatrix(size_t rows, size_t columns)
+    : Cells_(rows * columns, FlatCellValue(this)), Rows(rows), Columns(columns)
+{
+}
+
+xlw::impl::FlatCellMatrix::FlatCellMatrix(const FlatCellMatrix &theOther)
+    : Rows(theOther.Rows), Columns(theOther.Columns)
+{
+    // only the strings still referred to are copied
+    size_t narrow = 0;
+    size_t wide = 0;
+    for (size_t i = 0; i < theOther.Cells_.size(); ++i)
+    {
+        const FlatCellValue& cell(theOther.Cells_[i]);
+        if (cell.IsString() && !cell.isInline())
+            (cell.type_ == FlatCellValue::string ? narrow : wide) += cell.length_;
+    }
+    NarrowPool.reserve(narrow);
+    WidePool.reserve(wide);
+
+    Cells_.reserve(theOther.Cells_.size());
+    for (size_t i = 0; i < theOther.Cells_.size(); ++i)
+    {
+        Cells_.push_back(FlatCellValue(this));
+        Cells_.back().SetValue(theOther.Cells_[i]);
+    }
+}
+
+xlw::impl::FlatCellMatrix::FlatCellMatrix(const FlatCellMatrix &top, const xlw::CellMatrix_pimpl_abstract& bottom)
+    : Cells_((top.Rows + bottom.RowsInStructure()) * std::max(top.Columns, bottom.ColumnsInStructure()), FlatCellValue(this)),
+      Rows(top.Rows + bottom.RowsInStructure()),
+      Columns(std::max(top.Columns, bottom.ColumnsInStructure()))
+{
+    for (size_t i(0); i < top.Rows; ++i)
+    {
+        for (size_t j(0); j < top.Columns; ++j)
+        {
+            Cells_[i * Columns + j].SetValue(top.Cells_[i * top.Columns + j]);
+        }
+    }
+
+    const FlatCellMatrix* flatRows = dynamic_cast<const FlatCellMatrix*>(&bottom);
+    for (size_t i(0); i < bottom.RowsInStructure(); ++i)
+    {
+        for (size_t j(0); j < bottom.ColumnsInStructure(); ++j)
+        {
+            FlatCellValue& cell(Cells_[(top.Rows + i) * Columns + j]);
+            if (flatRows)
+                cell.SetValue(flatRows->Cells_[i * flatRows->Columns + j]);
+            else
+                static_cast<CellValue&>(cell) = bottom(i, j);
+        }
+    }
+}
+
+const xlw::CellValue& xlw::impl::FlatCellMatrix::operator()(size_t i, size_t j) const
+{
+    if (i >= Rows || j >= Columns)
+        throw std::out_of_range("CellMatrix index out of range");
+    return Cells_[i * Columns + j];
+}
+
+xlw::CellValue& xlw::impl::FlatCellMatrix::operator()(size_t i, size_t j)
+{
+    if (i >= Rows || j >= Columns)
+        throw std::out_of_range("CellMatrix index out of range");
+    return Cells_[i * Columns + j];
+}
+
+size_t xlw::impl::FlatCellMatrix::RowsInStructure() const
+{
+    return Rows;
+}
+
+size_t xlw::impl::FlatCellMatrix::ColumnsInStructure() const
+{
+    return Columns;
+}
+
+void xlw::impl::FlatCellMatrix::PushBottom(const xlw::CellMatrix_pimpl_abstract & newRows)
+{
+    FlatCellMatrix temp(*this, newRows);
+    swap(temp);
+}
+
+void xlw::impl::FlatCellMatrix::swap(FlatCellMatrix& theOther)
+{
+    Cells_.swap(theOther.Cells_);
+    std::swap(Rows, theOther.Rows);
+    std::swap(Columns, theOther.Columns);
+    NarrowPool.swap(theOther.NarrowPool);
+    WidePool.swap(theOther.WidePool);
+    NarrowText.swap(theOther.NarrowText);
+    WideText.swap(theOther.WideText);
+    adopt();
+    theOther.adopt();
+}
+
+void xlw::impl::FlatCellMatrix::adopt()
+{
+    for (size_t i = 0; i < Cells_.size(); ++i)
+        Cells_[i].owner_ = this;
+}
@@ -0,0 +1,122 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include "FlatOper.h"
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    bool isFlatCell(DWORD type)
+    {
+        switch (type)
+        {
+        case xltypeNum:
+        case xltypeStr:
+        case xltypeBool:
+        case xltypeErr:
+        case xltypeNil:
+        case xltypeMissing:
+        case xltypeInt:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    size_t stringBytes(const XCHAR* text)
+    {
+        return (static_cast<size_t>(text[0]) + 1) * sizeof(XCHAR);
+    }
+
+    XCHAR* toOffset(size_t offset)
+    {
+        return reinterpret_cast<XCHAR*>(static_cast<std::uintptr_t>(offset));
+    }
+
+    XCHAR* fromOffset(char* base, const XCHAR* offset)
+    {
+        return reinterpret_cast<XCHAR*>(base + reinterpret_cast<std::uintptr_t>(offset));
+    }
+}
+
+bool xlw::FlatOper::Flatten(const XLOPER12& value, std::string& result)
+{
+    DWORD type = value.xltype & 0xFFF;
+    bool isMulti = type == xltypeMulti;
+    if (!isMulti && !isFlatCell(type))
+        return false;
+
+    const XLOPER12* cells = isMulti ? value.val.array.lparray : &value;
+    size_t count = isMulti ? static_cast<size_t>(value.val.array.rows) * static_cast<size_t>(value.val.array.columns) : 1;
+    size_t textBytes = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        DWORD cellType = cells[i].xltype & 0xFFF;
+        if (!isFlatCell(cellType))
+            return false;
+        if (cellType == xltypeStr)
+            textBytes += stringBytes(cells[i].val.str);
+    }
+
+    size_t headerCount = isMulti ? count + 1 : 1;
+    result.resize(headerCount * sizeof(XLOPER12) + textBytes);
+    XLOPER12* out = reinterpret_cast<XLOPER12*>(&result[0]);
+    size_t text = headerCount * sizeof(XLOPER12);
+
+    XLOPER12* outCells = out;
+    if (isMulti)
+    {
+        out->xltype = xltypeMulti;
+        out->val.array.lparray = reinterpret_cast<LPXLOPER12>(static_cast<std::uintptr_t>(sizeof(XLOPER12)));
+        out->val.array.rows = value.val.array.rows;
+        out->val.array.columns = value.val.array.columns;
+        outCells = out + 1;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        outCells[i] = cells[i];
+        outCells[i].xltype = cells[i].xltype & 0xFFF;
+        if (outCells[i].xltype == xltypeStr)
+        {
+            size_t bytes = stringBytes(cells[i].val.str);
+            std::memcpy(&result[text], cells[i].val.str, bytes);
+            outCells[i].val.str = toOffset(text);
+            text += bytes;
+        }
+    }
+    return true;
+}
+
+LPXLOPER12 xlw::FlatOper::Rebase(char* base)
+{
+    LPXLOPER12 result = reinterpret_cast<LPXLOPER12>(base);
+    if (result->xltype == xltypeStr)
+    {
+        result->val.str = fromOffset(base, result->val.str);
+    }
+    else if (result->xltype == xltypeMulti)
+    {
+        result->val.array.lparray = reinterpret_cast<LPXLOPER12>(base + reinterpret_cast<std::uintptr_t>(result->val.array.lparray));
+        size_t count = static_cast<size_t>(result->val.array.rows) * static_cast<size_t>(result->val.array.columns);
+        LPXLOPER12 cells = result->val.array.lparray;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (cells[i].xltype == xltypeStr)
+                cells[i].val.str = fromOffset(base, cells[i].val.str);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,48 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef INC_FlatOper_H
+#define INC_FlatOper_H
+
+/*!
+\file FlatOper.h
+\brief Copies of values held apart from the memory they came from
+*/
+
+#include <xlw/xlcall32.h>
+#include <string>
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+namespace xlw { namespace FlatOper {
+
+    //! \name XLOPER12 values kept as one block of bytes
+    /*!
+    The block is laid out like the XLOPER12 and what it points at, with the
+    pointers held as offsets from the start, so it can be moved or copied
+    with memcpy and made usable again with Rebase.
+    */
+    //@{
+    //! False for references and anything else whose value isn't in the XLOPER12.
+    bool Flatten(const XLOPER12& value, std::string& result);
+    //! Turns the offsets back into pointers, base must be aligned for an XLOPER12.
+    LPXLOPER12 Rebase(char* base);
+    //@}
+
+}}
+
+#endif
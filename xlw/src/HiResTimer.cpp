@@ -16,9 +16,9 @@ FOR A PARTICULAR PURPOSE.  See the license for more details.
 
 #include <xlw/HiResTimer.h>
 
-xlw::HiResTimer::HiResTimer()
+xlw::HiResTimer::HiResTimer() :
+    m_start(std::chrono::steady_clock::now())
 {
-    QueryPerformanceCounter(&m_start);
 }
 
 xlw::HiResTimer::~HiResTimer()
@@ -27,9 +27,5 @@ xlw::HiResTimer::~HiResTimer()
 
 double xlw::HiResTimer::elapsed() const
 {
-    LARGE_INTEGER stop;
-    QueryPerformanceCounter(&stop);
-    LARGE_INTEGER frequency;
-    QueryPerformanceFrequency(&frequency);
-    return double(stop.QuadPart - m_start.QuadPart) / double(frequency.QuadPart);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
 }
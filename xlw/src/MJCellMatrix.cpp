@@ -23,7 +23,9 @@
 */
 #include <xlw/MJCellMatrix.h>
 #include <xlw/XlfException.h>
+#include <xlw/PascalStringConversions.h>
 #include <algorithm>
+#include <memory>
 
 
 bool xlw::impl::MJCellValue::IsString() const
@@ -156,8 +158,15 @@ const  std::string & xlw::impl::MJCellValue::StringValue() const
     if (Type == string) {
         return *ValueAsString;
     } else if (Type == wstring) {
-        ValueAsString.reset(new std::string(ValueAsWstring->begin(), ValueAsWstring->end()));
-        return *ValueAsString;
+        // made once, copies of a CellMatrix share their cells until one changes
+        std::shared_ptr<std::string> converted(std::atomic_load(&ValueAsString));
+        if (!converted) {
+            std::shared_ptr<std::string> existing;
+            converted.reset(new std::string(PascalStringConversions::WStringToString(*ValueAsWstring)));
+            if (!std::atomic_compare_exchange_strong(&ValueAsString, &existing, converted))
+                converted = existing;
+        }
+        return *converted;
     } else {
         THROW_XLW("non string cell asked to be a string");
     }
@@ -168,8 +177,14 @@ const std::wstring& xlw::impl::MJCellValue::WstringValue() const
     if (Type == wstring) {
         return *ValueAsWstring;
     } else if (Type == string) {
-        ValueAsWstring.reset(new std::wstring(ValueAsString->begin(), ValueAsString->end()));
-        return *ValueAsWstring;
+        std::shared_ptr<std::wstring> converted(std::atomic_load(&ValueAsWstring));
+        if (!converted) {
+            std::shared_ptr<std::wstring> existing;
+            converted.reset(new std::wstring(PascalStringConversions::StringToWString(*ValueAsString)));
+            if (!std::atomic_compare_exchange_strong(&ValueAsWstring, &existing, converted))
+                converted = existing;
+        }
+        return *converted;
     } else {
         THROW_XLW("non string cell asked to be a string");
     }
@@ -230,29 +245,33 @@ size_t xlw::impl::MJCellMatrix::ColumnsInStructure() const
     return Columns;
 }
 
-void xlw::impl::MJCellMatrix::PushBottom(const xlw::CellMatrix_pimpl_abstract & newRows)
+xlw::impl::MJCellMatrix::MJCellMatrix(const MJCellMatrix &top, const xlw::CellMatrix_pimpl_abstract& bottom)
+    : Cells(top.Rows + bottom.RowsInStructure()),
+      Rows(top.Rows + bottom.RowsInStructure()),
+      Columns(std::max(top.Columns, bottom.ColumnsInStructure()))
 {
-	size_t newColumns = std::max(this->ColumnsInStructure(), newRows.ColumnsInStructure());
-
-	MJCellMatrix temp(this->RowsInStructure()+newRows.RowsInStructure(),newColumns);
-
-	for(size_t i(0); i< RowsInStructure(); ++i)
+	for(size_t i(0); i < top.Rows; ++i)
 	{
-		for(size_t j(0); j < Cells.at(i).size(); ++j)
-		{
-			temp(i,j) = Cells.at(i).at(j);
-		}
+		Cells[i].reserve(Columns);
+		Cells[i] = top.Cells[i];
+		Cells[i].resize(Columns);
 	}
 
-	for(size_t i(0); i< newRows.RowsInStructure(); ++i)
+	for(size_t i(0); i < bottom.RowsInStructure(); ++i)
 	{
-		for(size_t j(0); j < newRows.ColumnsInStructure(); ++j)
+		std::vector<MJCellValue>& row(Cells[top.Rows + i]);
+		row.resize(Columns);
+		for(size_t j(0); j < bottom.ColumnsInStructure(); ++j)
 		{
-			temp(RowsInStructure()+i,j) = newRows(i,j);
+			static_cast<CellValue&>(row[j]) = bottom(i,j);
 		}
 	}
-
-	*this = temp;
 }
 
-
+void xlw::impl::MJCellMatrix::PushBottom(const xlw::CellMatrix_pimpl_abstract & newRows)
+{
+	MJCellMatrix temp(*this, newRows);
+	Cells.swap(temp.Cells);
+	Rows = temp.Rows;
+	Columns = temp.Columns;
+}
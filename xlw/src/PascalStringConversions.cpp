@@ -14,24 +14,208 @@ FOR A PARTICULAR PURPOSE.  See the license for more details.
 */
 
 #include <xlw/PascalStringConversions.h>
+#include <xlw/AsciiConversions.h>
 #include <xlw/TempMemory.h>
 #include <xlw/macros.h>
 #include <iostream>
 #include <algorithm>
 #include <cctype>
 #include <locale>
+#include <vector>
+#include <cstring>
+#include <cwchar>
+#include <cstdlib>
+
+#if defined(_WIN32)
 
 #ifndef WC_NO_BEST_FIT_CHARS
 #define WC_NO_BEST_FIT_CHARS 0x00000400
 #endif
 
+namespace
+{
+    // most narrow characters a single wide character can turn into
+    const size_t maxNarrowPerWide = 1;
+
+    // converts n narrow characters, writing at most n wide characters
+    // returns the number of wide characters written
+    size_t narrowToWideFull(const char* source, size_t n, wchar_t* destination)
+    {
+        if (n == 0)
+            return 0;
+        return MultiByteToWideChar(CP_ACP, 0, source, (int)n, destination, (int)n);
+    }
+
+    // converts n wide characters, writing at most capacity narrow characters
+    // returns the number of narrow characters written
+    size_t wideToNarrowFull(const wchar_t* source, size_t n, char* destination, size_t capacity)
+    {
+        if (n == 0 || capacity == 0)
+            return 0;
+        return WideCharToMultiByte(CP_ACP, WC_NO_BEST_FIT_CHARS, source, (int)n, destination, (int)capacity, NULL, NULL);
+    }
+}
+
+#else
+
+#include <unistd.h>
+
+// Outside Windows narrow strings are taken to be UTF-8 and wide strings
+// UTF-32, or UTF-16 where wchar_t is two bytes
+namespace
+{
+    const size_t maxNarrowPerWide = 4;
+    const wchar_t replacementCharacter = 0xFFFD;
+
+    size_t narrowToWideFull(const char* source, size_t n, wchar_t* destination)
+    {
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(source);
+        const unsigned char* end = in + n;
+        wchar_t* out = destination;
+        while (in < end)
+        {
+            unsigned long codePoint = *in;
+            size_t trailing = 0;
+            if (codePoint < 0x80)
+                trailing = 0;
+            else if ((codePoint & 0xE0) == 0xC0)
+            {
+                codePoint &= 0x1F;
+                trailing = 1;
+            }
+            else if ((codePoint & 0xF0) == 0xE0)
+            {
+                codePoint &= 0x0F;
+                trailing = 2;
+            }
+            else if ((codePoint & 0xF8) == 0xF0)
+            {
+                codePoint &= 0x07;
+                trailing = 3;
+            }
+            else
+            {
+                *out++ = replacementCharacter;
+                ++in;
+                continue;
+            }
+            if (static_cast<size_t>(end - in) <= trailing)
+            {
+                *out++ = replacementCharacter;
+                break;
+            }
+            size_t i(1);
+            for (; i <= trailing && (in[i] & 0xC0) == 0x80; ++i)
+            {
+                codePoint = (codePoint << 6) | (in[i] & 0x3F);
+            }
+            if (i <= trailing || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+            {
+                *out++ = replacementCharacter;
+                in += i;
+                continue;
+            }
+            in += trailing + 1;
+            if (sizeof(wchar_t) == 2 && codePoint > 0xFFFF)
+            {
+                // a four byte sequence becomes a surrogate pair so we never write more than n
+                codePoint -= 0x10000;
+                *out++ = static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+                *out++ = static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+            }
+            else
+            {
+                *out++ = static_cast<wchar_t>(codePoint);
+            }
+        }
+        return static_cast<size_t>(out - destination);
+    }
+
+    size_t wideToNarrowFull(const wchar_t* source, size_t n, char* destination, size_t capacity)
+    {
+        char* out = destination;
+        char* const end = destination + capacity;
+        for (size_t i(0); i < n; ++i)
+        {
+            unsigned long codePoint = static_cast<unsigned long>(source[i]);
+            if (sizeof(wchar_t) == 2)
+            {
+                codePoint &= 0xFFFF;
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i + 1 < n &&
+                    (source[i + 1] & 0xFC00) == 0xDC00)
+                {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + ((source[i + 1] & 0x3FF));
+                    ++i;
+                }
+            }
+            if (codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+                codePoint = replacementCharacter;
+
+            // stop rather than write part of a character
+            if (codePoint < 0x80)
+            {
+                if (end - out < 1)
+                    break;
+                *out++ = static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                if (end - out < 2)
+                    break;
+                *out++ = static_cast<char>(0xC0 | (codePoint >> 6));
+                *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                if (end - out < 3)
+                    break;
+                *out++ = static_cast<char>(0xE0 | (codePoint >> 12));
+                *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                if (end - out < 4)
+                    break;
+                *out++ = static_cast<char>(0xF0 | (codePoint >> 18));
+                *out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+        return static_cast<size_t>(out - destination);
+    }
+}
+
+#endif
+
+namespace
+{
+    // the ASCII at the start is converted in blocks, the platform only
+    // sees what follows the first character that isn't
+    size_t narrowToWide(const char* source, size_t n, wchar_t* destination)
+    {
+        size_t ascii = xlw::AsciiConversions::Widen(source, n, destination);
+        if (ascii == n)
+            return n;
+        return ascii + narrowToWideFull(source + ascii, n - ascii, destination + ascii);
+    }
+
+    size_t wideToNarrow(const wchar_t* source, size_t n, char* destination, size_t capacity)
+    {
+        size_t ascii = xlw::AsciiConversions::Narrow(source, std::min(n, capacity), destination);
+        if (ascii == n)
+            return n;
+        return ascii + wideToNarrowFull(source + ascii, n - ascii, destination + ascii, capacity - ascii);
+    }
+}
 
 char * xlw::PascalStringConversions::PascalStringToString(const char* pascalString)
 {
     // Must use datatype unsigned char (BYTE) to process 0th byte
     // otherwise numbers greater than 128 are incorrect
     size_t n = static_cast<BYTE>(pascalString[0]);
-    char* result = TempMemory::GetMemory<char>(n + 1);
+    char* result = TempMemory::GetMemoryUninitialised<char>(n + 1);
     memcpy(result, pascalString + 1, n);
     result[n] = 0;
     return result;
@@ -43,7 +227,10 @@ std::wstring xlw::PascalStringConversions::PascalStringToWString(const char* pas
     // otherwise numbers greater than 128 are incorrect
     size_t n = static_cast<BYTE>(pascalString[0]);
     std::wstring result(n, L'\0');
-    MultiByteToWideChar(CP_ACP, 0, pascalString + 1, (int)n, &result[0], (int)n);
+    if(n > 0)
+    {
+        result.resize(narrowToWide(pascalString + 1, n, &result[0]));
+    }
     return result;
 }
 
@@ -59,7 +246,7 @@ char* xlw::PascalStringConversions::StringToPascalString(const std::string& cStr
     // One byte more for the string length (convention used by Excel)
     // and another so that the string is null terminated so that the
     // debugger sees it correctly
-    LPSTR result = TempMemory::GetMemory<char>(n + 2);
+    LPSTR result = TempMemory::GetMemoryUninitialised<char>(n + 2);
     strncpy(result + 1, cString.c_str(), n);
     result[n + 1] = 0;
     result[0] = static_cast<BYTE>(n);
@@ -78,8 +265,9 @@ char* xlw::PascalStringConversions::WStringToPascalString(const std::wstring& cS
     // One byte more for the string length (convention used by Excel)
     // and another so that the string is null terminated so that the
     // debugger sees it correctly
-    LPSTR result = TempMemory::GetMemory<char>(n + 2);
-    WideCharToMultiByte(CP_ACP, WC_NO_BEST_FIT_CHARS, cString.c_str(), (int)n, result + 1, (int)n, NULL, NULL);
+    const size_t capacity(std::min<size_t>(n * maxNarrowPerWide, 255));
+    LPSTR result = TempMemory::GetMemoryUninitialised<char>(capacity + 2);
+    n = wideToNarrow(cString.c_str(), n, result + 1, capacity);
     result[n + 1] = 0;
     result[0] = static_cast<BYTE>(n);
     return result;
@@ -88,12 +276,10 @@ char* xlw::PascalStringConversions::WStringToPascalString(const std::wstring& cS
 char* xlw::PascalStringConversions::WPascalStringToString(const wchar_t* pascalString)
 {
     size_t n = pascalString[0];
-    char* result = TempMemory::GetMemory<char>(n + 1);
+    const size_t capacity(n * maxNarrowPerWide);
+    char* result = TempMemory::GetMemoryUninitialised<char>(capacity + 1);
+    n = wideToNarrow(pascalString + 1, n, result, capacity);
     result[n] = 0;
-    if(n > 0)
-    {
-        WideCharToMultiByte(CP_ACP, WC_NO_BEST_FIT_CHARS, pascalString + 1, (int)n, result, (int)n, NULL, NULL);
-    }
     return result;
 }
 
@@ -108,8 +294,11 @@ std::wstring xlw::PascalStringConversions::WPascalStringToWString(const wchar_t*
 
 wchar_t* xlw::PascalStringConversions::StringToWPascalString(const std::string& cString)
 {
-    size_t n(cString.length());
+    return StringToWPascalString(cString.c_str(), cString.length());
+}
 
+wchar_t* xlw::PascalStringConversions::StringToWPascalString(const char* cString, size_t n)
+{
     if (n > 32767) {
         std::cerr << XLW__HERE__ << "String truncated to 32767 bytes" << std::endl;
         n = 32767;
@@ -118,8 +307,8 @@ wchar_t* xlw::PascalStringConversions::StringToWPascalString(const std::string&
     // One byte more for the string length (convention used by Excel)
     // and another so that the string is null terminated so that the
     // debugger sees it correctly
-    wchar_t* result  = TempMemory::GetMemory<wchar_t>(n+2);
-    MultiByteToWideChar(CP_ACP, 0, cString.c_str(), (int)n, result + 1, (int)n);
+    wchar_t* result  = TempMemory::GetMemoryUninitialised<wchar_t>(n+2);
+    n = narrowToWide(cString, n, result + 1);
     result[n + 1] = 0;
     result[0] = static_cast<XCHAR>(n);
     return result;
@@ -127,8 +316,11 @@ wchar_t* xlw::PascalStringConversions::StringToWPascalString(const std::string&
 
 wchar_t* xlw::PascalStringConversions::WStringToWPascalString(const std::wstring& cString)
 {
-    size_t n(cString.length());
+    return WStringToWPascalString(cString.c_str(), cString.length());
+}
 
+wchar_t* xlw::PascalStringConversions::WStringToWPascalString(const wchar_t* cString, size_t n)
+{
     if (n > 32766)
     {
         std::cerr << XLW__HERE__ << "String truncated to 32766 bytes" << std::endl;
@@ -137,18 +329,48 @@ wchar_t* xlw::PascalStringConversions::WStringToWPascalString(const std::wstring
     // One byte more for the string length (convention used by Excel)
     // and another so that the string is null terminated so that the
     // debugger sees it correctly
-    wchar_t* result = TempMemory::GetMemory<wchar_t>(n + 2);
-    wcsncpy(result + 1, cString.c_str(), n);
+    wchar_t* result = TempMemory::GetMemoryUninitialised<wchar_t>(n + 2);
+    wcsncpy(result + 1, cString, n);
     result[n + 1] = 0;
     result[0] = static_cast<wchar_t>(n);
     return result;
 }
 
 
+std::string xlw::PascalStringConversions::WStringToString(const std::wstring& wString)
+{
+    return WStringToString(wString.data(), wString.size());
+}
+
+std::string xlw::PascalStringConversions::WStringToString(const wchar_t* wString, size_t n)
+{
+    std::string result(n * maxNarrowPerWide, '\0');
+    if (n > 0)
+    {
+        result.resize(wideToNarrow(wString, n, &result[0], result.size()));
+    }
+    return result;
+}
+
+std::wstring xlw::PascalStringConversions::StringToWString(const std::string& cString)
+{
+    return StringToWString(cString.data(), cString.size());
+}
+
+std::wstring xlw::PascalStringConversions::StringToWString(const char* cString, size_t n)
+{
+    std::wstring result(n, L'\0');
+    if (n > 0)
+    {
+        result.resize(narrowToWide(cString, n, &result[0]));
+    }
+    return result;
+}
+
 char* xlw::PascalStringConversions::PascalStringCopy(const char* pascalString)
 {
     size_t n = static_cast<BYTE>(pascalString[0]);
-    LPSTR result = TempMemory::GetMemory<char>(n + 2);
+    LPSTR result = TempMemory::GetMemoryUninitialised<char>(n + 2);
     memcpy(result, pascalString, n + 1);
     result[n + 1] = 0;
     return result;
@@ -157,7 +379,7 @@ char* xlw::PascalStringConversions::PascalStringCopy(const char* pascalString)
 wchar_t* xlw::PascalStringConversions::WPascalStringCopy(const wchar_t* pascalString)
 {
     size_t n = static_cast<wchar_t>(pascalString[0]);
-    wchar_t* result = TempMemory::GetMemory<wchar_t>(n + 2);
+    wchar_t* result = TempMemory::GetMemoryUninitialised<wchar_t>(n + 2);
     memcpy(result, pascalString, (n + 1) * sizeof(wchar_t));
     result[n + 1] = 0;
     return result;
@@ -183,6 +405,15 @@ wchar_t* xlw::PascalStringConversions::WPascalStringCopyUsingNew(const wchar_t*
 
 std::string xlw::StringUtilities::getEnvironmentVariable(const std::string& variableName)
 {
+#if !defined(_WIN32)
+    const char* value = std::getenv(variableName.c_str());
+    if(!value)
+    {
+        std::cerr << XLW__HERE__ <<" Could not obtain " << variableName << " Environment variable " <<  std::endl;
+        return "";
+    }
+    return value;
+#else
     const DWORD bufferSize=4096;
     std::vector<char> result(bufferSize);
     DWORD dwRet = GetEnvironmentVariable(variableName.c_str(), &result[0], bufferSize);
@@ -197,11 +428,21 @@ std::string xlw::StringUtilities::getEnvironmentVariable(const std::string& vari
         return "";
     }
     return &result[0];
+#endif
 }
 
 std::string xlw::StringUtilities::getCurrentDirectory()
 {
     std::vector<char> result;
+#if !defined(_WIN32)
+    result.resize(4096);
+    if(!getcwd(&result[0], result.size()))
+    {
+        std::cerr << XLW__HERE__ <<" Could not obtain Current directory " <<  std::endl;
+        return "";
+    }
+    return &result[0];
+#else
     DWORD dwRet = GetCurrentDirectory(0, 0);
     if(dwRet)
     {
@@ -214,6 +455,7 @@ std::string xlw::StringUtilities::getCurrentDirectory()
         return "";
     }
     return &result[0];
+#endif
 }
 
 
@@ -0,0 +1,140 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include <xlw/PascalStringInterner.h>
+#include <xlw/PascalStringConversions.h>
+#include <cstring>
+
+namespace
+{
+    const size_t initialEntries = 64;
+    // lookups before the hit rate is first judged
+    const size_t firstCheck = 256;
+
+    // FNV-1a over the code units
+    template<class Char>
+    size_t hashOf(const Char* data, size_t length)
+    {
+        unsigned long long hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < length; ++i)
+        {
+            hash ^= static_cast<unsigned long long>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+
+    wchar_t* convert(const char* data, size_t length)
+    {
+        return xlw::PascalStringConversions::StringToWPascalString(data, length);
+    }
+
+    wchar_t* convert(const wchar_t* data, size_t length)
+    {
+        return xlw::PascalStringConversions::WStringToWPascalString(data, length);
+    }
+}
+
+xlw::PascalStringInterner::PascalStringInterner() : Used(0), Lookups(0), Hits(0), Bypass(false), EmptyString(0)
+{
+    Last.data = 0;
+    Last.length = 0;
+    Last.hash = 0;
+    Last.pascalString = 0;
+    Last.wide = false;
+}
+
+wchar_t* xlw::PascalStringInterner::Narrow(const char* data, size_t length)
+{
+    return intern(data, length, false);
+}
+
+wchar_t* xlw::PascalStringInterner::Wide(const wchar_t* data, size_t length)
+{
+    return intern(data, length, true);
+}
+
+wchar_t* xlw::PascalStringInterner::Empty()
+{
+    if (!EmptyString)
+        EmptyString = convert("", 0);
+    return EmptyString;
+}
+
+template<class Char>
+wchar_t* xlw::PascalStringInterner::intern(const Char* data, size_t length, bool wide)
+{
+    if (length == 0)
+        return Empty();
+    if (Last.pascalString && Last.data == data && Last.length == length && Last.wide == wide)
+        return Last.pascalString;
+    if (Bypass)
+        return convert(data, length);
+
+    // at every power of two from firstCheck, give up unless one in eight repeats
+    if (++Lookups >= firstCheck && (Lookups & (Lookups - 1)) == 0 && 8 * Hits < Lookups)
+    {
+        Bypass = true;
+        Entries.clear();
+        return convert(data, length);
+    }
+
+    if (Entries.empty())
+        Entries.resize(initialEntries);
+
+    size_t hash = hashOf(data, length);
+    size_t mask = Entries.size() - 1;
+    size_t slot = hash & mask;
+    while (Entries[slot].pascalString)
+    {
+        const Entry& entry(Entries[slot]);
+        if (entry.hash == hash && entry.length == length && entry.wide == wide &&
+            (entry.data == data || std::memcmp(entry.data, data, length * sizeof(Char)) == 0))
+        {
+            ++Hits;
+            Last = entry;
+            return entry.pascalString;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    Entry& entry(Entries[slot]);
+    entry.data = data;
+    entry.length = length;
+    entry.hash = hash;
+    entry.pascalString = convert(data, length);
+    entry.wide = wide;
+    Last = entry;
+    if (2 * ++Used > Entries.size())
+        grow();
+    return Last.pascalString;
+}
+
+void xlw::PascalStringInterner::grow()
+{
+    std::vector<Entry> entries(2 * Entries.size());
+    size_t mask = entries.size() - 1;
+    for (size_t i = 0; i < Entries.size(); ++i)
+    {
+        if (Entries[i].pascalString)
+        {
+            size_t slot = Entries[i].hash & mask;
+            while (entries[slot].pascalString)
+                slot = (slot + 1) & mask;
+            entries[slot] = Entries[i];
+        }
+    }
+    Entries.swap(entries);
+}
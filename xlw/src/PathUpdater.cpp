@@ -27,6 +27,7 @@ FOR A PARTICULAR PURPOSE.  See the license for more details.
 
 xlw::PathUpdater::PathUpdater()
 {
+#if defined(_WIN32)
     MEMORY_BASIC_INFORMATION theInfo ;
     HMODULE theHandle = NULL;
     char theDLLPathChar [MAX_PATH + 1] = "";
@@ -67,6 +68,10 @@ xlw::PathUpdater::PathUpdater()
     {
         std::cerr << XLW__HERE__ << " Warning: Unable to initialise PATH to directory of library " << std::endl;
     }
+#else
+    // the dynamic loader reads its search path once at start up
+    // so there is nothing useful we can change here
+#endif
 }
 
 xlw::PathUpdater::~PathUpdater()
@@ -0,0 +1,141 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+// Worksheet access to the call profiles of the generated functions, and a
+// command writing them to a file. xlw.h forces the exports below so that
+// this translation unit, and with it the registrations, is always linked in.
+// They are registered under the add-in's name, as in MyAddin.xlwProfile.
+
+#include <xlw/XlfProfiler.h>
+#include <xlw/XlFunctionRegistration.h>
+#include <xlw/XlfOper.h>
+#include <xlw/CellMatrix.h>
+#include <xlw/macros.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+using namespace xlw;
+
+namespace
+{
+    XLRegistration::XLFunctionRegistrationHelper
+    registerProfile("xlwProfile",
+                    "xlwProfile",
+                    "Calls, exceptions and times in microseconds of each function that has been called ",
+                    "xlw",
+                    0,
+                    0,
+                    true,
+                    true,
+                    "",
+                    "",
+                    false,
+                    false,
+                    false,
+                    true);
+
+    XLRegistration::XLCommandRegistrationHelper
+    registerProfileDump("xlwProfileDump",
+                        "xlwProfileDump",
+                        "Writes the call profiles and their histograms to XLW_PROFILE_FILE, or xlwProfile.csv in the temporary directory ",
+                        "",
+                        "",
+                        true);
+
+    const char* const statisticNames[] = { " mean us", " p50 us", " p90 us", " p99 us", " max us" };
+    const size_t statisticCount = sizeof(statisticNames) / sizeof(statisticNames[0]);
+
+    std::string dumpFile()
+    {
+        if (const char* file = std::getenv("XLW_PROFILE_FILE"))
+            return file;
+        const char* directories[] = { "TEMP", "TMP", "TMPDIR" };
+        for (size_t i = 0; i < sizeof(directories) / sizeof(directories[0]); ++i)
+        {
+            if (const char* directory = std::getenv(directories[i]))
+                return std::string(directory) + "/xlwProfile.csv";
+        }
+        return "xlwProfile.csv";
+    }
+}
+
+extern "C"
+{
+    LPXLFOPER EXCEL_EXPORT xlwProfile()
+    {
+        EXCEL_BEGIN;
+        std::vector<XlfProfiler*> profilers(XlfProfiler::Profilers());
+        std::vector<std::pair<XlfProfiler*, XlfProfiler::Statistics> > called;
+        called.reserve(profilers.size());
+        for (size_t i = 0; i < profilers.size(); ++i)
+        {
+            XlfProfiler::Statistics statistics(profilers[i]->GetStatistics());
+            if (statistics.calls + statistics.exceptions)
+                called.push_back(std::make_pair(profilers[i], statistics));
+        }
+
+        CellMatrix result(called.size() + 1, 4 + XlfProfiler::phaseCount * statisticCount);
+        result(0, 0) = "function";
+        result(0, 1) = "calls";
+        result(0, 2) = "exceptions";
+        result(0, 3) = "bytes per call";
+        for (size_t phase = 0; phase < XlfProfiler::phaseCount; ++phase)
+        {
+            for (size_t j = 0; j < statisticCount; ++j)
+                result(0, 4 + phase * statisticCount + j) =
+                    std::string(XlfProfiler::PhaseName(static_cast<XlfProfiler::Phase>(phase))) + statisticNames[j];
+        }
+
+        for (size_t i = 0; i < called.size(); ++i)
+        {
+            const XlfProfiler::Statistics& statistics(called[i].second);
+            unsigned long long made = statistics.calls + statistics.exceptions;
+            size_t row = i + 1;
+            result(row, 0) = called[i].first->FunctionName();
+            result(row, 1) = static_cast<double>(statistics.calls);
+            result(row, 2) = static_cast<double>(statistics.exceptions);
+            result(row, 3) = static_cast<double>(statistics.bytes) / made;
+            for (size_t phase = 0; phase < XlfProfiler::phaseCount; ++phase)
+            {
+                const XlfProfiler::Histogram& histogram(statistics.phases[phase]);
+                const double values[] = { histogram.Mean(), histogram.Percentile(0.5),
+                    histogram.Percentile(0.9), histogram.Percentile(0.99), histogram.Max() };
+                for (size_t j = 0; j < statisticCount; ++j)
+                    result(row, 4 + phase * statisticCount + j) = values[j] * 1e6;
+            }
+        }
+        return XlfOper(result);
+        EXCEL_END;
+    }
+
+    int EXCEL_EXPORT xlwProfileDump()
+    {
+        EXCEL_BEGIN;
+        std::string file(dumpFile());
+        std::ofstream out(file.c_str());
+        if (!out)
+        {
+            std::cerr << XLW__HERE__ << "Could not open " << file << " for the call profiles" << std::endl;
+            return 0;
+        }
+        XlfProfiler::Dump(out);
+        std::cerr << XLW__HERE__ << "Call profiles written to " << file << std::endl;
+        return 1;
+        EXCEL_END_CMD;
+    }
+}
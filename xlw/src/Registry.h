@@ -0,0 +1,58 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#ifndef INC_Registry_H
+#define INC_Registry_H
+
+/*!
+\file Registry.h
+\brief The live objects of a class, for the library to list
+*/
+
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+namespace xlw {
+
+    //! The objects of T that exist, which add themselves and take themselves out
+    /*!
+    The objects are made by the static initialisers of an add-in and may
+    outlive the registry's own statics at unload, so the list and its mutex
+    are leaked. Entries must only be used with Mutex held.
+    */
+    template<class T>
+    class Registry
+    {
+    public:
+        static std::mutex& Mutex()
+        {
+            static std::mutex* theMutex = new std::mutex;
+            return *theMutex;
+        }
+
+        static std::vector<T*>& Entries()
+        {
+            static std::vector<T*>* theEntries = new std::vector<T*>;
+            return *theEntries;
+        }
+    };
+
+}
+
+#endif
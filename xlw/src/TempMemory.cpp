@@ -18,162 +18,395 @@
 */
 
 #include "xlw/TempMemory.h"
-#include "xlw/CriticalSection.h"
-#include "xlw/ThreadLocalStorage.h"
 #include <iostream>
 #include <vector>
 #include <algorithm>
-#include <xlw/XlfWindows.h>
-
-typedef std::shared_ptr<xlw::TempMemory> TempMemoryPtr;
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
 
+#if defined(_WIN32)
+#include <xlw/XlfWindows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
-namespace 
-{
-     xlw::ThreadLocalStorage<xlw::TempMemory> tls;
-     xlw::CriticalSection threadInfoVector;
-     std::vector<TempMemoryPtr> tempMemoryInstances;
-}
 namespace
 {
-    bool threadIsDead(const TempMemoryPtr& tempMemory)
+    // every request is rounded up to this so the arena can hold any type
+    const size_t arenaAlignment = alignof(std::max_align_t);
+
+    inline size_t roundUp(size_t bytes)
     {
-        return tempMemory->isThreadDead();
+        return (bytes + arenaAlignment - 1) & ~(arenaAlignment - 1);
     }
 
-}
+    // smallest buffer we bother allocating
+    const size_t minimumBufferSize = 8192;
 
-namespace xlw {
+    std::atomic<size_t> retentionCeiling(32 * 1024 * 1024);
 
-    template<class T>
-    struct CustomArrayDeleter
+    std::atomic<size_t> largeBlockThreshold(1024 * 1024);
+
+    // most large regions a thread keeps for reuse
+    const size_t regionCacheEntries = 4;
+
+    inline size_t roundTo(size_t bytes, size_t granularity)
+    {
+        return ((bytes + granularity - 1) / granularity) * granularity;
+    }
+
+#if defined(_WIN32)
+
+    // Large pages need SeLockMemoryPrivilege, once they have been
+    // refused we don't ask again
+    char* mapPages(size_t& size)
     {
-        void operator()(T* ptr)const
+        static const size_t largePageSize = GetLargePageMinimum();
+        static std::atomic<bool> largePagesRefused(largePageSize == 0);
+        if (!largePagesRefused.load(std::memory_order_relaxed) && size >= largePageSize)
         {
-            delete[] ptr;
+            const size_t rounded = roundTo(size, largePageSize);
+            void* pages = VirtualAlloc(0, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (pages)
+            {
+                size = rounded;
+                return static_cast<char*>(pages);
+            }
+            largePagesRefused.store(true, std::memory_order_relaxed);
         }
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        size = roundTo(size, info.dwAllocationGranularity);
+        return static_cast<char*>(VirtualAlloc(0, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+    }
 
-    };
+    void unmapPages(char* start, size_t)
+    {
+        VirtualFree(start, 0, MEM_RELEASE);
+    }
 
+#else
 
+    const size_t hugePageSize = 2 * 1024 * 1024;
 
-    char* TempMemory::GetBytes(size_t bytes)
+    char* mapPages(size_t& size)
     {
-        TempMemory* threadStorage = tls.GetValue();
-        if(!threadStorage)
+#if defined(MAP_HUGETLB)
+        // explicit huge pages only exist if the administrator reserved some
+        static std::atomic<bool> hugeTlbRefused(false);
+        if (!hugeTlbRefused.load(std::memory_order_relaxed) && size >= hugePageSize)
+        {
+            const size_t rounded = roundTo(size, hugePageSize);
+            void* pages = mmap(0, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (pages != MAP_FAILED)
+            {
+                size = rounded;
+                return static_cast<char*>(pages);
+            }
+            hugeTlbRefused.store(true, std::memory_order_relaxed);
+        }
+#endif
+        if (size < hugePageSize)
         {
-            threadStorage = CreateTempMemory();
+            size = roundTo(size, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+            void* pages = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            return pages == MAP_FAILED ? 0 : static_cast<char*>(pages);
         }
-        return threadStorage->InternalGetMemory(bytes);
+
+        // transparent huge pages need the region aligned on a huge page
+        // boundary so map a spare huge page and trim either end
+        const size_t rounded = roundTo(size, hugePageSize);
+        void* pages = mmap(0, rounded + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pages == MAP_FAILED)
+            return 0;
+        char* mapped = static_cast<char*>(pages);
+        char* aligned = reinterpret_cast<char*>(roundTo(reinterpret_cast<uintptr_t>(mapped), hugePageSize));
+        const size_t head = static_cast<size_t>(aligned - mapped);
+        if (head > 0)
+            munmap(mapped, head);
+        if (hugePageSize - head > 0)
+            munmap(aligned + rounded, hugePageSize - head);
+#if defined(MADV_HUGEPAGE)
+        madvise(aligned, rounded, MADV_HUGEPAGE);
+#endif
+        size = rounded;
+        return aligned;
     }
 
-    void TempMemory::EnterExportedFunction() {
-        TempMemory* threadStorage = tls.GetValue();
-        if(!threadStorage)
+    void unmapPages(char* start, size_t size)
+    {
+        munmap(start, size);
+    }
+
+#endif
+
+    // The registry of live arenas is only touched when a thread first
+    // uses TempMemory and when it exits, never on the allocation path.
+    // Both objects are deliberately leaked so that threads exiting
+    // during process shutdown never see them destroyed.
+    std::mutex& registryMutex()
+    {
+        static std::mutex* theMutex = new std::mutex;
+        return *theMutex;
+    }
+
+    std::vector<xlw::TempMemory*>& registry()
+    {
+        static std::vector<xlw::TempMemory*>* theRegistry = new std::vector<xlw::TempMemory*>;
+        return *theRegistry;
+    }
+
+    // counters of threads that have exited, guarded by registryMutex
+    xlw::TempMemory::Statistics& retiredStatistics()
+    {
+        static xlw::TempMemory::Statistics* theStatistics = new xlw::TempMemory::Statistics();
+        return *theStatistics;
+    }
+
+    // only the owning thread writes its counters so a plain load and store
+    // is enough, this avoids a locked instruction on the allocation path
+    inline void increment(std::atomic<unsigned long long>& counter, unsigned long long amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    inline void raise(std::atomic<unsigned long long>& counter, unsigned long long value)
+    {
+        if (value > counter.load(std::memory_order_relaxed))
+            counter.store(value, std::memory_order_relaxed);
+    }
+
+    void merge(xlw::TempMemory::Statistics& total, const xlw::TempMemory::Statistics& more)
+    {
+        total.bytesRequested += more.bytesRequested;
+        total.buffersAllocated += more.buffersAllocated;
+        total.bufferGrowths += more.bufferGrowths;
+        total.topLevelCalls += more.topLevelCalls;
+        total.peakBytesPerCall = std::max(total.peakBytesPerCall, more.peakBytesPerCall);
+        total.peakDepth = std::max(total.peakDepth, more.peakDepth);
+        total.threads += more.threads;
+    }
+}
+
+namespace xlw {
+
+    TempMemory& TempMemory::ThreadInstance()
+    {
+        static thread_local TempMemory threadMemory;
+        return threadMemory;
+    }
+
+    char* TempMemory::GetBytes(size_t bytes)
+    {
+        char* result = GetRawBytes(bytes);
+        memset(result, 0, bytes);
+        return result;
+    }
+
+    char* TempMemory::GetRawBytes(size_t bytes)
+    {
+        TempMemory& threadStorage = ThreadInstance();
+        const size_t rounded = roundUp(bytes);
+        if (static_cast<size_t>(threadStorage.end_ - threadStorage.current_) < rounded)
         {
-            threadStorage = CreateTempMemory();
+            return threadStorage.InternalGetMemory(rounded);
         }
-        threadStorage->InternalEnterExportedFunction();
+        char* result = threadStorage.current_;
+        threadStorage.current_ += rounded;
+        increment(threadStorage.bytesRequested_, rounded);
+        return result;
+    }
+
+    void TempMemory::EnterExportedFunction() {
+        ThreadInstance().InternalEnterExportedFunction();
     }
 
 
     void TempMemory::LeaveExportedFunction() {
-        TempMemory* threadStorage = tls.GetValue();
-        if(threadStorage)
-        {
-            threadStorage->InternalLeaveExportedFunction();
-        }
+        ThreadInstance().InternalLeaveExportedFunction();
     }
 
     TempMemory::TempMemory() :
-        offset_(0),
-        threadId_(GetCurrentThreadId()),
-        depth_(0){
+        current_(0),
+        end_(0),
+        retiredBytes_(0),
+        highWater_(0),
+        depth_(0),
+        bytesRequested_(0),
+        buffersAllocated_(0),
+        bufferGrowths_(0),
+        topLevelCalls_(0),
+        peakBytesPerCall_(0),
+        peakDepth_(0){
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(this);
     }
 
     TempMemory::~TempMemory() {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        std::vector<TempMemory*>& instances(registry());
+        instances.erase(std::remove(instances.begin(), instances.end(), this), instances.end());
+        merge(retiredStatistics(), Snapshot());
         InternalFreeMemory(true);
     }
 
+    void TempMemory::XlfBuffer::Release::operator()(char* start) const {
+        if (mappedSize)
+            unmapPages(start, mappedSize);
+        else
+            delete [] start;
+    }
+
     void TempMemory::InternalFreeMemory(bool finished) {
-        size_t nbBuffersToKeep = 1;
-        if (finished)
-            nbBuffersToKeep = 0;
-        while (freeList_.size() > nbBuffersToKeep) {
-           // delete[] freeList_.back().start; shouldn't need this anymore
-            freeList_.pop_back();
+        if (finished || buffers_.empty()) {
+            buffers_.clear();
+            regionCache_.clear();
+            current_ = end_ = 0;
+            retiredBytes_ = 0;
+            highWater_ = 0;
+            return;
+        }
+        RetainBuffer();
+    }
+
+    size_t TempMemory::BytesInUse() const {
+        if (buffers_.empty())
+            return 0;
+        return retiredBytes_ + static_cast<size_t>(current_ - buffers_.back().start.get());
+    }
+
+    void TempMemory::RetainBuffer() {
+        const size_t used = BytesInUse();
+        retiredBytes_ = 0;
+
+        // the mark follows usage up immediately and decays by an eighth per call
+        highWater_ = std::max(used, highWater_ - highWater_ / 8);
+
+        const size_t ceiling = std::max(retentionCeiling.load(std::memory_order_relaxed), minimumBufferSize);
+        const size_t target = std::min(std::max(roundUp(highWater_ + highWater_ / 8), minimumBufferSize), ceiling);
+
+        // a chain means the last call outgrew its buffer, so coalesce it
+        // into one block, also give back memory once the mark has decayed well
+        // below what we are holding
+        const size_t currentSize = buffers_.back().size;
+        if (buffers_.size() > 1 || currentSize > 2 * target || currentSize > ceiling) {
+            DiscardBuffers();
+            PushNewBuffer(target);
+        }
+        else {
+            current_ = buffers_.front().start.get();
+            end_ = current_ + currentSize;
         }
-        offset_ = 0;
     }
 
     void TempMemory::InternalEnterExportedFunction() {
         if(depth_ == 0)
         {
             InternalFreeMemory(false);
+            increment(topLevelCalls_, 1);
         }
         ++depth_;
+        raise(peakDepth_, depth_);
     }
 
     void TempMemory::InternalLeaveExportedFunction() {
         --depth_;
-    }
-
-    TempMemory* TempMemory::CreateTempMemory() {
-        // we want to keep function entry
-        // as fast as possible, so to avoid
-        // needing a critical section around each call
-        // we use a double lock
-        ProtectInScope protecting(threadInfoVector);
-        TempMemory* threadStorage = tls.GetValue();
-        if(!threadStorage)
+        if(depth_ == 0)
         {
-            // see if any of the existing threads have died
-            // since we where last called
-            tempMemoryInstances.erase(std::remove_if(tempMemoryInstances.begin(), tempMemoryInstances.end(), threadIsDead), tempMemoryInstances.end());
-
-            // create the new memory object
-            TempMemoryPtr smartThreadStorage(new TempMemory);
-            threadStorage = smartThreadStorage.get();
-            tls.SetValue(threadStorage);
-            tempMemoryInstances.push_back(smartThreadStorage);
+            raise(peakBytesPerCall_, BytesInUse());
         }
-        return threadStorage;
     }
 
-
     void TempMemory::PushNewBuffer(size_t size) {
-        XlfBuffer newBuffer;
-        newBuffer.size = size;
-        newBuffer.start = shared_char_ptr(new char[size],CustomArrayDeleter<char>());;
-        freeList_.push_front(newBuffer);
-        offset_=0;
+        XlfBuffer newBuffer(AllocateBuffer(size));
+        if (!buffers_.empty()) {
+            retiredBytes_ += static_cast<size_t>(current_ - buffers_.back().start.get());
+            if (depth_ > 0)
+                increment(bufferGrowths_, 1);
+        }
+        current_ = newBuffer.start.get();
+        end_ = current_ + newBuffer.size;
+        buffers_.push_back(std::move(newBuffer));
+    }
+
+    TempMemory::XlfBuffer TempMemory::AllocateBuffer(size_t size) {
+        XlfBuffer result;
+        if (size >= largeBlockThreshold.load(std::memory_order_relaxed)) {
+            // reuse the smallest cached region that is big enough
+            BufferList::iterator best = regionCache_.end();
+            for (BufferList::iterator it = regionCache_.begin(); it != regionCache_.end(); ++it) {
+                if (it->size >= size && (best == regionCache_.end() || it->size < best->size))
+                    best = it;
+            }
+            if (best != regionCache_.end()) {
+                result = std::move(*best);
+                regionCache_.erase(best);
+                return result;
+            }
+            size_t mappedSize = size;
+            if (char* pages = mapPages(mappedSize)) {
+                const XlfBuffer::Release unmap = { mappedSize };
+                result.size = mappedSize;
+                result.start = std::unique_ptr<char, XlfBuffer::Release>(pages, unmap);
+            }
+        }
+        if (!result.start) {
+            result.size = size;
+            const XlfBuffer::Release remove = { 0 };
+            result.start = std::unique_ptr<char, XlfBuffer::Release>(new char[size], remove);
+        }
+        increment(buffersAllocated_, 1);
     #if !defined(NDEBUG)
-        std::cerr << "xlw is allocating a new buffer of " << static_cast<unsigned int>(size) << " bytes" << std::endl;
+        std::cerr << "xlw is allocating a new buffer of " << static_cast<unsigned int>(result.size) << " bytes" << std::endl;
     #endif
-        return;
+        return result;
+    }
+
+    void TempMemory::DiscardBuffers() {
+        const size_t ceiling = retentionCeiling.load(std::memory_order_relaxed);
+        for (BufferList::iterator it = buffers_.begin(); it != buffers_.end(); ++it) {
+            if (!it->start.get_deleter().mappedSize)
+                continue;
+            // when full make way by dropping the smallest region if it is smaller than this one
+            if (regionCache_.size() >= regionCacheEntries) {
+                BufferList::iterator smallest = regionCache_.begin();
+                for (BufferList::iterator cached = regionCache_.begin(); cached != regionCache_.end(); ++cached) {
+                    if (cached->size < smallest->size)
+                        smallest = cached;
+                }
+                if (smallest->size >= it->size)
+                    continue;
+                regionCache_.erase(smallest);
+            }
+            size_t cachedBytes = it->size;
+            for (BufferList::const_iterator cached = regionCache_.begin(); cached != regionCache_.end(); ++cached) {
+                cachedBytes += cached->size;
+            }
+            if (cachedBytes <= ceiling)
+                regionCache_.push_back(std::move(*it));
+        }
+        buffers_.clear();
     }
 
     char* TempMemory::InternalGetMemory(size_t bytes) {
-        if (freeList_.empty())
-            PushNewBuffer(8192);
-        XlfBuffer& buffer = freeList_.front();
-        if (offset_ + bytes > buffer.size) {
+        if (buffers_.empty()) {
+            PushNewBuffer(std::max(minimumBufferSize, bytes));
+        }
+        else {
             // if we need more space allocate either 50% more than last time
             // or enough to hold all the of data used on previous buffer and this data and a bit of spare
             // space, whichever is greater
-            PushNewBuffer(std::max((buffer.size * 3) / 2, (offset_ + bytes) + 4096));
-            // buffer no longer valid
-            memset(freeList_.front().start.get(), 0, bytes);
-            offset_ = bytes;
-            return freeList_.front().start.get();
-        }
-        else
-        {
-            size_t temp = offset_;
-            memset(buffer.start.get() + temp, 0, bytes);
-            offset_ += bytes;
-            return buffer.start.get() + temp;
+            const XlfBuffer& buffer = buffers_.back();
+            const size_t used = static_cast<size_t>(current_ - buffer.start.get());
+            PushNewBuffer(std::max((buffer.size * 3) / 2, used + bytes + 4096));
         }
+        char* result = current_;
+        current_ += bytes;
+        increment(bytesRequested_, bytes);
+        return result;
     }
 
     void TempMemory::InitializeProcess() {
@@ -181,43 +414,61 @@ namespace xlw {
         // left in case we do in the future
     }
 
+    void TempMemory::SetRetentionCeiling(size_t bytes) {
+        retentionCeiling.store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t TempMemory::GetRetentionCeiling() {
+        return retentionCeiling.load(std::memory_order_relaxed);
+    }
+
+    void TempMemory::SetLargeBlockThreshold(size_t bytes) {
+        largeBlockThreshold.store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t TempMemory::GetLargeBlockThreshold() {
+        return largeBlockThreshold.load(std::memory_order_relaxed);
+    }
+
     void TempMemory::TerminateProcess() {
-        ProtectInScope protecting(threadInfoVector);
-        for(size_t i(0); i < tempMemoryInstances.size(); ++i) {
-            tempMemoryInstances[i]->InternalFreeMemory(true);
+        std::lock_guard<std::mutex> lock(registryMutex());
+        std::vector<TempMemory*>& instances(registry());
+        for(size_t i(0); i < instances.size(); ++i) {
+            instances[i]->InternalFreeMemory(true);
         }
         // NOTE:
-        // we deliberately don't call tempMemoryInstances.clear()
-        // here as we can't remove the TLS info from other threads
-        // and it's possible for our addin to be reloaded and to reuse 
-        // calculation threads
+        // the arenas themselves stay registered, they belong to their
+        // threads and are released when each thread exits. It's possible
+        // for our addin to be reloaded and to reuse calculation threads
     }
-    
-    bool TempMemory::isThreadDead() const
-    {
-        HANDLE threadHandle(OpenThread(THREAD_QUERY_INFORMATION, FALSE, threadId_));
-        if(threadHandle) {
-            DWORD exitCode(0);
-            BOOL result = GetExitCodeThread(threadHandle, &exitCode);
-            CloseHandle(threadHandle);
-            if(result != 0) {
-                if(exitCode == STILL_ACTIVE) {
-                    // still running
-                    return false;
-                }
-                else {
-                    // it's gone
-                    return true;
-                }
-            }
-            else {
-                // fail safe and don't delete in this case
-                return false;
-            }
-        }
-        else {
-            // fail safe and don't delete in this case
-            return false;
+
+    TempMemory::Statistics TempMemory::Snapshot() const {
+        Statistics result;
+        result.bytesRequested = bytesRequested_.load(std::memory_order_relaxed);
+        result.buffersAllocated = buffersAllocated_.load(std::memory_order_relaxed);
+        result.bufferGrowths = bufferGrowths_.load(std::memory_order_relaxed);
+        result.topLevelCalls = topLevelCalls_.load(std::memory_order_relaxed);
+        result.peakBytesPerCall = peakBytesPerCall_.load(std::memory_order_relaxed);
+        result.peakDepth = peakDepth_.load(std::memory_order_relaxed);
+        result.threads = 1;
+        return result;
+    }
+
+    TempMemory::Statistics TempMemory::GetStatistics() {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        Statistics result(retiredStatistics());
+        const std::vector<TempMemory*>& instances(registry());
+        for(size_t i(0); i < instances.size(); ++i) {
+            merge(result, instances[i]->Snapshot());
         }
+        return result;
+    }
+
+    TempMemory::Statistics TempMemory::GetThreadStatistics() {
+        return ThreadInstance().Snapshot();
+    }
+
+    unsigned long long TempMemory::GetThreadBytesRequested() {
+        return ThreadInstance().bytesRequested_.load(std::memory_order_relaxed);
     }
 }
@@ -0,0 +1,71 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+// Worksheet access to the TempMemory counters. xlw.h forces the export
+// below so that this translation unit, and with it the registration,
+// is always linked in. It is registered under the add-in's name, as in
+// MyAddin.xlwTempMemoryStatistics.
+
+#include <xlw/TempMemory.h>
+#include <xlw/XlFunctionRegistration.h>
+#include <xlw/XlfOper.h>
+#include <xlw/CellMatrix.h>
+#include <xlw/macros.h>
+
+using namespace xlw;
+
+namespace
+{
+    XLRegistration::XLFunctionRegistrationHelper
+    registerTempMemoryStatistics("xlwTempMemoryStatistics",
+                                 "xlwTempMemoryStatistics",
+                                 "Scratch memory counters aggregated over all calculation threads ",
+                                 "xlw",
+                                 0,
+                                 0,
+                                 true,
+                                 true,
+                                 "",
+                                 "",
+                                 false,
+                                 false,
+                                 false,
+                                 true);
+
+    void addRow(CellMatrix& result, size_t row, const char* name, unsigned long long value)
+    {
+        result(row, 0) = name;
+        result(row, 1) = static_cast<double>(value);
+    }
+}
+
+extern "C"
+{
+    LPXLFOPER EXCEL_EXPORT xlwTempMemoryStatistics()
+    {
+        EXCEL_BEGIN;
+        const TempMemory::Statistics statistics(TempMemory::GetStatistics());
+        CellMatrix result(7, 2);
+        addRow(result, 0, "bytes requested", statistics.bytesRequested);
+        addRow(result, 1, "buffers allocated", statistics.buffersAllocated);
+        addRow(result, 2, "buffer growths", statistics.bufferGrowths);
+        addRow(result, 3, "top level calls", statistics.topLevelCalls);
+        addRow(result, 4, "peak bytes per call", statistics.peakBytesPerCall);
+        addRow(result, 5, "peak depth", statistics.peakDepth);
+        addRow(result, 6, "threads", statistics.threads);
+        return XlfOper(result);
+        EXCEL_END;
+    }
+}
@@ -24,8 +24,9 @@
 // $Id$
 
 #include <xlw/Win32StreamBuf.h>
+#include <cstdio>
 
-#if !(_WIN32_WINNT >= 0x0400) && !(_WIN32_WINDOWS > 0x0400)
+#if defined(_WIN32) && !(_WIN32_WINNT >= 0x0400) && !(_WIN32_WINDOWS > 0x0400)
     //! Helper method if IsDebuggerPresent is not available.
     /*!
     This replacement for IsDebuggerPresent returns true if the program
@@ -47,6 +48,14 @@ the put area and send it to the debug window using OutputDebugString.
 */
 void xlw::Win32StreamBuf::SendToDebugWindow()
 {
-    if (IsDebuggerPresent() && !buf_.empty())
-        ::OutputDebugString(buf_.c_str());
+#if defined(_WIN32)
+    const std::string& text(buffer());
+    if (IsDebuggerPresent() && !text.empty())
+        ::OutputDebugString(text.c_str());
+#else
+    // no debugger window so use the C stream, which std::cerr no longer reaches
+    const std::string& text(buffer());
+    if (!text.empty())
+        std::fputs(text.c_str(), stderr);
+#endif
 }
@@ -18,10 +18,11 @@ FOR A PARTICULAR PURPOSE.  See the license for more details.
 
 
 #include <xlw/XlFunctionRegistration.h>
-#include <xlw/xlfFuncDesc.h>
-#include <xlw/xlfCmdDesc.h>
-#include <xlw/xlfArgDescList.h>
+#include <xlw/XlfFuncDesc.h>
+#include <xlw/XlfCmdDesc.h>
+#include <xlw/XlfArgDescList.h>
 #include <stdio.h>
+#include <cctype>
 #include <fstream>
 #include <sstream>
 
@@ -40,7 +41,8 @@ XLFunctionRegistrationData::XLFunctionRegistrationData(const std::string& Functi
     const std::string& HelpID_,
     bool Asynchronous_,
     bool MacroSheetEquivalent_,
-    bool ClusterSafe_)
+    bool ClusterSafe_,
+    bool AddinQualified_)
     :                FunctionName(FunctionName_),
     ExcelFunctionName(ExcelFunctionName_),
     FunctionDescription(FunctionDescription_),
@@ -52,7 +54,8 @@ XLFunctionRegistrationData::XLFunctionRegistrationData(const std::string& Functi
     helpID(HelpID_),
     Asynchronous(Asynchronous_),
     MacroSheetEquivalent(MacroSheetEquivalent_),
-    ClusterSafe(ClusterSafe_)
+    ClusterSafe(ClusterSafe_),
+    AddinQualified(AddinQualified_)
 {
 
     ArgumentNames.reserve(NoOfArguments);
@@ -159,7 +162,8 @@ XLFunctionRegistrationHelper::XLFunctionRegistrationHelper(const std::string& Fu
     const std::string& helpID,
     bool Asynchronous,
     bool MacroSheetEquivalent,
-    bool ClusterSafe)
+    bool ClusterSafe,
+    bool AddinQualified)
 {
     XLFunctionRegistrationData tmp(FunctionName,
         ExcelFunctionName,
@@ -173,7 +177,8 @@ XLFunctionRegistrationHelper::XLFunctionRegistrationHelper(const std::string& Fu
         helpID,
         Asynchronous,
         MacroSheetEquivalent,
-        ClusterSafe);
+        ClusterSafe,
+        AddinQualified);
 
     ExcelFunctionRegistrationRegistry::Instance().AddFunction(tmp);
 }
@@ -182,23 +187,51 @@ XLCommandRegistrationHelper::XLCommandRegistrationHelper(const std::string& Comm
     const std::string& ExcelCommandName,
     const std::string& Comment,
     const std::string& Menu,
-    const std::string& MenuText)
+    const std::string& MenuText,
+    bool AddinQualified)
 {
     XLCommandRegistrationData tmp(CommandName,
         ExcelCommandName,
         Comment,
         Menu,
-        MenuText);
+        MenuText,
+        AddinQualified);
 
     ExcelFunctionRegistrationRegistry::Instance().AddCommand(tmp);
 }
 
+std::string xlw::XLRegistration::AddinQualifiedName(const std::string& name)
+{
+    // the file name without its directory or extension
+    std::string addin(XlfExcel::Instance().GetName());
+    std::string::size_type slash = addin.find_last_of("\\/");
+    if (slash != std::string::npos)
+        addin.erase(0, slash + 1);
+    std::string::size_type dot = addin.find_last_of('.');
+    if (dot != std::string::npos)
+        addin.erase(dot);
+    if (addin.empty())
+        return name;
+
+    // Excel names are letters, digits, full stops and underscores
+    for (std::string::size_type i = 0; i < addin.size(); ++i)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(addin[i])) && addin[i] != '.')
+            addin[i] = '_';
+    }
+    if (!std::isalpha(static_cast<unsigned char>(addin[0])))
+        addin.insert(0, 1, '_');
+    return addin + "." + name;
+}
+
 void ExcelFunctionRegistrationRegistry::DoTheRegistrations() const
 {
     int counter(1);
 
     for (functionCache::const_iterator it = Functions.begin(); it !=  Functions.end(); ++it)
     {
+        if (Qualified.count(it->first))
+            it->second->SetAlias(AddinQualifiedName(it->first));
         it->second->Register(counter);
         ++counter;
     }
@@ -206,6 +239,8 @@ void ExcelFunctionRegistrationRegistry::DoTheRegistrations() const
 
     for (commandCache::const_iterator it = Commands.begin(); it !=  Commands.end(); ++it)
     {
+        if (Qualified.count(it->first))
+            it->second->SetAlias(AddinQualifiedName(it->first));
         it->second->Register(counter);
         it->second->AddToMenuBar();
         ++counter;
@@ -258,6 +293,10 @@ void ExcelFunctionRegistrationRegistry::AddFunction(const XLFunctionRegistration
  
     xlFunction->SetArguments(xlFunctionArgs);
     Functions[data.GetExcelFunctionName()] = xlFunction;
+    if (data.GetAddinQualified())
+        Qualified.insert(data.GetExcelFunctionName());
+    if (data.GetAsynchronous())
+        Asynchronous = true;
 }
 void ExcelFunctionRegistrationRegistry::AddCommand(const XLCommandRegistrationData& data)
 {
@@ -271,6 +310,8 @@ void ExcelFunctionRegistrationRegistry::AddCommand(const XLCommandRegistrationDa
             !data.GetMenu().empty()));
 
         Commands[data.GetExcelCommandName()] = theCommand;
+        if (data.GetAddinQualified())
+            Qualified.insert(data.GetExcelCommandName());
 }
 
 void ExcelFunctionRegistrationRegistry::GenerateChmBuilderConfig(const std::string& fileName)
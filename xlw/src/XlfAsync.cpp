@@ -0,0 +1,411 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include <xlw/XlfAsync.h>
+#include <xlw/XlFunctionRegistration.h>
+#include <xlw/XlOpenClose.h>
+#include <xlw/XlfCmdDesc.h>
+#include <xlw/XlfException.h>
+#include <xlw/XlfExcel.h>
+#include <xlw/XlfOper.h>
+#include "FlatOper.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // the most results given to one call of xlAsyncReturn
+    const size_t batchLimit = 64;
+    const unsigned long long noTask = ~0ULL;
+
+    // the calculation the task this thread is running belongs to
+    thread_local unsigned long long taskGeneration = noTask;
+
+    struct Job
+    {
+        XLOPER12 handle;
+        unsigned long long generation;
+        xlw::XlfAsync::Task task;
+    };
+
+    // a result waiting to be returned, flattened so that it outlives the
+    // TempMemory of the thread that worked it out
+    struct Result
+    {
+        XLOPER12 handle;
+        unsigned long long generation;
+        std::string value;
+        bool isArray;
+    };
+
+    void setError(Result& result, int error)
+    {
+        XLOPER12 oper;
+        oper.xltype = xltypeErr;
+        oper.val.err = error;
+        xlw::FlatOper::Flatten(oper, result.value);
+        result.isArray = false;
+    }
+
+    void makeResult(Result& result, const XLOPER12* value)
+    {
+        // as for a synchronous function, a null result shows as #NUM!
+        if (!value)
+            setError(result, xlerrNum);
+        else if (!xlw::FlatOper::Flatten(*value, result.value))
+            setError(result, xlerrValue);
+        else
+            result.isArray = (value->xltype & 0xFFF) == xltypeMulti;
+    }
+
+    class Pool
+    {
+    public:
+        Pool() :
+            Limit(std::max(2u, std::thread::hardware_concurrency())), Live(0), Idle(0),
+            Stopping(false), Delivering(false), Generation(0),
+            Submitted(0), Completed(0), Returned(0), Batches(0), Dropped(0)
+        {}
+
+        void run();
+        // starts a thread if there is more to do than idle threads to do it
+        void grow(size_t waiting);
+        void deliver(std::unique_lock<std::mutex>& lock);
+        void drop();
+        // joins the threads that have left run after Limit was lowered
+        void reap();
+
+        std::mutex Mutex;
+        std::condition_variable Work;
+        std::deque<Job> Jobs;
+        std::deque<Result> Results;
+        std::vector<std::thread> Threads;
+        std::vector<std::thread> Exited;
+        size_t Limit;
+        size_t Live;
+        size_t Idle;
+        bool Stopping;
+        bool Delivering;
+        std::atomic<unsigned long long> Generation;
+
+        unsigned long long Submitted;
+        unsigned long long Completed;
+        unsigned long long Returned;
+        unsigned long long Batches;
+        unsigned long long Dropped;
+    };
+
+    // the threads may still be finishing as the add-in's statics are
+    // destroyed, so the pool is leaked
+    Pool& pool()
+    {
+        static Pool* thePool = new Pool;
+        return *thePool;
+    }
+
+    void returnResults(std::vector<Result>& batch)
+    {
+        // the blocks are copied out to be rebased, into XLOPER12s so they are aligned
+        std::vector<std::vector<XLOPER12> > copies(batch.size());
+        std::vector<XLOPER12> handles(batch.size());
+        std::vector<XLOPER12> values(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i)
+        {
+            const std::string& value = batch[i].value;
+            copies[i].resize((value.size() + sizeof(XLOPER12) - 1) / sizeof(XLOPER12));
+            std::copy(value.begin(), value.end(), reinterpret_cast<char*>(&copies[i][0]));
+            values[i] = *xlw::FlatOper::Rebase(reinterpret_cast<char*>(&copies[i][0]));
+            handles[i] = batch[i].handle;
+        }
+
+        XLOPER12 handleArray, valueArray;
+        LPXLOPER12 arguments[2] = { &handles[0], &values[0] };
+        if (batch.size() > 1)
+        {
+            handleArray.xltype = valueArray.xltype = xltypeMulti;
+            handleArray.val.array.rows = valueArray.val.array.rows = 1;
+            handleArray.val.array.columns = valueArray.val.array.columns = static_cast<COL>(batch.size());
+            handleArray.val.array.lparray = &handles[0];
+            valueArray.val.array.lparray = &values[0];
+            arguments[0] = &handleArray;
+            arguments[1] = &valueArray;
+        }
+
+        XLOPER12 returned;
+        returned.xltype = xltypeNil;
+        int err = xlw::XlfExcel::Instance().Call12v(xlAsyncReturn, &returned, 2, arguments);
+
+        std::lock_guard<std::mutex> lock(pool().Mutex);
+        ++pool().Batches;
+        if (err == xlretSuccess)
+            pool().Returned += batch.size();
+    }
+}
+
+void Pool::run()
+{
+    std::unique_lock<std::mutex> lock(Mutex);
+    for (;;)
+    {
+        ++Idle;
+        Work.wait(lock, [this]() { return Stopping || Live > Limit || !Jobs.empty() || (!Results.empty() && !Delivering); });
+        --Idle;
+        if (Stopping || Live > Limit)
+        {
+            --Live;
+            // Shutdown has taken the threads to join them itself
+            for (size_t i = 0; i < Threads.size(); ++i)
+            {
+                if (Threads[i].get_id() == std::this_thread::get_id())
+                {
+                    Exited.push_back(std::move(Threads[i]));
+                    Threads.erase(Threads.begin() + i);
+                    break;
+                }
+            }
+            return;
+        }
+        if (Jobs.empty())
+        {
+            deliver(lock);
+            continue;
+        }
+
+        Job job(std::move(Jobs.front()));
+        Jobs.pop_front();
+        lock.unlock();
+
+        Result result;
+        result.handle = job.handle;
+        result.generation = job.generation;
+        if (job.generation == Generation.load())
+        {
+            taskGeneration = job.generation;
+            try
+            {
+                makeResult(result, job.task());
+            }
+            catch (...)
+            {
+                setError(result, xlerrValue);
+            }
+            taskGeneration = noTask;
+        }
+        // the arguments the task holds are freed before taking the lock
+        job.task = xlw::XlfAsync::Task();
+
+        lock.lock();
+        ++Completed;
+        if (result.generation == Generation.load() && !result.value.empty())
+            Results.push_back(std::move(result));
+        else
+            ++Dropped;
+        if (!Delivering)
+            deliver(lock);
+    }
+}
+
+void Pool::grow(size_t waiting)
+{
+    if (waiting > Idle && Live < Limit)
+    {
+        reap();
+        ++Live;
+        Threads.push_back(std::thread([]() { pool().run(); }));
+    }
+}
+
+void Pool::reap()
+{
+    // a thread in Exited has let go of the lock taken here, so is already returning
+    for (size_t i = 0; i < Exited.size(); ++i)
+        Exited[i].join();
+    Exited.clear();
+}
+
+void Pool::deliver(std::unique_lock<std::mutex>& lock)
+{
+    // Results that finish while a batch is being returned are left for
+    // this thread, so they go back together in the next one. Arrays go on
+    // their own, as Excel doesn't take arrays of arrays.
+    Delivering = true;
+    std::vector<Result> batch;
+    while (!Results.empty() && !Stopping)
+    {
+        batch.clear();
+        while (!Results.empty() && batch.size() < batchLimit)
+        {
+            Result& next = Results.front();
+            if (next.generation != Generation.load())
+            {
+                ++Dropped;
+                Results.pop_front();
+                continue;
+            }
+            if (!batch.empty() && (next.isArray || batch.front().isArray))
+                break;
+            batch.push_back(std::move(next));
+            Results.pop_front();
+        }
+        if (batch.empty())
+            break;
+        lock.unlock();
+        returnResults(batch);
+        lock.lock();
+    }
+    Delivering = false;
+}
+
+void Pool::drop()
+{
+    ++Generation;
+    Dropped += Jobs.size() + Results.size();
+    Jobs.clear();
+    Results.clear();
+}
+
+void xlw::XlfAsync::Submit(const XLOPER12* handle, Task task)
+{
+    Pool& thePool(pool());
+    Job job;
+    job.handle = *handle;
+    job.generation = thePool.Generation.load();
+    job.task.swap(task);
+
+    std::lock_guard<std::mutex> lock(thePool.Mutex);
+    thePool.Jobs.push_back(std::move(job));
+    ++thePool.Submitted;
+    thePool.grow(thePool.Jobs.size());
+    thePool.Work.notify_one();
+}
+
+void xlw::XlfAsync::Return(const XLOPER12* handle, const XLOPER12* result)
+{
+    Pool& thePool(pool());
+    Result flat;
+    flat.handle = *handle;
+    flat.generation = thePool.Generation.load();
+    makeResult(flat, result);
+
+    // returned by a thread of the pool, as the caller is still inside Excel
+    std::lock_guard<std::mutex> lock(thePool.Mutex);
+    thePool.Results.push_back(std::move(flat));
+    thePool.grow(1);
+    thePool.Work.notify_one();
+}
+
+bool xlw::XlfAsync::Cancelled()
+{
+    return taskGeneration != noTask && taskGeneration != pool().Generation.load();
+}
+
+void xlw::XlfAsync::SetThreadCount(size_t count)
+{
+    std::lock_guard<std::mutex> lock(pool().Mutex);
+    pool().Limit = std::max<size_t>(count, 1);
+    pool().Work.notify_all();
+}
+
+size_t xlw::XlfAsync::GetThreadCount()
+{
+    std::lock_guard<std::mutex> lock(pool().Mutex);
+    return pool().Limit;
+}
+
+void xlw::XlfAsync::Shutdown()
+{
+    Pool& thePool(pool());
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(thePool.Mutex);
+        thePool.Stopping = true;
+        thePool.drop();
+        threads.swap(thePool.Threads);
+        thePool.reap();
+        thePool.Work.notify_all();
+    }
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    // a later call starts the pool again
+    std::lock_guard<std::mutex> lock(thePool.Mutex);
+    thePool.Stopping = false;
+}
+
+xlw::XlfAsync::Statistics xlw::XlfAsync::GetStatistics()
+{
+    Pool& thePool(pool());
+    std::lock_guard<std::mutex> lock(thePool.Mutex);
+    Statistics result;
+    result.submitted = thePool.Submitted;
+    result.completed = thePool.Completed;
+    result.returned = thePool.Returned;
+    result.batches = thePool.Batches;
+    result.dropped = thePool.Dropped;
+    result.queued = thePool.Jobs.size();
+    result.threads = thePool.Live;
+    return result;
+}
+
+void xlw::XlfAsync::CalculationCanceled()
+{
+    std::lock_guard<std::mutex> lock(pool().Mutex);
+    pool().drop();
+}
+
+extern "C"
+{
+    // registered for xleventCalculationCanceled when the add-in has asynchronous functions
+    int EXCEL_EXPORT xlwAsyncCalculationCanceled()
+    {
+        xlw::XlfAsync::CalculationCanceled();
+        return 1;
+    }
+}
+
+namespace
+{
+    void registerEvents()
+    {
+        if (!xlw::XlfExcel::Instance().excel14() ||
+            !xlw::XLRegistration::ExcelFunctionRegistrationRegistry::Instance().HasAsynchronousFunctions())
+            return;
+
+        // every add-in with asynchronous functions has one, so it goes by the add-in's name
+        static std::string name(xlw::XLRegistration::AddinQualifiedName("xlwAsyncCalculationCanceled"));
+        static xlw::XlfCmdDesc canceled("xlwAsyncCalculationCanceled", name,
+            "Drops the asynchronous work of a cancelled calculation", "", "", true);
+        canceled.Register(0);
+
+        xlw::XlfOper registered;
+        int err = xlw::XlfExcel::Instance().Call12(xlEventRegister, registered, 2,
+            xlw::XlfOper(name), xlw::XlfOper(static_cast<double>(xleventCalculationCanceled)));
+        if (err != xlretSuccess)
+            std::cerr << XLW__HERE__ << "Error " << err << " while registering for cancelled calculations" << std::endl;
+    }
+
+    xlw::MacroCache<xlw::Open>::MacroRegistra asyncEventsRegistra("xlwAsyncEvents",
+        "Registers for the events asynchronous functions need", registerEvents);
+    xlw::MacroCache<xlw::Close>::MacroRegistra asyncShutdownRegistra("xlwAsyncShutdown",
+        "Stops the threads running asynchronous functions", xlw::XlfAsync::Shutdown);
+}
@@ -33,7 +33,13 @@
 #include <xlw/macros.h>
 #include <xlw/TempMemory.h>
 #include <assert.h>
+#include <cwchar>
+#include <atomic>
+#include <chrono>
 
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
 
 
 namespace
@@ -41,8 +47,13 @@ namespace
     // wrap up winapi way of checking for file existance
     bool doesFileExist(const std::string& fileName)
     {
+#if defined(_WIN32)
         DWORD attributes(GetFileAttributes(fileName.c_str()));
         return ((attributes != INVALID_FILE_ATTRIBUTES) && ((attributes & FILE_ATTRIBUTE_DIRECTORY) == 0));
+#else
+        struct stat attributes;
+        return stat(fileName.c_str(), &attributes) == 0 && S_ISREG(attributes.st_mode);
+#endif
     }
 }
 
@@ -51,9 +62,13 @@ xlw::XlfExcel *xlw::XlfExcel::this_ = 0;
 //! Internal implementation of XlfExcel.
 struct xlw::XlfExcelImpl {
     //! Ctor.
-    XlfExcelImpl(): handle_(0) {}
+    XlfExcelImpl(): handle_(0), noFuncWizUntil_(0), funcWizCacheInterval_(100) {}
     //! Handle to the DLL module.
     HINSTANCE handle_;
+    //! Milliseconds on the steady clock until which the function wizard is taken not to be open.
+    std::atomic<unsigned long long> noFuncWizUntil_;
+    //! Milliseconds for which that is trusted.
+    std::atomic<unsigned long> funcWizCacheInterval_;
 };
 
 /*!
@@ -89,6 +104,8 @@ bool xlw::XlfExcel::IsEscPressed() const {
     return ret.AsBool();
 }
 
+#if defined(_WIN32)
+
 // classes and structs needed for search for window with Excel 4
 namespace
 {
@@ -157,6 +174,20 @@ HINSTANCE xlw::XlfExcel::GetExcelInstance()
     return (HINSTANCE)GetWindowLongPtr(GetMainWindow(), GWLP_HINSTANCE);
 }
 
+#else
+
+HWND xlw::XlfExcel::GetMainWindow()
+{
+    THROW_XLW("Excel has no main window on this platform");
+}
+
+HINSTANCE xlw::XlfExcel::GetExcelInstance()
+{
+    THROW_XLW("Excel has no instance handle on this platform");
+}
+
+#endif
+
 #if defined(_MSC_VER) && _MSC_VER < 1400
 #pragma warning(pop)
 #endif
@@ -192,7 +223,7 @@ int get_excel_version() {
     }
     else if(xRet1.xltype == xltypeStr)
     {
-        version = _wtoi(xRet1.val.str + 1);
+        version = static_cast<int>(std::wcstol(xRet1.val.str + 1, 0, 10));
     }
     Excel12(xlFree, 0, 1, &xRet1);
     return version;
@@ -203,9 +234,14 @@ Load \c XlfCALL32.DLL to interface excel (this library is shipped with Excel)
 and link it to the XLL.
 */
 void xlw::XlfExcel::InitLibrary() {
+#if defined(_WIN32)
     HINSTANCE handle = LoadLibrary("XLCALL32.DLL");
     if (handle == 0)
         THROW_XLW("Could not load library XLCALL32.DLL");
+#else
+    // the host exports the callback into our own process
+    HINSTANCE handle = 0;
+#endif
 
 
     excelVersion_ = get_excel_version();
@@ -245,7 +281,11 @@ void xlw::XlfExcel::InitLibrary() {
 
     LookForHelp();
 
+#if defined(_WIN32)
     m_mainExcelThread = GetCurrentThreadId();
+#else
+    m_mainExcelThread = 0;
+#endif
 }
 
 const std::string& xlw::XlfExcel::GetName() const {
@@ -390,6 +430,8 @@ int xlw::XlfExcel::Call12v(int xlfn, LPXLOPER12 pxResult, int count, const LPXLO
     return xlret;
 }
 
+#if defined(_WIN32)
+
 namespace {
 
 //! Needed by IsCalledByFuncWiz.
@@ -431,12 +473,46 @@ bool CALLBACK EnumProc(HWND hwnd, LPEnumStruct pEnum) {
 
 } // empty namespace
 
+/*!
+Looking through Excel's windows costs more than many functions do, so
+having not found the wizard we don't look again for a while. Finding it is
+never remembered: the wizard evaluates once a keystroke, and the recalc
+when it closes must not be mistaken for it.
+*/
 bool xlw::XlfExcel::IsCalledByFuncWiz() const {
+    if (GetCurrentThreadId() != m_mainExcelThread)
+        return false;
+
+    unsigned long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (now < impl_->noFuncWizUntil_.load(std::memory_order_relaxed))
+        return false;
+
     EnumStruct enm;
 
     enm.bFuncWiz = false;
     EnumThreadWindows(m_mainExcelThread, (WNDENUMPROC) EnumProc,
         (LPARAM) ((LPEnumStruct)  &enm));
+    if (!enm.bFuncWiz)
+        impl_->noFuncWizUntil_.store(now + impl_->funcWizCacheInterval_.load(std::memory_order_relaxed), std::memory_order_relaxed);
     return enm.bFuncWiz;
 }
 
+#else
+
+bool xlw::XlfExcel::IsCalledByFuncWiz() const {
+    // there is no function wizard outside Excel on Windows
+    return false;
+}
+
+#endif
+
+void xlw::XlfExcel::SetFuncWizCacheInterval(unsigned long milliseconds) {
+    impl_->funcWizCacheInterval_.store(milliseconds, std::memory_order_relaxed);
+    ResetFuncWizCache();
+}
+
+void xlw::XlfExcel::ResetFuncWizCache() {
+    impl_->noFuncWizUntil_.store(0, std::memory_order_relaxed);
+}
+
@@ -38,7 +38,8 @@ XlfAbstractCmdDesc::XlfAbstractCmdDesc.
 \param category Category in which the function should appear.
 \param recalcPolicy Policy to recalculate the cell.
 \param Threadsafe Whether this function should be registered threadsafe under Excel 12
-\param returnTypeCode The excel code for the datatype of the return value
+\param returnTypeCode The excel code for the datatype of the return value, or the number (1 to 9)
+of a K% argument that Excel should take as the result once it is modified in place
 \param helpID the help id for the function in the chm help file
 \param Asynchronous does this function run Asynchronously
 \param MacroSheetEquivalent should calling Excel Macro function be allowed, incompatible with multi-threading
@@ -0,0 +1,372 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include <xlw/XlfProfiler.h>
+#include <xlw/TempMemory.h>
+#include "Registry.h"
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+
+namespace
+{
+    typedef xlw::Registry<xlw::XlfProfiler> ProfilerRegistry;
+
+    // slots aren't reused, so a thread's table never points a new profiler
+    // at the counters of one that has gone
+    size_t nextSlot = 0;
+
+    std::atomic<bool> profilingEnabled(true);
+
+    // each thread's counters, by the slot of their profiler
+    std::vector<xlw::XlfProfiler::Counters*>& threadTable()
+    {
+        static thread_local std::vector<xlw::XlfProfiler::Counters*> theTable;
+        return theTable;
+    }
+
+    inline unsigned long long now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    inline unsigned int floorLog2(unsigned long long value)
+    {
+        unsigned int result = 0;
+        for (unsigned int shift = 32; shift > 0; shift /= 2)
+        {
+            if (value >> shift)
+            {
+                value >>= shift;
+                result += shift;
+            }
+        }
+        return result;
+    }
+
+    // only the owning thread writes its counters so a plain load and store
+    // is enough, as for TempMemory's
+    inline void increment(std::atomic<unsigned long long>& counter, unsigned long long amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    inline void raise(std::atomic<unsigned long long>& counter, unsigned long long value)
+    {
+        if (value > counter.load(std::memory_order_relaxed))
+            counter.store(value, std::memory_order_relaxed);
+    }
+
+    double microseconds(double seconds)
+    {
+        return seconds * 1e6;
+    }
+}
+
+struct xlw::XlfProfiler::Counters
+{
+    Counters()
+    {
+        calls.store(0, std::memory_order_relaxed);
+        exceptions.store(0, std::memory_order_relaxed);
+        bytes.store(0, std::memory_order_relaxed);
+        for (size_t phase = 0; phase < phaseCount; ++phase)
+        {
+            for (size_t bucket = 0; bucket < Histogram::bucketCount; ++bucket)
+                counts[phase][bucket].store(0, std::memory_order_relaxed);
+            totalNanoseconds[phase].store(0, std::memory_order_relaxed);
+            maxNanoseconds[phase].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void record(size_t phase, unsigned long long nanoseconds)
+    {
+        increment(counts[phase][Histogram::Bucket(nanoseconds)], 1);
+        increment(totalNanoseconds[phase], nanoseconds);
+        raise(maxNanoseconds[phase], nanoseconds);
+    }
+
+    std::atomic<unsigned long long> calls;
+    std::atomic<unsigned long long> exceptions;
+    std::atomic<unsigned long long> bytes;
+    std::atomic<unsigned long long> counts[phaseCount][Histogram::bucketCount];
+    std::atomic<unsigned long long> totalNanoseconds[phaseCount];
+    std::atomic<unsigned long long> maxNanoseconds[phaseCount];
+};
+
+xlw::XlfProfiler::Histogram::Histogram() : totalNanoseconds(0), maxNanoseconds(0)
+{
+    std::fill(counts, counts + bucketCount, 0ULL);
+}
+
+size_t xlw::XlfProfiler::Histogram::Bucket(unsigned long long nanoseconds)
+{
+    // below subBuckets each nanosecond has its own bucket, above it each
+    // power of two is split into subBuckets by the next two bits
+    if (nanoseconds < subBuckets)
+        return static_cast<size_t>(nanoseconds);
+    unsigned int power = floorLog2(nanoseconds);
+    size_t bucket = (power - 1) * subBuckets + static_cast<size_t>((nanoseconds >> (power - 2)) & (subBuckets - 1));
+    return std::min<size_t>(bucket, bucketCount - 1);
+}
+
+unsigned long long xlw::XlfProfiler::Histogram::LowerBound(size_t bucket)
+{
+    if (bucket < subBuckets)
+        return bucket;
+    unsigned int power = static_cast<unsigned int>(bucket / subBuckets) + 1;
+    return static_cast<unsigned long long>(subBuckets + bucket % subBuckets) << (power - 2);
+}
+
+unsigned long long xlw::XlfProfiler::Histogram::Count() const
+{
+    unsigned long long result = 0;
+    for (size_t i = 0; i < bucketCount; ++i)
+        result += counts[i];
+    return result;
+}
+
+double xlw::XlfProfiler::Histogram::Mean() const
+{
+    unsigned long long count = Count();
+    return count ? totalNanoseconds * 1e-9 / count : 0.0;
+}
+
+double xlw::XlfProfiler::Histogram::Percentile(double fraction) const
+{
+    unsigned long long count = Count();
+    if (!count)
+        return 0.0;
+    unsigned long long wanted = std::max(1ULL, static_cast<unsigned long long>(fraction * count + 0.5));
+    unsigned long long seen = 0;
+    for (size_t i = 0; i < bucketCount; ++i)
+    {
+        seen += counts[i];
+        if (seen >= wanted)
+        {
+            if (i + 1 == bucketCount)
+                return Max();
+            double middle = 0.5 * (LowerBound(i) + LowerBound(i + 1));
+            return std::min(middle, static_cast<double>(maxNanoseconds)) * 1e-9;
+        }
+    }
+    return Max();
+}
+
+double xlw::XlfProfiler::Histogram::Max() const
+{
+    return maxNanoseconds * 1e-9;
+}
+
+xlw::XlfProfiler::Call::Call(XlfProfiler& profiler)
+    : Counters_(profilingEnabled.load(std::memory_order_relaxed) ? profiler.threadCounters() : 0),
+      Start(0), Converted_(0), Called_(0), Bytes(0)
+{
+    if (Counters_)
+    {
+        Bytes = TempMemory::GetThreadBytesRequested();
+        Start = now();
+    }
+}
+
+xlw::XlfProfiler::Call::~Call()
+{
+    if (Counters_)
+    {
+        increment(Counters_->exceptions, 1);
+        increment(Counters_->bytes, TempMemory::GetThreadBytesRequested() - Bytes);
+    }
+}
+
+void xlw::XlfProfiler::Call::Converted()
+{
+    if (Counters_)
+        Converted_ = now();
+}
+
+void xlw::XlfProfiler::Call::Called()
+{
+    if (Counters_)
+    {
+        Called_ = now();
+        if (!Converted_)
+            Converted_ = Start;
+    }
+}
+
+void xlw::XlfProfiler::Call::Finished()
+{
+    if (!Counters_)
+        return;
+
+    unsigned long long end = now();
+    if (!Converted_)
+        Converted_ = Start;
+    if (!Called_)
+        Called_ = Converted_;
+    Counters_->record(Conversion, Converted_ - Start);
+    Counters_->record(Function, Called_ - Converted_);
+    Counters_->record(Marshalling, end - Called_);
+    increment(Counters_->calls, 1);
+    increment(Counters_->bytes, TempMemory::GetThreadBytesRequested() - Bytes);
+    Counters_ = 0;
+}
+
+xlw::XlfProfiler::XlfProfiler(const std::string& functionName) : Name(functionName)
+{
+    std::lock_guard<std::mutex> lock(ProfilerRegistry::Mutex());
+    Slot = nextSlot++;
+    ProfilerRegistry::Entries().push_back(this);
+}
+
+xlw::XlfProfiler::~XlfProfiler()
+{
+    std::lock_guard<std::mutex> lock(ProfilerRegistry::Mutex());
+    std::vector<XlfProfiler*>& profilers(ProfilerRegistry::Entries());
+    profilers.erase(std::remove(profilers.begin(), profilers.end(), this), profilers.end());
+}
+
+xlw::XlfProfiler::Counters* xlw::XlfProfiler::threadCounters()
+{
+    std::vector<Counters*>& table(threadTable());
+    if (Slot < table.size() && table[Slot])
+        return table[Slot];
+
+    // the thread's first call, its counters belong to the profiler so
+    // they are still counted once the thread has gone
+    std::unique_ptr<Counters> counters(new Counters);
+    Counters* result = counters.get();
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Threads.push_back(std::move(counters));
+    }
+    if (table.size() <= Slot)
+        table.resize(Slot + 1, 0);
+    table[Slot] = result;
+    return result;
+}
+
+xlw::XlfProfiler::Statistics xlw::XlfProfiler::GetStatistics() const
+{
+    Statistics result;
+    result.calls = 0;
+    result.exceptions = 0;
+    result.bytes = 0;
+
+    std::lock_guard<std::mutex> lock(Mutex);
+    for (size_t i = 0; i < Threads.size(); ++i)
+    {
+        const Counters& counters(*Threads[i]);
+        result.calls += counters.calls.load(std::memory_order_relaxed);
+        result.exceptions += counters.exceptions.load(std::memory_order_relaxed);
+        result.bytes += counters.bytes.load(std::memory_order_relaxed);
+        for (size_t phase = 0; phase < phaseCount; ++phase)
+        {
+            Histogram& histogram(result.phases[phase]);
+            for (size_t bucket = 0; bucket < Histogram::bucketCount; ++bucket)
+                histogram.counts[bucket] += counters.counts[phase][bucket].load(std::memory_order_relaxed);
+            histogram.totalNanoseconds += counters.totalNanoseconds[phase].load(std::memory_order_relaxed);
+            histogram.maxNanoseconds = std::max(histogram.maxNanoseconds,
+                counters.maxNanoseconds[phase].load(std::memory_order_relaxed));
+        }
+    }
+    return result;
+}
+
+std::vector<xlw::XlfProfiler*> xlw::XlfProfiler::Profilers()
+{
+    std::lock_guard<std::mutex> lock(ProfilerRegistry::Mutex());
+    return ProfilerRegistry::Entries();
+}
+
+void xlw::XlfProfiler::SetEnabled(bool enabled)
+{
+    profilingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool xlw::XlfProfiler::IsEnabled()
+{
+    return profilingEnabled.load(std::memory_order_relaxed);
+}
+
+const char* xlw::XlfProfiler::PhaseName(Phase phase)
+{
+    switch (phase)
+    {
+    case Conversion:
+        return "conversion";
+    case Function:
+        return "function";
+    case Marshalling:
+        return "marshalling";
+    default:
+        return "";
+    }
+}
+
+void xlw::XlfProfiler::Dump(std::ostream& out)
+{
+    std::vector<XlfProfiler*> profilers(Profilers());
+    std::vector<Statistics> statistics(profilers.size());
+    for (size_t i = 0; i < profilers.size(); ++i)
+        statistics[i] = profilers[i]->GetStatistics();
+
+    out << "function,calls,exceptions,bytes per call";
+    for (size_t phase = 0; phase < phaseCount; ++phase)
+    {
+        const char* name = PhaseName(static_cast<Phase>(phase));
+        out << ',' << name << " mean us," << name << " p50 us," << name << " p90 us,"
+            << name << " p99 us," << name << " max us";
+    }
+    out << '\n';
+    for (size_t i = 0; i < profilers.size(); ++i)
+    {
+        const Statistics& s(statistics[i]);
+        unsigned long long made = s.calls + s.exceptions;
+        if (!made)
+            continue;
+        out << profilers[i]->FunctionName() << ',' << s.calls << ',' << s.exceptions << ','
+            << static_cast<double>(s.bytes) / made;
+        for (size_t phase = 0; phase < phaseCount; ++phase)
+        {
+            const Histogram& h(s.phases[phase]);
+            out << ',' << microseconds(h.Mean()) << ',' << microseconds(h.Percentile(0.5))
+                << ',' << microseconds(h.Percentile(0.9)) << ',' << microseconds(h.Percentile(0.99))
+                << ',' << microseconds(h.Max());
+        }
+        out << '\n';
+    }
+
+    // the buckets themselves, so the distributions can be drawn
+    out << "\nfunction,phase,from us,to us,calls\n";
+    for (size_t i = 0; i < profilers.size(); ++i)
+    {
+        for (size_t phase = 0; phase < phaseCount; ++phase)
+        {
+            const Histogram& h(statistics[i].phases[phase]);
+            for (size_t bucket = 0; bucket < Histogram::bucketCount; ++bucket)
+            {
+                if (!h.counts[bucket])
+                    continue;
+                out << profilers[i]->FunctionName() << ',' << PhaseName(static_cast<Phase>(phase)) << ','
+                    << Histogram::LowerBound(bucket) * 1e-3 << ',';
+                if (bucket + 1 < Histogram::bucketCount)
+                    out << Histogram::LowerBound(bucket + 1) * 1e-3;
+                out << ',' << h.counts[bucket] << '\n';
+            }
+        }
+    }
+}
@@ -0,0 +1,389 @@
+/*
+ Copyright (C) 2026 Narinder S Claire
+
+ This file is part of XLW, a free-software/open-source C++ wrapper of the
+ Excel C API - https://xlw.github.io/
+
+ XLW is free software: you can redistribute it and/or modify it under the
+ terms of the XLW license.  You should have received a copy of the
+ license along with this program; if not, please email xlw-users@lists.sf.net
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ FOR A PARTICULAR PURPOSE.  See the license for more details.
+*/
+
+#include <xlw/XlfResultCache.h>
+#include <xlw/TempMemory.h>
+#include "FlatOper.h"
+#include "Registry.h"
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+    typedef xlw::Registry<xlw::XlfResultCache> ResultCacheRegistry;
+
+    template<class T>
+    void append(std::string& data, const T& value)
+    {
+        data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    size_t fpBytes(const FP12& array)
+    {
+        size_t size = static_cast<size_t>(array.rows) * static_cast<size_t>(array.columns);
+        return std::max(sizeof(FP12), offsetof(FP12, array) + size * sizeof(double));
+    }
+
+    size_t stringBytes(const XCHAR* text)
+    {
+        return (static_cast<size_t>(text[0]) + 1) * sizeof(XCHAR);
+    }
+}
+
+xlw::XlfResultCache::Key::Key() : Cacheable(true)
+{
+    Data.reserve(128);
+}
+
+void xlw::XlfResultCache::Key::Add(double value)
+{
+    Data += 'B';
+    append(Data, value);
+}
+
+void xlw::XlfResultCache::Key::Add(int value)
+{
+    Data += 'J';
+    append(Data, value);
+}
+
+void xlw::XlfResultCache::Key::Add(short value)
+{
+    Data += 'I';
+    append(Data, value);
+}
+
+void xlw::XlfResultCache::Key::Add(const XCHAR* value)
+{
+    Data += 'D';
+    Data.append(reinterpret_cast<const char*>(value), stringBytes(value));
+}
+
+void xlw::XlfResultCache::Key::Add(const FP12* value)
+{
+    Data += 'K';
+    Data.append(reinterpret_cast<const char*>(value), fpBytes(*value));
+}
+
+void xlw::XlfResultCache::Key::Add(const XLOPER12* value)
+{
+    Data += 'Q';
+    addOper(*value);
+}
+
+void xlw::XlfResultCache::Key::addOper(const XLOPER12& value)
+{
+    DWORD type = value.xltype & 0xFFF;
+    append(Data, type);
+    switch (type)
+    {
+    case xltypeNum:
+        append(Data, value.val.num);
+        break;
+    case xltypeStr:
+        Data.append(reinterpret_cast<const char*>(value.val.str), stringBytes(value.val.str));
+        break;
+    case xltypeBool:
+        append(Data, value.val.xbool);
+        break;
+    case xltypeErr:
+        append(Data, value.val.err);
+        break;
+    case xltypeInt:
+        append(Data, value.val.w);
+        break;
+    case xltypeNil:
+    case xltypeMissing:
+        break;
+    case xltypeMulti:
+        {
+            append(Data, value.val.array.rows);
+            append(Data, value.val.array.columns);
+            size_t count = static_cast<size_t>(value.val.array.rows) * static_cast<size_t>(value.val.array.columns);
+            for (size_t i = 0; i < count && Cacheable; ++i)
+                addOper(value.val.array.lparray[i]);
+        }
+        break;
+    default:
+        // references, and anything else whose value isn't in the XLOPER12
+        Cacheable = false;
+        break;
+    }
+}
+
+unsigned long long xlw::XlfResultCache::Key::Hash() const
+{
+    const char* data = Data.data();
+    size_t size = Data.size();
+    unsigned long long hash = 0x9E3779B97F4A7C15ULL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        unsigned long long word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 29;
+    }
+    if (i < size)
+    {
+        unsigned long long word = 0;
+        std::memcpy(&word, data + i, size - i);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+struct xlw::XlfResultCache::Shard
+{
+    struct Entry
+    {
+        unsigned long long hash;
+        std::string key;
+        std::string value;
+        bool isArray;
+    };
+    typedef std::list<Entry> List;
+
+    Shard() : Bytes(0) {}
+
+    static size_t cost(const Entry& entry)
+    {
+        // the list and index nodes as well as the strings
+        return sizeof(Entry) + entry.key.size() + entry.value.size() + 8 * sizeof(void*);
+    }
+
+    void erase(List::iterator entry, std::atomic<size_t>& total)
+    {
+        size_t entryCost = cost(*entry);
+        Bytes -= entryCost;
+        total.fetch_sub(entryCost, std::memory_order_relaxed);
+        Index.erase(entry->hash);
+        Entries.erase(entry);
+    }
+
+    // drops the least recently used, leaving the first keep, until the
+    // entries of every shard fit, returning how many went
+    size_t evict(std::atomic<size_t>& total, size_t budget, size_t keep)
+    {
+        size_t evicted = 0;
+        while (total.load(std::memory_order_relaxed) > budget && Entries.size() > keep)
+        {
+            erase(--Entries.end(), total);
+            ++evicted;
+        }
+        return evicted;
+    }
+
+    std::mutex Mutex;
+    // most recently used first
+    List Entries;
+    std::unordered_map<unsigned long long, List::iterator> Index;
+    size_t Bytes;
+};
+
+xlw::XlfResultCache::XlfResultCache(const std::string& functionName, size_t budget)
+    : Name(functionName), Budget(budget), Hits(0), Misses(0), Evictions(0), Skipped(0), Bytes(0),
+      Shards(new Shard[shardCount])
+{
+    std::lock_guard<std::mutex> lock(ResultCacheRegistry::Mutex());
+    ResultCacheRegistry::Entries().push_back(this);
+}
+
+xlw::XlfResultCache::~XlfResultCache()
+{
+    std::lock_guard<std::mutex> lock(ResultCacheRegistry::Mutex());
+    std::vector<XlfResultCache*>& caches(ResultCacheRegistry::Entries());
+    caches.erase(std::remove(caches.begin(), caches.end(), this), caches.end());
+}
+
+xlw::XlfResultCache::Shard& xlw::XlfResultCache::shardFor(unsigned long long hash) const
+{
+    // the index uses the low bits of the hash, so choose the shard by the high ones
+    return Shards[(hash >> 60) & (shardCount - 1)];
+}
+
+char* xlw::XlfResultCache::find(const Key& key, bool isArray)
+{
+    if (!key.IsCacheable())
+        return 0;
+
+    unsigned long long hash = key.Hash();
+    Shard& shard = shardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.Mutex);
+    std::unordered_map<unsigned long long, Shard::List::iterator>::iterator found = shard.Index.find(hash);
+    if (found == shard.Index.end() || found->second->isArray != isArray || found->second->key != key.Bytes())
+    {
+        Misses.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    shard.Entries.splice(shard.Entries.begin(), shard.Entries, found->second);
+    const std::string& value = found->second->value;
+    char* result = reinterpret_cast<char*>(TempMemory::GetMemoryUninitialised<XLOPER12>((value.size() + sizeof(XLOPER12) - 1) / sizeof(XLOPER12)));
+    std::memcpy(result, value.data(), value.size());
+    Hits.fetch_add(1, std::memory_order_relaxed);
+    return result;
+}
+
+void xlw::XlfResultCache::insert(const Key& key, bool isArray, std::string& stored)
+{
+    if (!key.IsCacheable())
+        return;
+
+    Shard::Entry entry;
+    entry.hash = key.Hash();
+    entry.key = key.Bytes();
+    entry.value.swap(stored);
+    entry.isArray = isArray;
+    size_t cost = Shard::cost(entry);
+    size_t budget = Budget.load(std::memory_order_relaxed);
+    if (cost > budget)
+    {
+        Skipped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Shard& shard = shardFor(entry.hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.Mutex);
+        // another thread may have got there first, or a different key share the hash
+        std::unordered_map<unsigned long long, Shard::List::iterator>::iterator found = shard.Index.find(entry.hash);
+        if (found != shard.Index.end())
+            shard.erase(found->second, Bytes);
+
+        shard.Entries.push_front(std::move(entry));
+        shard.Index[shard.Entries.front().hash] = shard.Entries.begin();
+        shard.Bytes += cost;
+        Bytes.fetch_add(cost, std::memory_order_relaxed);
+        Evictions.fetch_add(shard.evict(Bytes, budget, 1), std::memory_order_relaxed);
+    }
+    // only one shard is locked at a time, so two inserts can't wait on each other
+    if (Bytes.load(std::memory_order_relaxed) > budget)
+        trim(&shard);
+}
+
+void xlw::XlfResultCache::trim(const Shard* skip)
+{
+    size_t budget = Budget.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < shardCount && Bytes.load(std::memory_order_relaxed) > budget; ++i)
+    {
+        if (&Shards[i] == skip)
+            continue;
+        std::lock_guard<std::mutex> lock(Shards[i].Mutex);
+        Evictions.fetch_add(Shards[i].evict(Bytes, budget, 0), std::memory_order_relaxed);
+    }
+}
+
+bool xlw::XlfResultCache::Find(const Key& key, LPXLOPER12& result)
+{
+    char* stored = find(key, false);
+    if (!stored)
+        return false;
+    result = FlatOper::Rebase(stored);
+    return true;
+}
+
+bool xlw::XlfResultCache::Find(const Key& key, FP12*& result)
+{
+    char* stored = find(key, true);
+    if (!stored)
+        return false;
+    result = reinterpret_cast<FP12*>(stored);
+    return true;
+}
+
+void xlw::XlfResultCache::Insert(const Key& key, const XLOPER12* result)
+{
+    std::string stored;
+    if (result && key.IsCacheable() && FlatOper::Flatten(*result, stored))
+        insert(key, false, stored);
+}
+
+void xlw::XlfResultCache::Insert(const Key& key, const FP12* result)
+{
+    if (!result || !key.IsCacheable())
+        return;
+    std::string stored(reinterpret_cast<const char*>(result), fpBytes(*result));
+    insert(key, true, stored);
+}
+
+void xlw::XlfResultCache::Flush()
+{
+    for (size_t i = 0; i < shardCount; ++i)
+    {
+        std::lock_guard<std::mutex> lock(Shards[i].Mutex);
+        Shards[i].Entries.clear();
+        Shards[i].Index.clear();
+        Bytes.fetch_sub(Shards[i].Bytes, std::memory_order_relaxed);
+        Shards[i].Bytes = 0;
+    }
+}
+
+void xlw::XlfResultCache::SetBudget(size_t budget)
+{
+    Budget.store(budget, std::memory_order_relaxed);
+    trim(0);
+}
+
+xlw::XlfResultCache::Statistics xlw::XlfResultCache::GetStatistics() const
+{
+    Statistics result;
+    result.hits = Hits.load(std::memory_order_relaxed);
+    result.misses = Misses.load(std::memory_order_relaxed);
+    result.evictions = Evictions.load(std::memory_order_relaxed);
+    result.skipped = Skipped.load(std::memory_order_relaxed);
+    result.entries = 0;
+    result.bytes = 0;
+    result.budget = Budget.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < shardCount; ++i)
+    {
+        std::lock_guard<std::mutex> lock(Shards[i].Mutex);
+        result.entries += Shards[i].Entries.size();
+        result.bytes += Shards[i].Bytes;
+    }
+    return result;
+}
+
+xlw::XlfResultCache* xlw::XlfResultCache::ForFunction(const std::string& functionName)
+{
+    std::lock_guard<std::mutex> lock(ResultCacheRegistry::Mutex());
+    std::vector<XlfResultCache*>& caches(ResultCacheRegistry::Entries());
+    for (size_t i = 0; i < caches.size(); ++i)
+    {
+        if (caches[i]->Name == functionName)
+            return caches[i];
+    }
+    return 0;
+}
+
+std::vector<xlw::XlfResultCache*> xlw::XlfResultCache::Caches()
+{
+    std::lock_guard<std::mutex> lock(ResultCacheRegistry::Mutex());
+    return ResultCacheRegistry::Entries();
+}
+
+void xlw::XlfResultCache::FlushAll()
+{
+    std::vector<XlfResultCache*> caches(Caches());
+    for (size_t i = 0; i < caches.size(); ++i)
+        caches[i]->Flush();
+}
@@ -12,6 +12,11 @@
 */
 
 #include <xlw/xlcall32.h>
+#include <cstdarg>
+
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#endif
 
 /*
 ** Excel 12 entry points backwards compatible with Excel 11
@@ -33,11 +38,17 @@ void FetchExcel12EntryPt(void)
 {
     if (pexcel12 == NULL)
     {
+#if defined(_WIN32)
         hmodule = GetModuleHandle(NULL);
         if (hmodule != NULL)
         {
             pexcel12 = (EXCEL12PROC) GetProcAddress(hmodule, EXCEL12ENTRYPT);
         }
+#else
+        // outside Windows the host exports the callback from the process
+        // or one of the libraries it has already loaded
+        pexcel12 = (EXCEL12PROC) dlsym(RTLD_DEFAULT, EXCEL12ENTRYPT);
+#endif
     }
 }
 